@@ -0,0 +1,44 @@
+#ifndef SIGAMFOX_LIBRARY_BENCHMARK_HPP
+#define SIGAMFOX_LIBRARY_BENCHMARK_HPP
+#include <chrono>
+#include <functional>
+
+// --- Check Programs ----------------------------------------------------------
+//
+// Shared by the library's check programs, dvector.cpp and the one beside each header
+// it checks, bunch.cpp for bunch.hpp and so on, which build.sh builds and run.sh runs.
+// None of them are part of the runtime the generator copies into a project.
+//
+
+class HighResolutionTimer
+{
+
+    public:
+        void start()
+        {
+            start_time = std::chrono::high_resolution_clock::now();
+        }
+
+        double stop()
+        {
+            auto end_time = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> duration = end_time - start_time;
+            return duration.count(); // Returns the time in seconds
+        }
+
+        double measure(std::function<void()> func)
+        {
+            start();
+            func();
+            auto result = stop();
+            return result;
+        }
+
+    private:
+        std::chrono::high_resolution_clock::time_point start_time;
+};
+
+// Keeps the optimizer from discarding the benchmark body.
+inline volatile double benchmark_sink = 0.0;
+
+#endif
@@ -1 +1,7 @@
-cl.exe dvector.cpp /DSF_DVECTOR_UNIT_TEST=1 /DTEST_NAME='"Repitition Testing"' /EHsc /std:c++17 /O2 /DSF_USE_INTRINSICS=1 /DSF_USE_AVX=1 /arch:AVX
+cl.exe dvector.cpp /Fe:dvector_inline.exe /DSF_DVECTOR_UNIT_TEST=1 /DTEST_NAME='"Inline Storage"' /EHsc /std:c++17 /O2
+cl.exe dvector.cpp /Fe:dvector_heap.exe /DSF_DVECTOR_UNIT_TEST=1 /DTEST_NAME='"Heap Storage"' /EHsc /std:c++17 /O2 /DSF_DVECTOR_HEAP_STORAGE=1
+foreach ($check in "bunch", "da", "map", "elements", "interval", "complex", "transcendental", "pool", "ploop", "transport") {
+    $test = "/DSF_" + $check.ToUpper() + "_UNIT_TEST=1"
+    cl.exe "$check.cpp" /Fe:"$($check)_inline.exe" $test /EHsc /std:c++17 /O2
+    cl.exe "$check.cpp" /Fe:"$($check)_heap.exe" $test /EHsc /std:c++17 /O2 /DSF_DVECTOR_HEAP_STORAGE=1
+}
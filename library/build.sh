@@ -0,0 +1,6 @@
+g++ dvector.cpp -o dvector_inline -DSF_DVECTOR_UNIT_TEST=1 -DTEST_NAME='"Inline Storage"' -std=c++17 -O2 -pthread
+g++ dvector.cpp -o dvector_heap -DSF_DVECTOR_UNIT_TEST=1 -DTEST_NAME='"Heap Storage"' -std=c++17 -O2 -pthread -DSF_DVECTOR_HEAP_STORAGE=1
+for check in bunch da map elements interval complex transcendental pool ploop transport; do
+    g++ $check.cpp -o ${check}_inline -DSF_${check^^}_UNIT_TEST=1 -std=c++17 -O2 -pthread
+    g++ $check.cpp -o ${check}_heap -DSF_${check^^}_UNIT_TEST=1 -std=c++17 -O2 -pthread -DSF_DVECTOR_HEAP_STORAGE=1
+done
@@ -0,0 +1,65 @@
+#if defined(SF_BUNCH_UNIT_TEST) && SF_BUNCH_UNIT_TEST == 1
+#include <iostream>
+#include "bunch.hpp"
+
+// The bunch has to hold what an array of dvectors would, keep every column aligned,
+// and give the same answers whether particles are touched one at a time, per chunk,
+// or through the whole-bunch operators.
+bool verify_bunch()
+{
+
+    constexpr size_t count = 1000;
+    particle_bunch<double, 6> bunch(count);
+    std::vector<dvector<double, 6>> reference(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        dvector<double, 6> particle = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+        reference[i] = particle * double(i % 17) - 3.0;
+        bunch[i] = reference[i];
+    }
+
+    const dvector<double, 6> offset = { 0.5, -1.0, 2.0, 0.0, 1.5, -0.25 };
+    const dvector<double, 6> scale = { 2.0, 0.5, 1.0, -1.0, 4.0, 3.0 };
+    bunch += offset;
+    bunch *= scale;
+    bunch[7] = bunch[7] * 2.0;
+    for (size_t i = 0; i < count; ++i) reference[i] = (reference[i] + offset) * scale;
+    reference[7] = reference[7] * 2.0;
+
+    bool passed = true;
+    size_t visited = 0;
+    bunch.for_each_chunk([&](particle_chunk<double, 6> &chunk)
+    {
+        for (size_t c = 0; c < 6; ++c)
+        {
+            passed = passed && reinterpret_cast<uintptr_t>(chunk.columns[c]) % 64 == 0;
+            for (size_t i = 0; i < chunk.count; ++i)
+                passed = passed && chunk.columns[c][i] == reference[chunk.offset + i][c];
+        }
+        visited += chunk.count;
+    });
+
+    passed = passed && visited == count;
+    passed = passed && dvector_dot(bunch[11], offset) == dvector_dot(reference[11], offset);
+    passed = passed && dvector<double, 6>(bunch[12] - reference[12]) == dvector<double, 6>();
+
+    bunch.resize(count + 3);
+    passed = passed && bunch.size() == count + 3 && bunch[count - 1] == reference[count - 1];
+    passed = passed && bunch[count + 2] == dvector<double, 6>();
+
+    return passed;
+
+}
+
+int
+main()
+{
+
+    const bool bunch_passed = verify_bunch();
+    std::cout << "Bunch check: " << (bunch_passed ? "passed" : "FAILED") << std::endl;
+
+    return bunch_passed ? 0 : 1;
+
+}
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef SIGAMFOX_LIBRARY_BUNCH_HPP
+#define SIGAMFOX_LIBRARY_BUNCH_HPP
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "dvector.hpp"
+
+// --- Particle Bunch ----------------------------------------------------------
+//
+// A COSY array of vectors is the usual way to track many particles through the same
+// map. Laid out as an array of dvectors, the coordinates of neighbouring particles
+// are a whole dvector apart, so applying one operation to every particle can't use
+// more than a single SIMD lane at a time. The bunch stores the same data with one
+// contiguous column per phase-space coordinate instead, so operations that touch
+// every particle stream through each column with the dvector kernels.
+//
+// Each column is padded to a multiple of 64 bytes and starts on a 64 byte boundary,
+// the same guarantee dvector gives its kernels. The padding past the last particle
+// stays zeroed.
+//
+// Indexing a bunch returns a particle_reference, a proxy that behaves as a dvector
+// expression for reading and scatters into the columns when assigned to. This keeps
+// generated code that indexes one particle at a time working unchanged, while the
+// whole-bunch operators and for_each_chunk are what kernels should target.
+//
+
+template <class T, size_t D> class particle_bunch;
+
+template <class T, size_t D>
+class particle_chunk
+{
+
+    public:
+        T*      columns[D];
+        size_t  offset;
+        size_t  count;
+
+};
+
+template <class T, size_t D>
+class particle_reference : public dvector_expression<particle_reference<T, D>>
+{
+
+    public:
+        using value_type = T;
+        static constexpr size_t length = D;
+
+    public:
+        inline                      particle_reference(particle_bunch<T,D> &bunch, size_t index);
+        inline                      particle_reference(const particle_reference &rhs) = default;
+
+        inline particle_reference&  operator=(const particle_reference &rhs);
+        template <class E>
+        inline particle_reference&  operator=(const dvector_expression<E> &rhs);
+
+        inline T&                   operator[](const size_t coordinate);
+        inline T                    evaluate(const size_t coordinate) const;
+
+        inline bool                 operator==(const dvector<T,D> &rhs) const;
+        inline bool                 operator!=(const dvector<T,D> &rhs) const;
+
+    protected:
+        particle_bunch<T,D> *bunch;
+        size_t index;
+
+};
+
+template <class T, size_t D>
+class particle_bunch
+{
+
+    public:
+        using value_type = T;
+        static constexpr size_t dimensions = D;
+
+    public:
+        inline                      particle_bunch();
+        inline                      particle_bunch(size_t count);
+
+        inline particle_reference<T,D> operator[](const size_t index);
+        inline dvector<T,D>         operator[](const size_t index) const;
+
+        inline T*                   column(const size_t coordinate);
+        inline const T*             column(const size_t coordinate) const;
+
+        inline size_t               size() const;
+        inline size_t               stride() const;
+        inline void                 resize(size_t count);
+
+        template <class F>
+        inline void                 for_each_chunk(F function);
+
+        inline particle_bunch&      operator+=(const dvector<T,D> &offset);
+        inline particle_bunch&      operator-=(const dvector<T,D> &offset);
+        inline particle_bunch&      operator*=(const dvector<T,D> &scale);
+        inline particle_bunch&      operator*=(T scale);
+
+    public:
+        static constexpr size_t alignment       = 64;
+        static constexpr size_t lane_count      = sizeof(T) < alignment ? alignment / sizeof(T) : 1;
+        static constexpr size_t chunk_length    = lane_count * 32;
+
+    protected:
+        size_t particle_count;
+        size_t column_stride;
+        std::vector<T, dvector_aligned_allocator<T, alignment>> storage;
+
+};
+
+// --- Particle Reference ------------------------------------------------------
+
+template <class T, size_t D> inline particle_reference<T,D>::
+particle_reference(particle_bunch<T,D> &bunch, size_t index)
+    : bunch(&bunch), index(index)
+{
+
+}
+
+template <class T, size_t D> inline particle_reference<T,D>& particle_reference<T,D>::
+operator=(const particle_reference<T,D> &rhs)
+{
+
+    // Assigning one particle to another copies the coordinates, it doesn't rebind.
+    for (size_t c = 0; c < D; ++c) (*this)[c] = rhs.evaluate(c);
+    return *this;
+
+}
+
+template <class T, size_t D> template <class E> inline particle_reference<T,D>& particle_reference<T,D>::
+operator=(const dvector_expression<E> &rhs)
+{
+
+    static_assert(E::length == D, "Particle assigned from a vector of a different length.");
+
+    // Evaluate first, the expression may read the particle it's assigned to.
+    const dvector<T,D> particle(rhs);
+    for (size_t c = 0; c < D; ++c) (*this)[c] = particle[c];
+    return *this;
+
+}
+
+template <class T, size_t D> inline T& particle_reference<T,D>::
+operator[](const size_t coordinate)
+{
+
+    return this->bunch->column(coordinate)[this->index];
+
+}
+
+template <class T, size_t D> inline T particle_reference<T,D>::
+evaluate(const size_t coordinate) const
+{
+
+    return this->bunch->column(coordinate)[this->index];
+
+}
+
+template <class T, size_t D> inline bool particle_reference<T,D>::
+operator==(const dvector<T,D> &rhs) const
+{
+
+    bool components_equal = true;
+    for (size_t c = 0; c < D; ++c)
+    {
+        if (this->evaluate(c) != rhs[c]) components_equal = false;
+    }
+
+    return components_equal;
+
+}
+
+template <class T, size_t D> inline bool particle_reference<T,D>::
+operator!=(const dvector<T,D> &rhs) const
+{
+
+    return !(*this == rhs);
+
+}
+
+// --- Particle Bunch ----------------------------------------------------------
+
+template <class T, size_t D> inline particle_bunch<T,D>::
+particle_bunch()
+    : particle_count(0), column_stride(0)
+{
+
+}
+
+template <class T, size_t D> inline particle_bunch<T,D>::
+particle_bunch(size_t count)
+    : particle_count(0), column_stride(0)
+{
+
+    this->resize(count);
+
+}
+
+template <class T, size_t D> inline particle_reference<T,D> particle_bunch<T,D>::
+operator[](const size_t index)
+{
+
+    return particle_reference<T,D>(*this, index);
+
+}
+
+template <class T, size_t D> inline dvector<T,D> particle_bunch<T,D>::
+operator[](const size_t index) const
+{
+
+    dvector<T,D> particle;
+    for (size_t c = 0; c < D; ++c) particle[c] = this->column(c)[index];
+    return particle;
+
+}
+
+template <class T, size_t D> inline T* particle_bunch<T,D>::
+column(const size_t coordinate)
+{
+
+    return this->storage.data() + coordinate * this->column_stride;
+
+}
+
+template <class T, size_t D> inline const T* particle_bunch<T,D>::
+column(const size_t coordinate) const
+{
+
+    return this->storage.data() + coordinate * this->column_stride;
+
+}
+
+template <class T, size_t D> inline size_t particle_bunch<T,D>::
+size() const
+{
+
+    return this->particle_count;
+
+}
+
+template <class T, size_t D> inline size_t particle_bunch<T,D>::
+stride() const
+{
+
+    return this->column_stride;
+
+}
+
+template <class T, size_t D> inline void particle_bunch<T,D>::
+resize(size_t count)
+{
+
+    // Rebuild the columns at the new stride, keeping the particles that still fit.
+    const size_t stride = (count + lane_count - 1) / lane_count * lane_count;
+    std::vector<T, dvector_aligned_allocator<T, alignment>> resized(stride * D, T(0));
+
+    const size_t kept = std::min(count, this->particle_count);
+    for (size_t c = 0; c < D; ++c)
+    {
+        std::copy(this->column(c), this->column(c) + kept, resized.data() + c * stride);
+    }
+
+    this->storage = std::move(resized);
+    this->column_stride = stride;
+    this->particle_count = count;
+
+}
+
+template <class T, size_t D> template <class F> inline void particle_bunch<T,D>::
+for_each_chunk(F function)
+{
+
+    // Chunks are a multiple of the lane count so every column pointer in a chunk is
+    // aligned, and short enough that all D columns of a chunk stay in L1 together.
+    particle_chunk<T,D> chunk;
+    for (size_t offset = 0; offset < this->particle_count; offset += chunk_length)
+    {
+
+        chunk.offset = offset;
+        chunk.count = std::min(chunk_length, this->particle_count - offset);
+        for (size_t c = 0; c < D; ++c) chunk.columns[c] = this->column(c) + offset;
+        function(chunk);
+
+    }
+
+}
+
+template <class T, size_t D> inline particle_bunch<T,D>& particle_bunch<T,D>::
+operator+=(const dvector<T,D> &offset)
+{
+
+    for (size_t c = 0; c < D; ++c)
+        dvector_dispatch<simd_op::OP_ADD>(this->column(c), offset[c], this->particle_count);
+    return *this;
+
+}
+
+template <class T, size_t D> inline particle_bunch<T,D>& particle_bunch<T,D>::
+operator-=(const dvector<T,D> &offset)
+{
+
+    for (size_t c = 0; c < D; ++c)
+        dvector_dispatch<simd_op::OP_SUB>(this->column(c), offset[c], this->particle_count);
+    return *this;
+
+}
+
+template <class T, size_t D> inline particle_bunch<T,D>& particle_bunch<T,D>::
+operator*=(const dvector<T,D> &scale)
+{
+
+    for (size_t c = 0; c < D; ++c)
+        dvector_dispatch<simd_op::OP_MUL>(this->column(c), scale[c], this->particle_count);
+    return *this;
+
+}
+
+template <class T, size_t D> inline particle_bunch<T,D>& particle_bunch<T,D>::
+operator*=(T scale)
+{
+
+    dvector_dispatch<simd_op::OP_MUL>(this->storage.data(), scale, this->storage.size());
+    return *this;
+
+}
+
+#endif
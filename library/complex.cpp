@@ -0,0 +1,89 @@
+#if defined(SF_COMPLEX_UNIT_TEST) && SF_COMPLEX_UNIT_TEST == 1
+#include <iostream>
+#include <vector>
+#include "complex.hpp"
+#include "benchmark.hpp"
+
+// Checks fast_complex and complex_vector against std::complex, and times a loop of
+// products and quotients through each.
+bool verify_complex()
+{
+
+    auto close = [](std::complex<double> expected, fast_complex value)
+    {
+        return std::abs(expected - std::complex<double>(value)) <= 1e-14 * std::abs(expected);
+    };
+
+    constexpr size_t count = 4096;
+    std::vector<std::complex<double>> a(count), b(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        a[i] = std::complex<double>(std::sin(0.37 * double(i)) * 3.0, std::cos(0.11 * double(i)) - 0.5);
+        b[i] = std::complex<double>(0.25 + double(i % 17) / 4.0, std::sin(0.05 * double(i)) * 2.0);
+    }
+
+    bool passed = true;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const fast_complex x = a[i], y = b[i];
+        passed = passed && close(a[i] * b[i], x * y) && close(a[i] / b[i], x / y);
+        passed = passed && close(a[i] + 2.0, x + 2.0) && close(2.0 / b[i], 2.0 / y);
+    }
+
+    constexpr size_t length = 37;
+    complex_vector<length> u, v;
+    for (size_t i = 0; i < length; ++i)
+    {
+        u[i] = a[i];
+        v[i] = b[i];
+    }
+
+    const complex_vector<length> product = u * v;
+    const complex_vector<length> quotient = u / v;
+    const complex_vector<length> scaled = fast_complex(0.5, -2.0) - u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        passed = passed && close(a[i] * b[i], product[i]) && close(a[i] / b[i], quotient[i]);
+        passed = passed && close(std::complex<double>(0.5, -2.0) - a[i], scaled[i]);
+    }
+
+    constexpr size_t trials = 200;
+    std::vector<std::complex<double>> strict(count);
+    std::vector<fast_complex> fast(count), x(a.begin(), a.end()), y(b.begin(), b.end());
+    HighResolutionTimer timer;
+    timer.start();
+    for (size_t trial = 0; trial < trials; ++trial)
+    {
+        for (size_t i = 0; i < count; ++i) strict[i] = a[i] * b[i] + a[i] / b[i];
+        benchmark_sink = benchmark_sink + strict[trial % count].real();
+    }
+    const double strict_time = timer.stop();
+
+    timer.start();
+    for (size_t trial = 0; trial < trials; ++trial)
+    {
+        for (size_t i = 0; i < count; ++i) fast[i] = x[i] * y[i] + x[i] / y[i];
+        benchmark_sink = benchmark_sink + fast[trial % count].real();
+    }
+    const double fast_time = timer.stop();
+
+    for (size_t i = 0; i < count; ++i) passed = passed && close(strict[i], fast[i]);
+    std::cout << "    std::complex " << strict_time / trials * 1e6 << "us, fast_complex "
+              << fast_time / trials * 1e6 << "us per " << count << " products and quotients" << std::endl;
+    return passed;
+
+}
+
+int
+main()
+{
+
+    std::cout << "Complex arithmetic:" << std::endl;
+    const bool complex_passed = verify_complex();
+    std::cout << "Complex check: " << (complex_passed ? "passed" : "FAILED") << std::endl;
+
+    return complex_passed ? 0 : 1;
+
+}
+
+#endif
@@ -0,0 +1,616 @@
+#ifndef SIGAMFOX_LIBRARY_COMPLEX_HPP
+#define SIGAMFOX_LIBRARY_COMPLEX_HPP
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <initializer_list>
+#include "dvector.hpp"
+
+// --- Complex Arithmetic ------------------------------------------------------
+//
+// std::complex<double> has to honour Annex G of C99. A product or quotient that comes
+// out NaN is recomputed to recover infinities, so unless the program is built with
+// -fcx-limited-range every complex multiply and divide is a call into the runtime's
+// __muldc3 or __divdc3. The calls can't be inlined or vectorized, and they dominate
+// any loop doing complex arithmetic.
+//
+// fast_complex is a plain pair of doubles with the textbook formulas. A product is
+// four multiplies and two adds the compiler can contract and vectorize. A quotient
+// multiplies by the conjugate and one reciprocal of the divisor's squared magnitude.
+// There is no infinity recovery and no scaling: a product of infinities with a zero
+// part gives NaN rather than infinity, and a divisor with a component outside about
+// 1e-154 to 1e154 in magnitude overflows or underflows the squared magnitude. Values
+// from physical simulation are nowhere near either edge.
+//
+// complex_vector is the fixed length vector of complex values, stored as two dvectors,
+// one of real parts and one of imaginary parts. Keeping the parts apart means every
+// operation is the same dvector arithmetic over whole columns, which runs at the
+// full SIMD width, where interleaved pairs would need shuffles for every product.
+//
+// Generated code names the complex type complexd. Building with
+// SF_COMPLEX_STRICT_IEEE=1, which the transpiler's --strict-ieee flag sets, makes it
+// std::complex<double> again, and has complex_vector multiply and divide each element
+// through std::complex, for programs that depend on the IEEE corner cases.
+//
+
+#if !defined(SF_COMPLEX_STRICT_IEEE)
+#   define SF_COMPLEX_STRICT_IEEE 0
+#endif
+
+class fast_complex
+{
+
+    public:
+        inline constexpr    fast_complex();
+        inline constexpr    fast_complex(double real, double imaginary = 0.0);
+        inline constexpr    fast_complex(const std::complex<double> &value);
+
+        inline constexpr    operator std::complex<double>() const;
+
+        inline constexpr double real() const;
+        inline constexpr double imag() const;
+        inline void         real(double value);
+        inline void         imag(double value);
+
+        inline fast_complex& operator+=(const fast_complex &rhs);
+        inline fast_complex& operator-=(const fast_complex &rhs);
+        inline fast_complex& operator*=(const fast_complex &rhs);
+        inline fast_complex& operator/=(const fast_complex &rhs);
+
+        inline fast_complex& operator+=(double rhs);
+        inline fast_complex& operator-=(double rhs);
+        inline fast_complex& operator*=(double rhs);
+        inline fast_complex& operator/=(double rhs);
+
+    protected:
+        double real_part;
+        double imaginary_part;
+
+};
+
+#if SF_COMPLEX_STRICT_IEEE == 1
+    using complexd = std::complex<double>;
+#else
+    using complexd = fast_complex;
+#endif
+
+// --- Fast Complex ------------------------------------------------------------
+
+inline constexpr fast_complex::
+fast_complex()
+    : real_part(0.0), imaginary_part(0.0)
+{
+
+}
+
+inline constexpr fast_complex::
+fast_complex(double real, double imaginary)
+    : real_part(real), imaginary_part(imaginary)
+{
+
+}
+
+inline constexpr fast_complex::
+fast_complex(const std::complex<double> &value)
+    : real_part(value.real()), imaginary_part(value.imag())
+{
+
+}
+
+inline constexpr fast_complex::
+operator std::complex<double>() const
+{
+
+    return std::complex<double>(this->real_part, this->imaginary_part);
+
+}
+
+inline constexpr double fast_complex::
+real() const
+{
+
+    return this->real_part;
+
+}
+
+inline constexpr double fast_complex::
+imag() const
+{
+
+    return this->imaginary_part;
+
+}
+
+inline void fast_complex::
+real(double value)
+{
+
+    this->real_part = value;
+
+}
+
+inline void fast_complex::
+imag(double value)
+{
+
+    this->imaginary_part = value;
+
+}
+
+inline fast_complex& fast_complex::
+operator+=(const fast_complex &rhs)
+{
+
+    this->real_part += rhs.real_part;
+    this->imaginary_part += rhs.imaginary_part;
+    return *this;
+
+}
+
+inline fast_complex& fast_complex::
+operator-=(const fast_complex &rhs)
+{
+
+    this->real_part -= rhs.real_part;
+    this->imaginary_part -= rhs.imaginary_part;
+    return *this;
+
+}
+
+inline fast_complex& fast_complex::
+operator*=(const fast_complex &rhs)
+{
+
+    const double real = this->real_part * rhs.real_part - this->imaginary_part * rhs.imaginary_part;
+    this->imaginary_part = this->real_part * rhs.imaginary_part + this->imaginary_part * rhs.real_part;
+    this->real_part = real;
+    return *this;
+
+}
+
+inline fast_complex& fast_complex::
+operator/=(const fast_complex &rhs)
+{
+
+    const double scale = 1.0 / (rhs.real_part * rhs.real_part + rhs.imaginary_part * rhs.imaginary_part);
+    const double real = (this->real_part * rhs.real_part + this->imaginary_part * rhs.imaginary_part) * scale;
+    this->imaginary_part = (this->imaginary_part * rhs.real_part - this->real_part * rhs.imaginary_part) * scale;
+    this->real_part = real;
+    return *this;
+
+}
+
+inline fast_complex& fast_complex::
+operator+=(double rhs)
+{
+
+    this->real_part += rhs;
+    return *this;
+
+}
+
+inline fast_complex& fast_complex::
+operator-=(double rhs)
+{
+
+    this->real_part -= rhs;
+    return *this;
+
+}
+
+inline fast_complex& fast_complex::
+operator*=(double rhs)
+{
+
+    this->real_part *= rhs;
+    this->imaginary_part *= rhs;
+    return *this;
+
+}
+
+inline fast_complex& fast_complex::
+operator/=(double rhs)
+{
+
+    this->real_part /= rhs;
+    this->imaginary_part /= rhs;
+    return *this;
+
+}
+
+inline fast_complex operator+(fast_complex lhs, const fast_complex &rhs) { return lhs += rhs; }
+inline fast_complex operator-(fast_complex lhs, const fast_complex &rhs) { return lhs -= rhs; }
+inline fast_complex operator*(fast_complex lhs, const fast_complex &rhs) { return lhs *= rhs; }
+inline fast_complex operator/(fast_complex lhs, const fast_complex &rhs) { return lhs /= rhs; }
+
+inline fast_complex operator+(fast_complex lhs, double rhs) { return lhs += rhs; }
+inline fast_complex operator-(fast_complex lhs, double rhs) { return lhs -= rhs; }
+inline fast_complex operator*(fast_complex lhs, double rhs) { return lhs *= rhs; }
+inline fast_complex operator/(fast_complex lhs, double rhs) { return lhs /= rhs; }
+
+inline fast_complex operator+(double lhs, const fast_complex &rhs) { return fast_complex(lhs) += rhs; }
+inline fast_complex operator-(double lhs, const fast_complex &rhs) { return fast_complex(lhs) -= rhs; }
+inline fast_complex operator*(double lhs, fast_complex rhs) { return rhs *= lhs; }
+inline fast_complex operator/(double lhs, const fast_complex &rhs) { return fast_complex(lhs) /= rhs; }
+
+inline fast_complex
+operator-(const fast_complex &rhs)
+{
+
+    return fast_complex(-rhs.real(), -rhs.imag());
+
+}
+
+inline bool
+operator==(const fast_complex &lhs, const fast_complex &rhs)
+{
+
+    return lhs.real() == rhs.real() && lhs.imag() == rhs.imag();
+
+}
+
+inline bool
+operator!=(const fast_complex &lhs, const fast_complex &rhs)
+{
+
+    return !(lhs == rhs);
+
+}
+
+inline std::ostream&
+operator<<(std::ostream &os, const fast_complex &value)
+{
+
+    // The same (real,imaginary) form std::complex prints.
+    os << "(" << value.real() << "," << value.imag() << ")";
+    return os;
+
+}
+
+inline double real(const fast_complex &value) { return value.real(); }
+inline double imag(const fast_complex &value) { return value.imag(); }
+inline double norm(const fast_complex &value) { return value.real() * value.real() + value.imag() * value.imag(); }
+inline double abs(const fast_complex &value) { return std::hypot(value.real(), value.imag()); }
+inline double arg(const fast_complex &value) { return std::atan2(value.imag(), value.real()); }
+inline fast_complex conj(const fast_complex &value) { return fast_complex(value.real(), -value.imag()); }
+
+// The principal root, through std::complex for both complex types.
+inline fast_complex math_sqrt(const fast_complex &value) { return fast_complex(std::sqrt(std::complex<double>(value))); }
+inline std::complex<double> math_sqrt(const std::complex<double> &value) { return std::sqrt(value); }
+
+// --- Complex Vector ----------------------------------------------------------
+
+template <size_t L>
+class complex_vector
+{
+
+    public:
+        using value_type = complexd;
+        static constexpr size_t length = L;
+
+        // What the non-const subscript returns, since no complex value is stored
+        // anywhere to refer to.
+        class reference
+        {
+
+            public:
+                inline              reference(double &real, double &imaginary);
+                inline reference&   operator=(const complexd &value);
+                inline reference&   operator=(const reference &value);
+                inline              operator complexd() const;
+
+            protected:
+                double &real_part;
+                double &imaginary_part;
+
+        };
+
+    public:
+        inline              complex_vector();
+        inline              complex_vector(std::initializer_list<complexd> list);
+        inline              complex_vector(const dvector<double, L> &real, const dvector<double, L> &imaginary);
+
+        inline reference    operator[](const size_t index);
+        inline complexd     operator[](const size_t index) const;
+        inline complexd     evaluate(const size_t index) const;
+
+        inline dvector<double, L>&       real();
+        inline const dvector<double, L>& real() const;
+        inline dvector<double, L>&       imag();
+        inline const dvector<double, L>& imag() const;
+        inline size_t       size() const;
+
+        inline complex_vector& operator+=(const complex_vector &rhs);
+        inline complex_vector& operator-=(const complex_vector &rhs);
+        inline complex_vector& operator*=(const complex_vector &rhs);
+        inline complex_vector& operator/=(const complex_vector &rhs);
+
+        inline complex_vector& operator+=(const complexd &rhs);
+        inline complex_vector& operator-=(const complexd &rhs);
+        inline complex_vector& operator*=(const complexd &rhs);
+        inline complex_vector& operator/=(const complexd &rhs);
+
+    protected:
+        dvector<double, L> real_parts;
+        dvector<double, L> imaginary_parts;
+
+};
+
+template <size_t L> inline complex_vector<L>::reference::
+reference(double &real, double &imaginary)
+    : real_part(real), imaginary_part(imaginary)
+{
+
+}
+
+template <size_t L> inline typename complex_vector<L>::reference& complex_vector<L>::reference::
+operator=(const complexd &value)
+{
+
+    this->real_part = value.real();
+    this->imaginary_part = value.imag();
+    return *this;
+
+}
+
+template <size_t L> inline typename complex_vector<L>::reference& complex_vector<L>::reference::
+operator=(const reference &value)
+{
+
+    return *this = static_cast<complexd>(value);
+
+}
+
+template <size_t L> inline complex_vector<L>::reference::
+operator complexd() const
+{
+
+    return complexd(this->real_part, this->imaginary_part);
+
+}
+
+template <size_t L> inline complex_vector<L>::
+complex_vector()
+{
+
+}
+
+template <size_t L> inline complex_vector<L>::
+complex_vector(std::initializer_list<complexd> list)
+{
+
+    size_t index = 0;
+    for (auto it = list.begin(); it != list.end() && index < L; ++it, ++index)
+    {
+        this->real_parts[index] = it->real();
+        this->imaginary_parts[index] = it->imag();
+    }
+
+}
+
+template <size_t L> inline complex_vector<L>::
+complex_vector(const dvector<double, L> &real, const dvector<double, L> &imaginary)
+    : real_parts(real), imaginary_parts(imaginary)
+{
+
+}
+
+template <size_t L> inline typename complex_vector<L>::reference complex_vector<L>::
+operator[](const size_t index)
+{
+
+    return reference(this->real_parts[index], this->imaginary_parts[index]);
+
+}
+
+template <size_t L> inline complexd complex_vector<L>::
+operator[](const size_t index) const
+{
+
+    return this->evaluate(index);
+
+}
+
+template <size_t L> inline complexd complex_vector<L>::
+evaluate(const size_t index) const
+{
+
+    return complexd(this->real_parts[index], this->imaginary_parts[index]);
+
+}
+
+template <size_t L> inline dvector<double, L>& complex_vector<L>::
+real()
+{
+
+    return this->real_parts;
+
+}
+
+template <size_t L> inline const dvector<double, L>& complex_vector<L>::
+real() const
+{
+
+    return this->real_parts;
+
+}
+
+template <size_t L> inline dvector<double, L>& complex_vector<L>::
+imag()
+{
+
+    return this->imaginary_parts;
+
+}
+
+template <size_t L> inline const dvector<double, L>& complex_vector<L>::
+imag() const
+{
+
+    return this->imaginary_parts;
+
+}
+
+template <size_t L> inline size_t complex_vector<L>::
+size() const
+{
+
+    return L;
+
+}
+
+template <size_t L> inline complex_vector<L>& complex_vector<L>::
+operator+=(const complex_vector &rhs)
+{
+
+    this->real_parts += rhs.real_parts;
+    this->imaginary_parts += rhs.imaginary_parts;
+    return *this;
+
+}
+
+template <size_t L> inline complex_vector<L>& complex_vector<L>::
+operator-=(const complex_vector &rhs)
+{
+
+    this->real_parts -= rhs.real_parts;
+    this->imaginary_parts -= rhs.imaginary_parts;
+    return *this;
+
+}
+
+template <size_t L> inline complex_vector<L>& complex_vector<L>::
+operator*=(const complex_vector &rhs)
+{
+
+#   if SF_COMPLEX_STRICT_IEEE == 1
+        for (size_t i = 0; i < L; ++i) (*this)[i] = this->evaluate(i) * rhs.evaluate(i);
+#   else
+        // Each expression is one fused pass over the columns, the real part is kept
+        // aside until the imaginary part no longer needs the old one.
+        dvector<double, L> real = this->real_parts * rhs.real_parts - this->imaginary_parts * rhs.imaginary_parts;
+        this->imaginary_parts = this->real_parts * rhs.imaginary_parts + this->imaginary_parts * rhs.real_parts;
+        this->real_parts = std::move(real);
+#   endif
+    return *this;
+
+}
+
+template <size_t L> inline complex_vector<L>& complex_vector<L>::
+operator/=(const complex_vector &rhs)
+{
+
+#   if SF_COMPLEX_STRICT_IEEE == 1
+        for (size_t i = 0; i < L; ++i) (*this)[i] = this->evaluate(i) / rhs.evaluate(i);
+#   else
+        const dvector<double, L> scale = 1.0 / (rhs.real_parts * rhs.real_parts +
+                rhs.imaginary_parts * rhs.imaginary_parts);
+        dvector<double, L> real = (this->real_parts * rhs.real_parts +
+                this->imaginary_parts * rhs.imaginary_parts) * scale;
+        this->imaginary_parts = (this->imaginary_parts * rhs.real_parts -
+                this->real_parts * rhs.imaginary_parts) * scale;
+        this->real_parts = std::move(real);
+#   endif
+    return *this;
+
+}
+
+template <size_t L> inline complex_vector<L>& complex_vector<L>::
+operator+=(const complexd &rhs)
+{
+
+    this->real_parts += rhs.real();
+    this->imaginary_parts += rhs.imag();
+    return *this;
+
+}
+
+template <size_t L> inline complex_vector<L>& complex_vector<L>::
+operator-=(const complexd &rhs)
+{
+
+    this->real_parts -= rhs.real();
+    this->imaginary_parts -= rhs.imag();
+    return *this;
+
+}
+
+template <size_t L> inline complex_vector<L>& complex_vector<L>::
+operator*=(const complexd &rhs)
+{
+
+    // Scalar operands go through the vector path, so strict mode handles them too.
+    complex_vector<L> operand;
+    operand += rhs;
+    return *this *= operand;
+
+}
+
+template <size_t L> inline complex_vector<L>& complex_vector<L>::
+operator/=(const complexd &rhs)
+{
+
+    complex_vector<L> operand;
+    operand += rhs;
+    return *this /= operand;
+
+}
+
+template <size_t L> inline complex_vector<L> operator+(complex_vector<L> lhs, const complex_vector<L> &rhs) { return lhs += rhs; }
+template <size_t L> inline complex_vector<L> operator-(complex_vector<L> lhs, const complex_vector<L> &rhs) { return lhs -= rhs; }
+template <size_t L> inline complex_vector<L> operator*(complex_vector<L> lhs, const complex_vector<L> &rhs) { return lhs *= rhs; }
+template <size_t L> inline complex_vector<L> operator/(complex_vector<L> lhs, const complex_vector<L> &rhs) { return lhs /= rhs; }
+
+template <size_t L> inline complex_vector<L> operator+(complex_vector<L> lhs, const complexd &rhs) { return lhs += rhs; }
+template <size_t L> inline complex_vector<L> operator-(complex_vector<L> lhs, const complexd &rhs) { return lhs -= rhs; }
+template <size_t L> inline complex_vector<L> operator*(complex_vector<L> lhs, const complexd &rhs) { return lhs *= rhs; }
+template <size_t L> inline complex_vector<L> operator/(complex_vector<L> lhs, const complexd &rhs) { return lhs /= rhs; }
+
+template <size_t L> inline complex_vector<L> operator+(const complexd &lhs, complex_vector<L> rhs) { return rhs += lhs; }
+template <size_t L> inline complex_vector<L> operator*(const complexd &lhs, complex_vector<L> rhs) { return rhs *= lhs; }
+
+template <size_t L> inline complex_vector<L>
+operator-(const complexd &lhs, const complex_vector<L> &rhs)
+{
+
+    complex_vector<L> result;
+    result += lhs;
+    return result -= rhs;
+
+}
+
+template <size_t L> inline complex_vector<L>
+operator/(const complexd &lhs, const complex_vector<L> &rhs)
+{
+
+    complex_vector<L> result;
+    result += lhs;
+    return result /= rhs;
+
+}
+
+template <size_t L> inline complex_vector<L>
+operator-(const complex_vector<L> &rhs)
+{
+
+    return complex_vector<L>(-rhs.real(), -rhs.imag());
+
+}
+
+template <size_t L> inline std::ostream&
+operator<<(std::ostream &os, const complex_vector<L> &rhs)
+{
+
+    os << "[";
+    for (size_t i = 0; i < L; ++i)
+    {
+        os << rhs.evaluate(i);
+        if (i < L - 1) os << ", ";
+    }
+    os << "]";
+
+    return os;
+
+}
+
+#endif
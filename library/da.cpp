@@ -0,0 +1,172 @@
+#if defined(SF_DA_UNIT_TEST) && SF_DA_UNIT_TEST == 1
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "da.hpp"
+#include "benchmark.hpp"
+
+// Multiplies DA vectors both through the kernel and by adding exponents and looking
+// up every product term directly, then checks derivation and extraction against
+// series worked out by hand.
+bool verify_da()
+{
+
+    da_initialize(5, 3, 1);
+    const da_context &context = da_active_context();
+
+    bool passed = context.monomial_count == 126 && context.order_end[1] == 5;
+    for (size_t m = 0; m < context.monomial_count; ++m)
+    {
+        std::vector<uint32_t> exponent_list(context.exponents.begin() + m * context.variables,
+                context.exponents.begin() + (m + 1) * context.variables);
+        passed = passed && context.index_of(exponent_list.data()) == m;
+    }
+
+    const da x = da_variable(1);
+    const da y = da_variable(2);
+    const da z = da_variable(4);
+    const da a = 1.0 + x * 2.0 - y * y + z * x * 0.5;
+    const da b = (x - 3.0) * (y + z * z) - 1.5;
+    const da product = a * b;
+
+    da expected;
+    std::vector<uint32_t> sum_list(context.variables);
+    for (size_t i = 0; i < context.monomial_count; ++i)
+    {
+        for (size_t j = 0; j < context.monomial_count; ++j)
+        {
+            for (size_t v = 0; v < context.variables; ++v)
+                sum_list[v] = context.exponents[i * context.variables + v] + context.exponents[j * context.variables + v];
+            const size_t index = context.index_of(sum_list.data());
+            if (index < context.monomial_count) expected[index] += a[i] * b[j];
+        }
+    }
+
+    for (size_t m = 0; m < context.monomial_count; ++m) passed = passed && product[m] == expected[m];
+
+    // d/dx of x * y^2 + 3 x^3 is y^2 + 9 x^2, and d/dz of it is zero.
+    const da f = x * y * y + 3.0 * x * x * x;
+    const da dfdx = da_derive(f, 1);
+    const da dfdz = da_derive(f, 3);
+    const dvector<double, 4> y_squared = { 0, 2, 0, 0 };
+    const dvector<double, 4> x_squared = { 2, 0, 0, 0 };
+    passed = passed && cosy_extract(dfdx, y_squared) == 1.0 && cosy_extract(dfdx, x_squared) == 9.0;
+    passed = passed && cosy_extract(f, dvector<double, 4>{ 1, 2, 0, 0 }) == 1.0;
+    passed = passed && dfdz.constant() == 0.0 && cosy_extract(dfdz, y_squared) == 0.0;
+    passed = passed && da_constant(a) == 1.0 && da_constant(b) == -1.5;
+
+    // Derivatives past the truncation order vanish rather than wrapping around.
+    da high = x;
+    for (int k = 0; k < 5; ++k) high = high * x;
+    passed = passed && da_constant(high) == 0.0 && cosy_extract(high, dvector<double, 4>{ 5, 0, 0, 0 }) == 0.0;
+
+    dvector<double, 3> vector = { 4.0, 5.0, 6.0 };
+    passed = passed && cosy_extract(vector, 2) == 5.0;
+
+    return passed;
+
+}
+
+// Times one DA multiply at orders 5, 7 and 10 in 6 variables against the naive dense
+// loop, which visits every pair of coefficients and looks up the product monomial of
+// the ones that survive truncation. Both kernels have to agree with it, on a fully
+// dense operand and on one that only involves the first two variables, as a map
+// built from a couple of DA variables would be.
+bool
+da_multiply_benchmark()
+{
+
+    constexpr size_t trials = 5;
+    bool passed = true;
+
+    for (size_t order : { 5, 7, 10 })
+    {
+
+        da_initialize(static_cast<int64_t>(order), 6, 0);
+        const da_context &context = da_active_context();
+        const size_t count = context.monomial_count;
+
+        da a;
+        da dense;
+        da sparse;
+        for (size_t m = 0; m < count; ++m)
+        {
+            a[m] = 1.0 / double(m + 1);
+            dense[m] = 0.5 + double(m % 13) / 16.0;
+            const uint8_t *exponents = context.exponents.data() + m * context.variables;
+            if (std::all_of(exponents + 2, exponents + context.variables, [](uint8_t e) { return e == 0; }))
+                sparse[m] = 0.25 + double(m % 5) / 8.0;
+        }
+
+        for (const da *b : { &dense, &sparse })
+        {
+
+            da expected;
+            std::vector<uint32_t> sum_list(context.variables);
+            HighResolutionTimer naive_timer;
+            naive_timer.start();
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (size_t j = 0; j < count; ++j)
+                {
+                    if (context.degree[i] + context.degree[j] > order) continue;
+                    for (size_t v = 0; v < context.variables; ++v)
+                        sum_list[v] = context.exponents[i * context.variables + v] + context.exponents[j * context.variables + v];
+                    expected[context.index_of(sum_list.data())] += a[i] * (*b)[j];
+                }
+            }
+            const double naive_time = naive_timer.stop();
+
+            da prefix_result;
+            da table_result;
+            double prefix_time = 1e30;
+            double table_time = 1e30;
+            for (size_t trial = 0; trial < trials; ++trial)
+            {
+                HighResolutionTimer timer;
+                timer.start();
+                da_multiply_prefix_kernel(context, a.data(), b->data(), prefix_result.data());
+                prefix_time = std::min(prefix_time, timer.stop());
+                timer.start();
+                da_multiply_kernel(context, a.data(), b->data(), table_result.data());
+                table_time = std::min(table_time, timer.stop());
+            }
+
+            bool matches = true;
+            for (size_t m = 0; m < count; ++m)
+            {
+                const double tolerance = 1e-12 * std::max(1.0, std::abs(expected[m]));
+                if (std::abs(prefix_result[m] - expected[m]) > tolerance) matches = false;
+                if (std::abs(table_result[m] - expected[m]) > tolerance) matches = false;
+            }
+
+            passed = passed && matches && context.has_product_table() && table_time < naive_time;
+            std::cout << "    order " << order << ", " << count << " terms, "
+                      << (b == &dense ? "dense" : "sparse") << ": naive " << naive_time * 1e3
+                      << "ms, prefix " << prefix_time * 1e3 << "ms, table " << table_time * 1e3
+                      << "ms (" << naive_time / table_time << "x naive)"
+                      << (matches ? "" : " MISMATCH") << std::endl;
+
+        }
+
+    }
+
+    return passed;
+
+}
+
+int
+main()
+{
+
+    const bool da_passed = verify_da();
+    std::cout << "DA check: " << (da_passed ? "passed" : "FAILED") << std::endl;
+    std::cout << "DA multiply:" << std::endl;
+    const bool da_multiply_passed = da_multiply_benchmark();
+    std::cout << "DA multiply check: " << (da_multiply_passed ? "passed" : "FAILED") << std::endl;
+
+    return da_passed && da_multiply_passed ? 0 : 1;
+
+}
+
+#endif
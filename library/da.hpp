@@ -0,0 +1,758 @@
+#ifndef SIGAMFOX_LIBRARY_DA_HPP
+#define SIGAMFOX_LIBRARY_DA_HPP
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include "dvector.hpp"
+#include "pool.hpp"
+
+// --- Differential Algebra ----------------------------------------------------
+//
+// A DA vector is a multivariate power series truncated at a fixed order, stored as
+// a dense array with one coefficient per monomial. The order and number of variables
+// are set once at runtime by COSY's OV, which builds the da_context that every DA
+// vector shares.
+//
+// Monomials are kept in graded order, so the constant is at index zero, the linear
+// terms of each variable follow in variable order, and every monomial of order k or
+// below sits in the prefix that ends at order_end[k]. A product term a_i * b_j only
+// survives truncation if b_j has order at most N - order(i), which makes the inner
+// loop of the multiply a contiguous prefix of b instead of a filtered scan.
+//
+// The index of a product monomial is found without searching. Each monomial's
+// exponents are packed into two integers, one for the first half of the variables
+// and one for the second half, base N + 1 so that adding two codes adds exponents
+// without any carry. Indexing high_offset and low_rank with the summed codes gives
+// an address, which address_to_index maps back to the graded index. Those tables are
+// indexed by the packed code of half the variables, so they stay a few kilobytes at
+// the orders COSY is used for and remain in L1 throughout the multiply.
+//
+// When it fits under product_table_limit, the context also keeps the product table:
+// for every monomial i, the index of i * j for each j in its truncated prefix, laid
+// out row after row from product_offset[i]. With it the multiply needs one load per
+// term instead of four, at the cost of one entry per surviving pair, which is the
+// number of monomials in twice the variables (646646 at order 10 in 6 variables).
+//
+
+class da_context
+{
+
+    public:
+        inline              da_context(size_t order, size_t variables);
+
+        inline size_t       index_of(const uint32_t *exponent_list) const;
+        inline bool         has_product_table() const;
+
+    public:
+        size_t                  order;
+        size_t                  variables;
+        size_t                  monomial_count;
+
+        std::vector<uint8_t>    exponents;
+        std::vector<uint8_t>    degree;
+        std::vector<uint32_t>   order_end;
+
+        std::vector<uint32_t>   low_code;
+        std::vector<uint32_t>   high_code;
+        std::vector<uint32_t>   low_rank;
+        std::vector<uint32_t>   high_offset;
+        std::vector<uint32_t>   address_to_index;
+
+        std::vector<uint32_t>   raise;
+        std::vector<uint32_t>   parent;
+        std::vector<uint8_t>    top_variable;
+
+        std::vector<size_t>     product_offset;
+        std::vector<uint32_t>   product_target;
+
+        std::vector<std::vector<uint32_t>>  derive_source;
+        std::vector<std::vector<uint32_t>>  derive_target;
+        std::vector<std::vector<double>>    derive_factor;
+
+    public:
+        static constexpr size_t product_table_limit = size_t(1) << 24;
+
+    protected:
+        size_t                  low_variables;
+        uint32_t                code_base;
+
+};
+
+inline std::unique_ptr<da_context>&
+da_active_context_storage()
+{
+
+    static std::unique_ptr<da_context> context = std::make_unique<da_context>(0, 0);
+    return context;
+
+}
+
+inline const da_context&
+da_active_context()
+{
+
+    return *da_active_context_storage();
+
+}
+
+inline void
+da_initialize(int64_t order, int64_t variables, int64_t parameters)
+{
+
+    // COSY counts parameters as additional variables of the series.
+    da_active_context_storage() = std::make_unique<da_context>(
+            static_cast<size_t>(std::max<int64_t>(order, 0)),
+            static_cast<size_t>(std::max<int64_t>(variables + parameters, 0)));
+
+}
+
+inline da_context::
+da_context(size_t order, size_t variables)
+    : order(order), variables(variables), monomial_count(0),
+      low_variables((variables + 1) / 2), code_base(static_cast<uint32_t>(order + 1))
+{
+
+    // Enumerate every monomial in graded order: by total order, then descending on
+    // the exponent of the first variable, then the second, and so on.
+    std::vector<uint32_t> current(variables, 0);
+    this->order_end.assign(order + 1, 0);
+    for (size_t total = 0; total <= order; ++total)
+    {
+
+        // Walk the compositions of total into the variables, first variable largest.
+        std::fill(current.begin(), current.end(), 0);
+        if (variables != 0) current[0] = static_cast<uint32_t>(total);
+        while (true)
+        {
+
+            if (variables != 0 || total == 0)
+            {
+                for (size_t v = 0; v < variables; ++v)
+                    this->exponents.push_back(static_cast<uint8_t>(current[v]));
+                this->degree.push_back(static_cast<uint8_t>(total));
+                this->monomial_count++;
+            }
+
+            // Step to the next composition: take one unit from the rightmost non-zero
+            // exponent before the last slot and move it, with the last slot's units,
+            // into the slot right after it.
+            if (variables < 2) break;
+            size_t pivot = variables - 1;
+            for (size_t v = variables - 1; v-- > 0;)
+            {
+                if (current[v] != 0) { pivot = v; break; }
+            }
+
+            if (pivot == variables - 1) break;
+            const uint32_t tail = current[variables - 1];
+            current[variables - 1] = 0;
+            current[pivot] -= 1;
+            current[pivot + 1] = tail + 1;
+
+        }
+
+        this->order_end[total] = static_cast<uint32_t>(this->monomial_count);
+
+    }
+
+    // Packed half codes for every monomial.
+    uint32_t low_table_size = 1;
+    uint32_t high_table_size = 1;
+    for (size_t v = 0; v < this->low_variables; ++v) low_table_size *= this->code_base;
+    for (size_t v = this->low_variables; v < variables; ++v) high_table_size *= this->code_base;
+
+    this->low_code.resize(this->monomial_count);
+    this->high_code.resize(this->monomial_count);
+    for (size_t m = 0; m < this->monomial_count; ++m)
+    {
+
+        uint32_t low = 0;
+        uint32_t high = 0;
+        for (size_t v = this->low_variables; v-- > 0;)
+            low = low * this->code_base + this->exponents[m * variables + v];
+        for (size_t v = variables; v-- > this->low_variables;)
+            high = high * this->code_base + this->exponents[m * variables + v];
+        this->low_code[m] = low;
+        this->high_code[m] = high;
+
+    }
+
+    // Monomials whose high half is zero appear in graded order of their low half,
+    // which gives the rank of every low part. Likewise for the high parts, each of
+    // which owns a block of addresses as long as the low parts that fit beside it.
+    std::vector<uint32_t> low_count_up_to(order + 1, 0);
+    this->low_rank.assign(low_table_size, 0);
+    this->high_offset.assign(high_table_size, 0);
+
+    uint32_t low_seen = 0;
+    for (size_t m = 0; m < this->monomial_count; ++m)
+    {
+        if (this->high_code[m] != 0) continue;
+        this->low_rank[this->low_code[m]] = low_seen++;
+        for (size_t k = this->degree[m]; k <= order; ++k) low_count_up_to[k]++;
+    }
+
+    uint32_t address = 0;
+    for (size_t m = 0; m < this->monomial_count; ++m)
+    {
+        if (this->low_code[m] != 0) continue;
+        this->high_offset[this->high_code[m]] = address;
+        address += low_count_up_to[order - this->degree[m]];
+    }
+
+    this->address_to_index.assign(this->monomial_count, 0);
+    for (size_t m = 0; m < this->monomial_count; ++m)
+    {
+        const uint32_t at = this->high_offset[this->high_code[m]] + this->low_rank[this->low_code[m]];
+        this->address_to_index[at] = static_cast<uint32_t>(m);
+    }
+
+    // The monomial tree. Every monomial but the constant has one parent, itself with
+    // one power of its highest variable removed, so the monomials a polynomial needs
+    // can be built one multiply each from the parent's value. raise gives the index of
+    // a monomial times each variable, or monomial_count past the truncation order.
+    this->raise.assign(this->monomial_count * variables, static_cast<uint32_t>(this->monomial_count));
+    this->parent.assign(this->monomial_count, 0);
+    this->top_variable.assign(this->monomial_count, 0);
+    std::vector<uint32_t> raised(variables);
+    for (size_t m = 0; m < this->monomial_count; ++m)
+    {
+
+        for (size_t v = 0; v < variables; ++v)
+        {
+            if (this->exponents[m * variables + v] != 0) this->top_variable[m] = static_cast<uint8_t>(v);
+            raised[v] = this->exponents[m * variables + v];
+        }
+
+        for (size_t v = 0; v < variables; ++v)
+        {
+            raised[v] += 1;
+            this->raise[m * variables + v] = static_cast<uint32_t>(this->index_of(raised.data()));
+            raised[v] -= 1;
+        }
+
+        if (m == 0) continue;
+        raised[this->top_variable[m]] -= 1;
+        this->parent[m] = static_cast<uint32_t>(this->index_of(raised.data()));
+
+    }
+
+    // Product table, skipped when the pair count would make it too large to be worth
+    // streaming through; the multiply then computes addresses from the codes instead.
+    size_t pair_count = 0;
+    for (size_t m = 0; m < this->monomial_count; ++m)
+        pair_count += this->order_end[order - this->degree[m]];
+
+    if (pair_count <= product_table_limit)
+    {
+
+        this->product_offset.resize(this->monomial_count + 1);
+        this->product_target.resize(pair_count);
+        size_t row = 0;
+        for (size_t i = 0; i < this->monomial_count; ++i)
+        {
+
+            this->product_offset[i] = row;
+            const uint32_t low = this->low_code[i];
+            const uint32_t high = this->high_code[i];
+            const size_t limit = this->order_end[order - this->degree[i]];
+            for (size_t j = 0; j < limit; ++j)
+            {
+                this->product_target[row++] = this->address_to_index[
+                    this->high_offset[high + this->high_code[j]] + this->low_rank[low + this->low_code[j]]];
+            }
+
+        }
+
+        this->product_offset[this->monomial_count] = row;
+
+    }
+
+    // Derivative tables, one list of (source, target, factor) per variable.
+    this->derive_source.resize(variables);
+    this->derive_target.resize(variables);
+    this->derive_factor.resize(variables);
+    std::vector<uint32_t> lowered(variables);
+    for (size_t v = 0; v < variables; ++v)
+    {
+        for (size_t m = 0; m < this->monomial_count; ++m)
+        {
+
+            const uint32_t power = this->exponents[m * variables + v];
+            if (power == 0) continue;
+
+            for (size_t w = 0; w < variables; ++w) lowered[w] = this->exponents[m * variables + w];
+            lowered[v] -= 1;
+
+            this->derive_source[v].push_back(static_cast<uint32_t>(m));
+            this->derive_target[v].push_back(static_cast<uint32_t>(this->index_of(lowered.data())));
+            this->derive_factor[v].push_back(static_cast<double>(power));
+
+        }
+    }
+
+}
+
+inline size_t da_context::
+index_of(const uint32_t *exponent_list) const
+{
+
+    uint32_t low = 0;
+    uint32_t high = 0;
+    size_t total = 0;
+    for (size_t v = this->low_variables; v-- > 0;)
+    {
+        low = low * this->code_base + exponent_list[v];
+        total += exponent_list[v];
+    }
+    for (size_t v = this->variables; v-- > this->low_variables;)
+    {
+        high = high * this->code_base + exponent_list[v];
+        total += exponent_list[v];
+    }
+
+    // Anything above the truncation order has no coefficient.
+    if (total > this->order) return this->monomial_count;
+    return this->address_to_index[this->high_offset[high] + this->low_rank[low]];
+
+}
+
+inline bool da_context::
+has_product_table() const
+{
+
+    return this->product_offset.size() == this->monomial_count + 1;
+
+}
+
+// --- DA Vector ---------------------------------------------------------------
+//
+// A DA vector made before OV ran, or left over from a different context, is sized
+// to the active context the first time it takes part in an operation. A vector
+// created that way is zero, so conforming it is just an allocation.
+//
+
+class da
+{
+
+    public:
+        inline          da();
+        inline          da(double constant);
+
+        inline double&  operator[](const size_t index);
+        inline double   operator[](const size_t index) const;
+
+        inline double*       data();
+        inline const double* data() const;
+        inline size_t   size() const;
+
+        inline double   constant() const;
+        inline void     conform();
+
+        inline da&      operator+=(const da &rhs);
+        inline da&      operator-=(const da &rhs);
+        inline da&      operator*=(const da &rhs);
+
+        inline da&      operator+=(double rhs);
+        inline da&      operator-=(double rhs);
+        inline da&      operator*=(double rhs);
+        inline da&      operator/=(double rhs);
+
+    protected:
+        std::vector<double, pool_allocator<double>> coefficients;
+
+};
+
+inline da::
+da()
+    : coefficients(da_active_context().monomial_count, 0.0)
+{
+
+}
+
+inline da::
+da(double constant)
+    : coefficients(da_active_context().monomial_count, 0.0)
+{
+
+    this->coefficients[0] = constant;
+
+}
+
+inline double& da::
+operator[](const size_t index)
+{
+
+    return this->coefficients[index];
+
+}
+
+inline double da::
+operator[](const size_t index) const
+{
+
+    return this->coefficients[index];
+
+}
+
+inline double* da::
+data()
+{
+
+    return this->coefficients.data();
+
+}
+
+inline const double* da::
+data() const
+{
+
+    return this->coefficients.data();
+
+}
+
+inline size_t da::
+size() const
+{
+
+    return this->coefficients.size();
+
+}
+
+inline double da::
+constant() const
+{
+
+    return this->coefficients.empty() ? 0.0 : this->coefficients[0];
+
+}
+
+inline void da::
+conform()
+{
+
+    const size_t count = da_active_context().monomial_count;
+    if (this->coefficients.size() != count) this->coefficients.resize(count, 0.0);
+
+}
+
+inline da& da::
+operator+=(const da &rhs)
+{
+
+    this->conform();
+    dvector_dispatch<simd_op::OP_ADD>(this->data(), rhs.data(), std::min(this->size(), rhs.size()));
+    return *this;
+
+}
+
+inline da& da::
+operator-=(const da &rhs)
+{
+
+    this->conform();
+    dvector_dispatch<simd_op::OP_SUB>(this->data(), rhs.data(), std::min(this->size(), rhs.size()));
+    return *this;
+
+}
+
+inline da& da::
+operator+=(double rhs)
+{
+
+    this->conform();
+    this->coefficients[0] += rhs;
+    return *this;
+
+}
+
+inline da& da::
+operator-=(double rhs)
+{
+
+    this->conform();
+    this->coefficients[0] -= rhs;
+    return *this;
+
+}
+
+inline da& da::
+operator*=(double rhs)
+{
+
+    this->conform();
+    dvector_dispatch<simd_op::OP_MUL>(this->data(), rhs, this->size());
+    return *this;
+
+}
+
+inline da& da::
+operator/=(double rhs)
+{
+
+    this->conform();
+    dvector_dispatch<simd_op::OP_DIV>(this->data(), rhs, this->size());
+    return *this;
+
+}
+
+// --- DA Kernels --------------------------------------------------------------
+//
+// The prefix kernel walks a in graded order and, for each coefficient, the prefix of
+// b that survives truncation. The codes of b stream alongside its coefficients and
+// the address tables are small, so the only scattered access is the accumulation
+// into the result, which is no larger than a and b themselves.
+//
+// The table kernel reads the product indices from the context instead, and skips
+// zero coefficients on both sides. Terms of a that are zero are passed over whole
+// rows at a time. For b it builds the list of non-zero indices once, along with where
+// each order's prefix ends in that list, so a sparse b only visits its own non-zero
+// terms. Maps built from a few DA variables are mostly zero at low orders, which is
+// where this pays for itself; a dense b goes back to the contiguous prefix.
+//
+
+inline void
+da_multiply_prefix_kernel(const da_context &context, const double *lhs, const double *rhs, double *result)
+{
+
+    const uint32_t *low_code    = context.low_code.data();
+    const uint32_t *high_code   = context.high_code.data();
+    const uint32_t *low_rank    = context.low_rank.data();
+    const uint32_t *high_offset = context.high_offset.data();
+    const uint32_t *address     = context.address_to_index.data();
+
+    std::fill(result, result + context.monomial_count, 0.0);
+    for (size_t i = 0; i < context.monomial_count; ++i)
+    {
+
+        const double a = lhs[i];
+        if (a == 0.0) continue;
+
+        const uint32_t low = low_code[i];
+        const uint32_t high = high_code[i];
+        const size_t limit = context.order_end[context.order - context.degree[i]];
+        for (size_t j = 0; j < limit; ++j)
+        {
+            result[address[high_offset[high + high_code[j]] + low_rank[low + low_code[j]]]] += a * rhs[j];
+        }
+
+    }
+
+}
+
+inline void
+da_multiply_table_kernel(const da_context &context, const double *lhs, const double *rhs, double *result)
+{
+
+    const size_t *offset    = context.product_offset.data();
+    const uint32_t *target  = context.product_target.data();
+    const size_t count      = context.monomial_count;
+
+    // Non-zero terms of b, and for every order k the number of them below order_end[k].
+    thread_local std::vector<uint32_t> nonzero;
+    thread_local std::vector<uint32_t> nonzero_end;
+    nonzero.clear();
+    nonzero_end.assign(context.order + 1, 0);
+    for (size_t k = 0, j = 0; k <= context.order; ++k)
+    {
+        for (; j < context.order_end[k]; ++j)
+        {
+            if (rhs[j] != 0.0) nonzero.push_back(static_cast<uint32_t>(j));
+        }
+        nonzero_end[k] = static_cast<uint32_t>(nonzero.size());
+    }
+
+    std::fill(result, result + count, 0.0);
+    const bool sparse = nonzero.size() * 2 < count;
+    for (size_t i = 0; i < count; ++i)
+    {
+
+        const double a = lhs[i];
+        if (a == 0.0) continue;
+
+        const uint32_t *row = target + offset[i];
+        const size_t remaining = context.order - context.degree[i];
+        if (sparse)
+        {
+            const uint32_t *terms = nonzero.data();
+            const size_t limit = nonzero_end[remaining];
+            for (size_t t = 0; t < limit; ++t) result[row[terms[t]]] += a * rhs[terms[t]];
+        }
+        else
+        {
+            const size_t limit = context.order_end[remaining];
+            for (size_t j = 0; j < limit; ++j) result[row[j]] += a * rhs[j];
+        }
+
+    }
+
+}
+
+inline void
+da_multiply_kernel(const da_context &context, const double *lhs, const double *rhs, double *result)
+{
+
+    if (context.has_product_table())
+        da_multiply_table_kernel(context, lhs, rhs, result);
+    else
+        da_multiply_prefix_kernel(context, lhs, rhs, result);
+
+}
+
+inline void
+da_derive_kernel(const da_context &context, size_t variable, const double *source, double *result)
+{
+
+    const uint32_t *from    = context.derive_source[variable].data();
+    const uint32_t *to      = context.derive_target[variable].data();
+    const double *factor    = context.derive_factor[variable].data();
+    const size_t count      = context.derive_source[variable].size();
+
+    std::fill(result, result + context.monomial_count, 0.0);
+    for (size_t k = 0; k < count; ++k) result[to[k]] = factor[k] * source[from[k]];
+
+}
+
+inline da& da::
+operator*=(const da &rhs)
+{
+
+    da product;
+    da conformed = rhs;
+    this->conform();
+    conformed.conform();
+    da_multiply_kernel(da_active_context(), this->data(), conformed.data(), product.data());
+    *this = std::move(product);
+    return *this;
+
+}
+
+// --- DA Operators ------------------------------------------------------------
+//
+// The left operand is taken by value so a temporary on the left is reused for the
+// result rather than copied.
+//
+
+inline da operator+(da lhs, const da &rhs)      { lhs += rhs; return lhs; }
+inline da operator-(da lhs, const da &rhs)      { lhs -= rhs; return lhs; }
+inline da operator+(da lhs, double rhs)         { lhs += rhs; return lhs; }
+inline da operator-(da lhs, double rhs)         { lhs -= rhs; return lhs; }
+inline da operator*(da lhs, double rhs)         { lhs *= rhs; return lhs; }
+inline da operator/(da lhs, double rhs)         { lhs /= rhs; return lhs; }
+inline da operator+(double lhs, da rhs)         { rhs += lhs; return rhs; }
+inline da operator*(double lhs, da rhs)         { rhs *= lhs; return rhs; }
+inline da operator-(da rhs)                     { rhs *= -1.0; return rhs; }
+inline da operator-(double lhs, da rhs)         { rhs *= -1.0; rhs += lhs; return rhs; }
+
+inline da
+operator*(const da &lhs, const da &rhs)
+{
+
+    da product;
+    if (lhs.size() == product.size() && rhs.size() == product.size())
+    {
+        da_multiply_kernel(da_active_context(), lhs.data(), rhs.data(), product.data());
+        return product;
+    }
+
+    product = lhs;
+    product *= rhs;
+    return product;
+
+}
+
+// --- COSY Operations ---------------------------------------------------------
+//
+// The runtime side of COSY's DA intrinsics and operators. Variables and exponent
+// vectors are numbered from one, as in COSY.
+//
+
+inline da
+da_variable(int64_t variable)
+{
+
+    da result;
+    const da_context &context = da_active_context();
+    if (variable >= 1 && static_cast<size_t>(variable) <= context.variables && context.order >= 1)
+        result[static_cast<size_t>(variable)] = 1.0;
+    return result;
+
+}
+
+inline double
+da_constant(const da &value)
+{
+
+    return value.constant();
+
+}
+
+inline da
+da_derive(const da &value, int64_t variable)
+{
+
+    // The derivative with respect to a variable the context doesn't have is zero.
+    da result;
+    da source = value;
+    source.conform();
+    const da_context &context = da_active_context();
+    if (variable >= 1 && static_cast<size_t>(variable) <= context.variables)
+        da_derive_kernel(context, static_cast<size_t>(variable - 1), source.data(), result.data());
+    return result;
+
+}
+
+template <class E> inline double
+cosy_extract(const da &value, const dvector_expression<E> &exponent_vector)
+{
+
+    const da_context &context = da_active_context();
+    const E& source = exponent_vector.self();
+
+    std::vector<uint32_t> exponent_list(context.variables, 0);
+    for (size_t v = 0; v < std::min(context.variables, E::length); ++v)
+        exponent_list[v] = static_cast<uint32_t>(std::max(0.0, static_cast<double>(source.evaluate(v))));
+
+    const size_t index = context.index_of(exponent_list.data());
+    return index < value.size() ? value[index] : 0.0;
+
+}
+
+template <class E> inline auto
+cosy_extract(const dvector_expression<E> &vector, int64_t component)
+{
+
+    return vector.self().evaluate(static_cast<size_t>(component - 1));
+
+}
+
+inline std::ostream&
+operator<<(std::ostream &os, const da &value)
+{
+
+    // One line per non-zero coefficient with its order and exponents, as COSY does.
+    const da_context &context = da_active_context();
+    size_t printed = 0;
+    for (size_t m = 0; m < std::min(value.size(), context.monomial_count); ++m)
+    {
+
+        if (value[m] == 0.0) continue;
+        os << std::setw(6) << ++printed << "  " << std::setw(24) << std::scientific
+           << std::setprecision(15) << value[m] << std::defaultfloat << std::setw(4)
+           << static_cast<int>(context.degree[m]) << " ";
+        for (size_t v = 0; v < context.variables; ++v)
+            os << " " << static_cast<int>(context.exponents[m * context.variables + v]);
+        os << "\n";
+
+    }
+
+    if (printed == 0) os << "      ALL COMPONENTS ZERO\n";
+    return os;
+
+}
+
+#endif
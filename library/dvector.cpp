@@ -3,35 +3,89 @@
 #include <string>
 #include <iostream>
 #include <functional>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <algorithm>
 #include "dvector.hpp"
+#include "benchmark.hpp"
 
-class HighResolutionTimer
+// Every heap allocation made by the benchmark routes through here so that we can
+// report how often the storage mode actually hits the allocator.
+static size_t heap_allocation_count = 0;
+
+void*
+operator new(size_t size)
 {
 
-    public:
-        void start()
-        {
-            start_time = std::chrono::high_resolution_clock::now();
-        }
+    heap_allocation_count++;
+    void *result = std::malloc(size);
+    if (result == nullptr) throw std::bad_alloc();
+    return result;
 
-        double stop()
-        {
-            auto end_time = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double> duration = end_time - start_time;
-            return duration.count(); // Returns the time in seconds
-        }
+}
 
-        double measure(std::function<void()> func)
-        {
-            start();
-            func();
-            auto result = stop();
-            return result;
-        }
+void
+operator delete(void *ptr) noexcept
+{
+
+    std::free(ptr);
+
+}
 
-    private:
-        std::chrono::high_resolution_clock::time_point start_time;
-};
+void
+operator delete(void *ptr, size_t size) noexcept
+{
+
+    std::free(ptr);
+
+}
+
+void*
+operator new(size_t size, std::align_val_t alignment)
+{
+
+    heap_allocation_count++;
+    const size_t align = static_cast<size_t>(alignment);
+#   if defined(_MSC_VER)
+        void *result = _aligned_malloc(size, align);
+#   else
+        void *result = std::aligned_alloc(align, (size + align - 1) / align * align);
+#   endif
+    if (result == nullptr) throw std::bad_alloc();
+    return result;
+
+}
+
+void
+operator delete(void *ptr, std::align_val_t alignment) noexcept
+{
+
+#   if defined(_MSC_VER)
+        _aligned_free(ptr);
+#   else
+        std::free(ptr);
+#   endif
+
+}
+
+void
+operator delete(void *ptr, size_t size, std::align_val_t alignment) noexcept
+{
+
+    operator delete(ptr, alignment);
+
+}
+
+template <class T, size_t L> dvector<T,L>
+halved(const dvector<T,L> &vector)
+{
+
+    dvector<T,L> result = vector;
+    result *= T(0.5);
+    return result;
+
+}
 
 void sample_runtime()
 {
@@ -48,8 +102,263 @@ void sample_runtime()
         a_vector -= (b_vector / 2.0);
         a_vector += b_vector;
 
+        // The shape of code the generator emits, evaluated as one fused loop.
+        a_vector = a_vector + b_vector * 0.5 - b_vector;
+        a_vector = a_vector * 0.5 + (b_vector - a_vector) * b_vector / 4.0;
+
+        // Function results are rvalues, the operators compute into their buffer.
+        dvector<double, 8> c_vector = halved(b_vector) + a_vector * 2.0 - b_vector;
+        a_vector -= c_vector;
+
+    }
+
+    benchmark_sink = a_vector[0] + b_vector[7];
+
+}
+
+bool verify_expressions()
+{
+
+    dvector<double, 5> a_vector = { 1.0, 2.0, 3.0, 4.0, 5.0 };
+    dvector<double, 5> b_vector = { 2.0, 2.0, 2.0, 2.0, 2.0 };
+
+    // Scalar on the left must not be commuted for the non-commutative operators.
+    dvector<double, 5> left_sub = 10.0 - a_vector;
+    dvector<double, 5> left_div = 12.0 / b_vector;
+    dvector<double, 5> mixed    = -(a_vector + b_vector * a_vector) / 3.0;
+
+    // Assigning into an operand of the expression.
+    dvector<double, 5> aliased = a_vector;
+    aliased = aliased * b_vector - aliased;
+
+    // Rvalue operands on either side, including the non-commutative reversals.
+    dvector<double, 5> recycled_left    = halved(a_vector) - b_vector * 3.0;
+    dvector<double, 5> recycled_right   = 1.0 - b_vector / halved(a_vector);
+    dvector<double, 5> recycled_both    = halved(a_vector) / halved(b_vector);
+
+    // Moving out of a vector leaves it assignable.
+    dvector<double, 5> moved_from = a_vector;
+    dvector<double, 5> moved_to = std::move(moved_from);
+    moved_from = b_vector - a_vector;
+
+    bool passed = true;
+    for (size_t i = 0; i < 5; ++i)
+    {
+
+        const double a = a_vector[i];
+        const double b = b_vector[i];
+        passed = passed && left_sub[i] == 10.0 - a;
+        passed = passed && left_div[i] == 12.0 / b;
+        passed = passed && mixed[i] == -(a + b * a) / 3.0;
+        passed = passed && aliased[i] == a * b - a;
+        passed = passed && recycled_left[i] == a * 0.5 - b * 3.0;
+        passed = passed && recycled_right[i] == 1.0 - b / (a * 0.5);
+        passed = passed && recycled_both[i] == (a * 0.5) / (b * 0.5);
+        passed = passed && moved_to[i] == a;
+        passed = passed && moved_from[i] == b - a;
+
+    }
+
+    return passed;
+
+}
+
+// Every instruction set's reductions have to agree with the scalar ones at each
+// length up to a few registers, which walks through all of the tail handling.
+template <class T> bool
+verify_reductions()
+{
+
+    constexpr size_t length = 40;
+    const T tolerance = std::is_same_v<T, float> ? T(1e-5) : T(1e-12);
+
+    using buffer = std::vector<T, dvector_aligned_allocator<T, 64>>;
+    buffer lhs(length);
+    buffer rhs(length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        lhs[i] = T(1) + T((i * 7) % 11) / T(4) - T(i % 3);
+        rhs[i] = T(0.5) - T((i * 5) % 13) / T(8);
+    }
+
+    const dvector_kernel_table<T> reference = dvector_kernels_for<T>(simd_isa::ISA_SCALAR);
+    auto close = [tolerance](T a, T b) { return std::abs(a - b) <= tolerance * (T(1) + std::abs(b)); };
+
+    bool passed = true;
+    for (int isa_index = 0; isa_index <= static_cast<int>(simd_detect_isa()); ++isa_index)
+    {
+
+        const dvector_kernel_table<T> table = dvector_kernels_for<T>(static_cast<simd_isa>(isa_index));
+        for (size_t count = 1; count <= length; ++count)
+        {
+
+            passed = passed && close(table.dot(lhs.data(), rhs.data(), count),
+                    reference.dot(lhs.data(), rhs.data(), count));
+            passed = passed && close(table.sum(lhs.data(), count), reference.sum(lhs.data(), count));
+            passed = passed && table.minimum(rhs.data(), count) == reference.minimum(rhs.data(), count);
+            passed = passed && table.maximum(rhs.data(), count) == reference.maximum(rhs.data(), count);
+
+            buffer result = rhs;
+            buffer expected = rhs;
+            table.axpy(result.data(), T(1.5), lhs.data(), count);
+            reference.axpy(expected.data(), T(1.5), lhs.data(), count);
+            for (size_t i = 0; i < length; ++i) passed = passed && close(result[i], expected[i]);
+
+        }
+
     }
 
+    // The wrappers the COSY intrinsics lower to, including expression operands.
+    dvector<T, 5> a_vector = { T(3), T(-1), T(4), T(0), T(2) };
+    dvector<T, 5> b_vector = { T(1), T(2), T(-2), T(5), T(1) };
+    passed = passed && dvector_dot(a_vector, b_vector) == T(-5);
+    passed = passed && dvector_dot(a_vector * T(2), b_vector) == T(-10);
+    passed = passed && close(dvector_norm(a_vector), std::sqrt(T(30)));
+    passed = passed && dvector_sum(a_vector - b_vector) == T(1);
+    passed = passed && dvector_min(a_vector) == T(-1);
+    passed = passed && dvector_max(b_vector) == T(5);
+    passed = passed && dvector_axpy(T(2), a_vector, b_vector) == dvector<T, 5>(T(2) * a_vector + b_vector);
+    passed = passed && dvector_axpy(2, a_vector, b_vector + T(1)) == dvector<T, 5>(T(2) * a_vector + b_vector + T(1));
+
+    return passed;
+
+}
+
+// Plants every kind of fault at scattered positions and checks that each
+// instruction set flags exactly the components the scalar classification does.
+template <class T> bool
+verify_classification()
+{
+
+    constexpr size_t length = 70;
+    using limits = std::numeric_limits<T>;
+
+    using buffer = std::vector<T, dvector_aligned_allocator<T, 64>>;
+    buffer values(length);
+    for (size_t i = 0; i < length; ++i) values[i] = T(i % 9) - T(4);
+    values[3]   = limits::quiet_NaN();
+    values[17]  = limits::infinity();
+    values[31]  = -limits::infinity();
+    values[40]  = limits::denorm_min();
+    values[63]  = -limits::quiet_NaN();
+    values[64]  = -limits::denorm_min();
+    values[69]  = limits::infinity();
+
+    const uint32_t fault_sets[] = { FAULT_NAN, FAULT_POSITIVE_INF, FAULT_NEGATIVE_INF,
+        FAULT_INF, FAULT_SUBNORMAL, FAULT_ANY };
+    const dvector_kernel_table<T> reference = dvector_kernels_for<T>(simd_isa::ISA_SCALAR);
+
+    bool passed = true;
+    for (int isa_index = 0; isa_index <= static_cast<int>(simd_detect_isa()); ++isa_index)
+    {
+
+        const dvector_kernel_table<T> table = dvector_kernels_for<T>(static_cast<simd_isa>(isa_index));
+        for (uint32_t faults : fault_sets)
+        {
+            for (size_t count = 1; count <= length; ++count)
+            {
+                uint64_t mask[2];
+                uint64_t expected[2];
+                table.classify(values.data(), count, faults, mask);
+                reference.classify(values.data(), count, faults, expected);
+                for (size_t w = 0; w < (count + 63) / 64; ++w) passed = passed && mask[w] == expected[w];
+            }
+        }
+
+    }
+
+    dvector<T, 5> particle = { T(1), T(0), T(-2), T(3), T(4) };
+    passed = passed && particle.contains_valid_components();
+    particle[2] = limits::infinity();
+    particle[4] = limits::quiet_NaN();
+    const dvector_mask<5> bad = particle.classify();
+    passed = passed && bad.count() == 2 && bad.test(2) && bad.test(4) && !bad.test(0);
+    passed = passed && particle.contains_nans() && particle.contains_positive_inf();
+    passed = passed && !particle.contains_negative_inf() && !particle.contains_valid_components();
+    passed = passed && particle.valid_at(1) && !particle.valid_at(2);
+    passed = passed && particle.valid_in_range(0, 2) && !particle.valid_in_range(3, 5);
+
+    return passed;
+
+}
+
+// Runs the fused multiply-add kernel of every instruction set the machine supports
+// over a large aligned buffer. Each path has to agree with the scalar one, and the
+// path that dispatch actually picks has to beat the scalar one.
+template <class T> bool
+throughput_check(const char *type_name)
+{
+
+    constexpr size_t length         = 4096;
+    constexpr size_t repetitions    = 2000;
+    constexpr size_t trials         = 5;
+    const T tolerance = std::is_same_v<T, float> ? T(1e-5) : T(1e-12);
+
+    using buffer = std::vector<T, dvector_aligned_allocator<T, 64>>;
+    buffer multiplier(length);
+    buffer addend(length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        multiplier[i]   = T(0.5) + T(i % 7) / T(16);
+        addend[i]       = T(0.25) + T(i % 5) / T(8);
+    }
+
+    buffer reference;
+    double scalar_rate  = 0.0;
+    double active_rate  = 0.0;
+    bool passed         = true;
+
+    const simd_isa detected = simd_detect_isa();
+    const simd_isa active   = simd_active_isa();
+    for (int isa_index = 0; isa_index <= static_cast<int>(detected); ++isa_index)
+    {
+
+        const simd_isa isa = static_cast<simd_isa>(isa_index);
+        const dvector_kernel_table<T> table = dvector_kernels_for<T>(isa);
+
+        buffer values(length);
+        double best_time = 1e30;
+        for (size_t trial = 0; trial < trials; ++trial)
+        {
+
+            std::fill(values.begin(), values.end(), T(1));
+
+            HighResolutionTimer timer;
+            timer.start();
+            for (size_t r = 0; r < repetitions; ++r)
+            {
+                table.vector_fma(values.data(), multiplier.data(), addend.data(), length);
+            }
+            best_time = std::min(best_time, timer.stop());
+
+        }
+
+        const double rate = 2.0 * length * repetitions / best_time * 1e-9;
+        if (isa == simd_isa::ISA_SCALAR)
+        {
+            reference = values;
+            scalar_rate = rate;
+        }
+
+        if (isa == active) active_rate = rate;
+
+        bool matches = true;
+        for (size_t i = 0; i < length; ++i)
+        {
+            const T difference = std::abs(values[i] - reference[i]);
+            if (difference > tolerance * std::abs(reference[i])) matches = false;
+        }
+
+        passed = passed && matches;
+        std::cout << "    " << simd_isa_name(isa) << " " << type_name << ": "
+                  << rate << " GFLOP/s (" << rate / scalar_rate << "x scalar)"
+                  << (matches ? "" : " MISMATCH") << std::endl;
+
+    }
+
+    if (active != simd_isa::ISA_SCALAR && active_rate <= scalar_rate) passed = false;
+    return passed;
+
 }
 
 int 
@@ -59,6 +368,10 @@ main(int argc, char ** argv)
     if (argc < 2) return -1;
     std::cout << "Performing dvector benchmark..." << std::endl;
 
+    size_t allocations_before = heap_allocation_count;
+    sample_runtime();
+    size_t allocations_per_run = heap_allocation_count - allocations_before;
+
     double minimum_time = 10000000000000.0;
     double maximum_time = 0.0;
     double average_time = 0.0;
@@ -76,11 +389,28 @@ main(int argc, char ** argv)
     average_time /= std::stoi(argv[1]);
 
     std::cout << "Test: " << TEST_NAME << std::endl;
+#   if SF_DVECTOR_HEAP_STORAGE == 1
+    std::cout << "Storage mode: heap (std::vector)" << std::endl;
+#   else
+    std::cout << "Storage mode: inline (aligned std::array)" << std::endl;
+#   endif
+    std::cout << "SIMD path: " << simd_isa_name(simd_active_isa()) << std::endl;
+    std::cout << "Heap allocations per run: " << allocations_per_run << std::endl;
+    std::cout << "Expression check: " << (verify_expressions() ? "passed" : "FAILED") << std::endl;
+    const bool reductions_passed = verify_reductions<double>() && verify_reductions<float>();
+    std::cout << "Reduction check: " << (reductions_passed ? "passed" : "FAILED") << std::endl;
+    const bool classification_passed = verify_classification<double>() && verify_classification<float>();
+    std::cout << "Classification check: " << (classification_passed ? "passed" : "FAILED") << std::endl;
     std::cout << "Average runtime: " << average_time << "s" << std::endl;
     std::cout << "Minimum runtime: " << minimum_time << "s" << std::endl;
     std::cout << "Maximum runtime: " << maximum_time << "s" << std::endl;
 
-    return 0;
+    std::cout << "FMA throughput:" << std::endl;
+    bool throughput_passed = throughput_check<double>("double");
+    throughput_passed = throughput_check<float>("float") && throughput_passed;
+    std::cout << "Throughput check: " << (throughput_passed ? "passed" : "FAILED") << std::endl;
+
+    return throughput_passed && reductions_passed && classification_passed ? 0 : 1;
 
 }
 
@@ -3,45 +3,739 @@
 #include <array>
 #include <vector>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 #include <cmath>
 #include <limits>
 #include <iostream>
 #include <initializer_list>
+#include <new>
+#include "simd.hpp"
+#include "pool.hpp"
+
+// --- Storage Configuration ---------------------------------------------------
+//
+// By default, dvector stores its components in an aligned, inline buffer that is
+// sized from the compile-time length L, so constructing the temporaries that the
+// arithmetic operators return never touches the allocator. The buffer is aligned
+// to 64 bytes, the width of an AVX-512 register, and padded out to a whole number
+// of them with zeroed lanes, so every kernel can use aligned loads and stores.
+//
+// Defining SF_DVECTOR_HEAP_STORAGE=1 restores the heap-backed std::vector storage.
+// This is mostly useful for benchmarking the two against each other. The vector
+// draws its buffers from the thread's buffer pool, see pool.hpp, which keeps them
+// aligned, since std::allocator only guarantees the alignment of max_align_t.
+//
+
+#if !defined(SF_DVECTOR_HEAP_STORAGE)
+#   define SF_DVECTOR_HEAP_STORAGE 0
+#endif
+
+template <class T, size_t A>
+class dvector_aligned_allocator
+{
+
+    public:
+        using value_type = T;
+        template <class U> struct rebind { using other = dvector_aligned_allocator<U, A>; };
+
+    public:
+        inline          dvector_aligned_allocator() = default;
+        template <class U>
+        inline          dvector_aligned_allocator(const dvector_aligned_allocator<U, A> &) { }
+
+        inline T*       allocate(size_t count)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(A)));
+        }
+
+        inline void     deallocate(T *ptr, size_t)
+        {
+            ::operator delete(ptr, std::align_val_t(A));
+        }
+
+        template <class U>
+        inline bool     operator==(const dvector_aligned_allocator<U, A> &) const { return true; }
+        template <class U>
+        inline bool     operator!=(const dvector_aligned_allocator<U, A> &) const { return false; }
+
+};
+
+// --- Classification ----------------------------------------------------------
+//
+// The validity checks classify every component in one pass and hand back a mask
+// with a bit set for each component that has one of the requested faults. Zero is
+// a valid value, subnormals are not, since they mostly show up right before a value
+// collapses and they run far slower than normal values on most hardware.
+//
+
+enum dvector_fault : uint32_t
+{
+    FAULT_NAN           = 1 << 0,
+    FAULT_POSITIVE_INF  = 1 << 1,
+    FAULT_NEGATIVE_INF  = 1 << 2,
+    FAULT_SUBNORMAL     = 1 << 3,
+    FAULT_INF           = FAULT_POSITIVE_INF | FAULT_NEGATIVE_INF,
+    FAULT_ANY           = FAULT_NAN | FAULT_INF | FAULT_SUBNORMAL,
+};
+
+template <class T> inline uint32_t
+dvector_fault_kinds(T value)
+{
+
+    if constexpr (!std::is_floating_point_v<T>)
+    {
+        return 0;
+    }
+    else
+    {
+        const T magnitude           = std::abs(value);
+        const uint32_t nan          = std::isnan(value);
+        const uint32_t infinite     = magnitude == std::numeric_limits<T>::infinity();
+        const uint32_t negative     = value < T(0);
+        const uint32_t subnormal    = magnitude < std::numeric_limits<T>::min() && value != T(0);
+        return (nan * FAULT_NAN)
+             | ((infinite & (negative ^ 1)) * FAULT_POSITIVE_INF)
+             | ((infinite & negative) * FAULT_NEGATIVE_INF)
+             | (subnormal * FAULT_SUBNORMAL);
+    }
+
+}
+
+template <size_t L>
+class dvector_mask
+{
+
+    public:
+        static constexpr size_t word_count = (L + 63) / 64;
+
+    public:
+        inline bool     any() const;
+        inline bool     test(const size_t index) const;
+        inline size_t   count() const;
+
+    public:
+        uint64_t        words[word_count];
+
+};
+
+template <size_t L> inline bool dvector_mask<L>::
+any() const
+{
+
+    uint64_t combined = 0;
+    for (size_t w = 0; w < word_count; ++w) combined |= this->words[w];
+    return combined != 0;
+
+}
+
+template <size_t L> inline bool dvector_mask<L>::
+test(const size_t index) const
+{
+
+    return (this->words[index / 64] >> (index % 64)) & 1;
+
+}
+
+template <size_t L> inline size_t dvector_mask<L>::
+count() const
+{
+
+    size_t result = 0;
+    for (size_t w = 0; w < word_count; ++w)
+    {
+        for (uint64_t bits = this->words[w]; bits != 0; bits &= bits - 1) ++result;
+    }
+
+    return result;
+
+}
+
+// --- Component-wise Kernels --------------------------------------------------
+//
+// The component-wise operations between a dvector and another dvector or a scalar
+// go through a table of kernels chosen at runtime, see simd.hpp. The kernels for
+// each instruction set are stamped out from the macro below inside that set's
+// namespace and target region. The scalar table covers every other value type as
+// well as machines without any SIMD support.
+//
+// Kernels expect every pointer to be aligned to 64 bytes, which dvector guarantees.
+// They stop at count rather than running into the padding, which keeps the padding
+// lanes zeroed regardless of the operation. The reductions keep one register of
+// partial results and only fold its lanes together at the end. The dot product
+// keeps two so consecutive fused multiply-adds don't wait on each other.
+//
+
+template <class T>
+struct dvector_kernel_table
+{
+    void (*vector_kernels[4])(T *dst, const T *src, size_t count);
+    void (*scalar_kernels[4])(T *dst, T value, size_t count);
+    void (*vector_fma)(T *dst, const T *multiplier, const T *addend, size_t count);
+    void (*scalar_fma)(T *dst, T multiplier, T addend, size_t count);
+    T    (*dot)(const T *lhs, const T *rhs, size_t count);
+    T    (*sum)(const T *src, size_t count);
+    T    (*minimum)(const T *src, size_t count);
+    T    (*maximum)(const T *src, size_t count);
+    void (*axpy)(T *dst, T alpha, const T *src, size_t count);
+    void (*classify)(const T *src, size_t count, uint32_t faults, uint64_t *mask);
+};
+
+template <simd_op OP, class T> inline T
+dvector_apply(T a, T b)
+{
+
+    if constexpr (OP == simd_op::OP_ADD) return a + b;
+    else if constexpr (OP == simd_op::OP_SUB) return a - b;
+    else if constexpr (OP == simd_op::OP_MUL) return a * b;
+    else return a / b;
+
+}
+
+#define SF_DVECTOR_DEFINE_KERNELS                                                           \
+    template <simd_op OP, class T> inline typename lanes<T>::reg                            \
+    dvector_lane_apply(typename lanes<T>::reg a, typename lanes<T>::reg b)                  \
+    {                                                                                       \
+        if constexpr (OP == simd_op::OP_ADD) return lanes<T>::add(a, b);                    \
+        else if constexpr (OP == simd_op::OP_SUB) return lanes<T>::sub(a, b);               \
+        else if constexpr (OP == simd_op::OP_MUL) return lanes<T>::mul(a, b);               \
+        else return lanes<T>::div(a, b);                                                    \
+    }                                                                                       \
+                                                                                            \
+    template <simd_op OP, class T> inline void                                              \
+    dvector_vector_kernel(T *dst, const T *src, size_t count)                               \
+    {                                                                                       \
+        size_t i = 0;                                                                       \
+        for (; i + lanes<T>::width <= count; i += lanes<T>::width)                          \
+        {                                                                                   \
+            typename lanes<T>::reg a = lanes<T>::load_aligned(dst + i);                     \
+            typename lanes<T>::reg b = lanes<T>::load_aligned(src + i);                     \
+            lanes<T>::store_aligned(dst + i, dvector_lane_apply<OP, T>(a, b));              \
+        }                                                                                   \
+        for (; i < count; ++i) dst[i] = dvector_apply<OP>(dst[i], src[i]);                  \
+    }                                                                                       \
+                                                                                            \
+    template <simd_op OP, class T> inline void                                              \
+    dvector_scalar_kernel(T *dst, T value, size_t count)                                    \
+    {                                                                                       \
+        const typename lanes<T>::reg b = lanes<T>::set1(value);                             \
+        size_t i = 0;                                                                       \
+        for (; i + lanes<T>::width <= count; i += lanes<T>::width)                          \
+        {                                                                                   \
+            typename lanes<T>::reg a = lanes<T>::load_aligned(dst + i);                     \
+            lanes<T>::store_aligned(dst + i, dvector_lane_apply<OP, T>(a, b));              \
+        }                                                                                   \
+        for (; i < count; ++i) dst[i] = dvector_apply<OP>(dst[i], value);                   \
+    }                                                                                       \
+                                                                                            \
+    template <class T> inline void                                                          \
+    dvector_vector_fma(T *dst, const T *multiplier, const T *addend, size_t count)          \
+    {                                                                                       \
+        size_t i = 0;                                                                       \
+        for (; i + lanes<T>::width <= count; i += lanes<T>::width)                          \
+        {                                                                                   \
+            typename lanes<T>::reg a = lanes<T>::load_aligned(dst + i);                     \
+            typename lanes<T>::reg b = lanes<T>::load_aligned(multiplier + i);              \
+            typename lanes<T>::reg c = lanes<T>::load_aligned(addend + i);                  \
+            lanes<T>::store_aligned(dst + i, lanes<T>::fmadd(a, b, c));                     \
+        }                                                                                   \
+        for (; i < count; ++i) dst[i] = dst[i] * multiplier[i] + addend[i];                 \
+    }                                                                                       \
+                                                                                            \
+    template <class T> inline void                                                          \
+    dvector_scalar_fma(T *dst, T multiplier, T addend, size_t count)                        \
+    {                                                                                       \
+        const typename lanes<T>::reg b = lanes<T>::set1(multiplier);                        \
+        const typename lanes<T>::reg c = lanes<T>::set1(addend);                            \
+        size_t i = 0;                                                                       \
+        for (; i + lanes<T>::width <= count; i += lanes<T>::width)                          \
+        {                                                                                   \
+            typename lanes<T>::reg a = lanes<T>::load_aligned(dst + i);                     \
+            lanes<T>::store_aligned(dst + i, lanes<T>::fmadd(a, b, c));                     \
+        }                                                                                   \
+        for (; i < count; ++i) dst[i] = dst[i] * multiplier + addend;                       \
+    }                                                                                       \
+                                                                                            \
+    template <class T, class F> inline T                                                \
+    dvector_lane_reduce(typename lanes<T>::reg v, F combine)                            \
+    {                                                                                   \
+        alignas(64) T lane[lanes<T>::width];                                            \
+        lanes<T>::store_aligned(lane, v);                                               \
+        T result = lane[0];                                                             \
+        for (size_t j = 1; j < lanes<T>::width; ++j) result = combine(result, lane[j]); \
+        return result;                                                                  \
+    }                                                                                   \
+                                                                                        \
+    template <class T> inline T                                                         \
+    dvector_dot_kernel(const T *lhs, const T *rhs, size_t count)                        \
+    {                                                                                   \
+        const size_t width = lanes<T>::width;                                           \
+        typename lanes<T>::reg even = lanes<T>::set1(T(0));                             \
+        typename lanes<T>::reg odd = lanes<T>::set1(T(0));                              \
+        size_t i = 0;                                                                   \
+        for (; i + 2 * width <= count; i += 2 * width)                                  \
+        {                                                                               \
+            even = lanes<T>::fmadd(lanes<T>::load_aligned(lhs + i),                     \
+                    lanes<T>::load_aligned(rhs + i), even);                             \
+            odd = lanes<T>::fmadd(lanes<T>::load_aligned(lhs + i + width),              \
+                    lanes<T>::load_aligned(rhs + i + width), odd);                      \
+        }                                                                               \
+        for (; i + width <= count; i += width)                                          \
+        {                                                                               \
+            even = lanes<T>::fmadd(lanes<T>::load_aligned(lhs + i),                     \
+                    lanes<T>::load_aligned(rhs + i), even);                             \
+        }                                                                               \
+        T result = dvector_lane_reduce<T>(lanes<T>::add(even, odd),                     \
+                [](T a, T b) { return a + b; });                                        \
+        for (; i < count; ++i) result += lhs[i] * rhs[i];                               \
+        return result;                                                                  \
+    }                                                                                   \
+                                                                                        \
+    template <class T> inline T                                                         \
+    dvector_sum_kernel(const T *src, size_t count)                                      \
+    {                                                                                   \
+        typename lanes<T>::reg accumulator = lanes<T>::set1(T(0));                      \
+        size_t i = 0;                                                                   \
+        for (; i + lanes<T>::width <= count; i += lanes<T>::width)                      \
+            accumulator = lanes<T>::add(accumulator, lanes<T>::load_aligned(src + i));  \
+        T result = dvector_lane_reduce<T>(accumulator, [](T a, T b) { return a + b; }); \
+        for (; i < count; ++i) result += src[i];                                        \
+        return result;                                                                  \
+    }                                                                                   \
+                                                                                        \
+    template <class T> inline T                                                         \
+    dvector_min_kernel(const T *src, size_t count)                                      \
+    {                                                                                   \
+        T result = src[0];                                                              \
+        size_t i = 0;                                                                   \
+        if (count >= lanes<T>::width)                                                   \
+        {                                                                               \
+            typename lanes<T>::reg accumulator = lanes<T>::load_aligned(src);           \
+            for (i = lanes<T>::width; i + lanes<T>::width <= count; i += lanes<T>::width)\
+                accumulator = lanes<T>::min(accumulator, lanes<T>::load_aligned(src + i));\
+            result = dvector_lane_reduce<T>(accumulator, [](T a, T b) { return b < a ? b : a; });\
+        }                                                                               \
+        for (; i < count; ++i) result = src[i] < result ? src[i] : result;              \
+        return result;                                                                  \
+    }                                                                                   \
+                                                                                        \
+    template <class T> inline T                                                         \
+    dvector_max_kernel(const T *src, size_t count)                                      \
+    {                                                                                   \
+        T result = src[0];                                                              \
+        size_t i = 0;                                                                   \
+        if (count >= lanes<T>::width)                                                   \
+        {                                                                               \
+            typename lanes<T>::reg accumulator = lanes<T>::load_aligned(src);           \
+            for (i = lanes<T>::width; i + lanes<T>::width <= count; i += lanes<T>::width)\
+                accumulator = lanes<T>::max(accumulator, lanes<T>::load_aligned(src + i));\
+            result = dvector_lane_reduce<T>(accumulator, [](T a, T b) { return b > a ? b : a; });\
+        }                                                                               \
+        for (; i < count; ++i) result = src[i] > result ? src[i] : result;              \
+        return result;                                                                  \
+    }                                                                                   \
+                                                                                        \
+    template <class T> inline void                                                      \
+    dvector_axpy_kernel(T *dst, T alpha, const T *src, size_t count)                    \
+    {                                                                                   \
+        const typename lanes<T>::reg a = lanes<T>::set1(alpha);                         \
+        size_t i = 0;                                                                   \
+        for (; i + lanes<T>::width <= count; i += lanes<T>::width)                      \
+        {                                                                               \
+            typename lanes<T>::reg x = lanes<T>::load_aligned(src + i);                 \
+            typename lanes<T>::reg y = lanes<T>::load_aligned(dst + i);                 \
+            lanes<T>::store_aligned(dst + i, lanes<T>::fmadd(a, x, y));                 \
+        }                                                                               \
+        for (; i < count; ++i) dst[i] = alpha * src[i] + dst[i];                        \
+    }                                                                                   \
+                                                                                        \
+    template <class T> inline void                                                      \
+    dvector_classify_kernel(const T *src, size_t count, uint32_t faults, uint64_t *mask)\
+    {                                                                                   \
+        const uint32_t nan_enable = 0u - ((faults & FAULT_NAN) != 0);                   \
+        const uint32_t positive_enable = 0u - ((faults & FAULT_POSITIVE_INF) != 0);     \
+        const uint32_t negative_enable = 0u - ((faults & FAULT_NEGATIVE_INF) != 0);     \
+        const uint32_t subnormal_enable = 0u - ((faults & FAULT_SUBNORMAL) != 0);       \
+        const typename lanes<T>::reg zero = lanes<T>::set1(T(0));                       \
+        const typename lanes<T>::reg infinity = lanes<T>::set1(std::numeric_limits<T>::infinity());\
+        const typename lanes<T>::reg smallest = lanes<T>::set1(std::numeric_limits<T>::min());\
+        for (size_t w = 0; w < (count + 63) / 64; ++w) mask[w] = 0;                     \
+        size_t i = 0;                                                                   \
+        for (; i + lanes<T>::width <= count; i += lanes<T>::width)                      \
+        {                                                                               \
+            typename lanes<T>::reg value = lanes<T>::load_aligned(src + i);             \
+            typename lanes<T>::reg magnitude = lanes<T>::abs(value);                    \
+            uint32_t nan = lanes<T>::movemask(lanes<T>::cmp_unord(value, value));       \
+            uint32_t infinite = lanes<T>::movemask(lanes<T>::cmp_eq(magnitude, infinity));\
+            uint32_t negative = lanes<T>::movemask(lanes<T>::cmp_lt(value, zero));      \
+            uint32_t subnormal = lanes<T>::movemask(lanes<T>::cmp_lt(magnitude, smallest))\
+                    & ~lanes<T>::movemask(lanes<T>::cmp_eq(value, zero));               \
+            uint32_t bad = (nan & nan_enable) | (infinite & ~negative & positive_enable)\
+                    | (infinite & negative & negative_enable) | (subnormal & subnormal_enable);\
+            mask[i / 64] |= static_cast<uint64_t>(bad) << (i % 64);                     \
+        }                                                                               \
+        for (; i < count; ++i)                                                          \
+        {                                                                               \
+            const uint64_t bad = (dvector_fault_kinds(src[i]) & faults) != 0;           \
+            mask[i / 64] |= bad << (i % 64);                                            \
+        }                                                                               \
+    }                                                                                   \
+                                                                                        \
+    template <class T> inline dvector_kernel_table<T>                                       \
+    dvector_kernels()                                                                       \
+    {                                                                                       \
+        dvector_kernel_table<T> table;                                                      \
+        table.vector_kernels[0] = &dvector_vector_kernel<simd_op::OP_ADD, T>;               \
+        table.vector_kernels[1] = &dvector_vector_kernel<simd_op::OP_SUB, T>;               \
+        table.vector_kernels[2] = &dvector_vector_kernel<simd_op::OP_MUL, T>;               \
+        table.vector_kernels[3] = &dvector_vector_kernel<simd_op::OP_DIV, T>;               \
+        table.scalar_kernels[0] = &dvector_scalar_kernel<simd_op::OP_ADD, T>;               \
+        table.scalar_kernels[1] = &dvector_scalar_kernel<simd_op::OP_SUB, T>;               \
+        table.scalar_kernels[2] = &dvector_scalar_kernel<simd_op::OP_MUL, T>;               \
+        table.scalar_kernels[3] = &dvector_scalar_kernel<simd_op::OP_DIV, T>;               \
+        table.vector_fma        = &dvector_vector_fma<T>;                                   \
+        table.scalar_fma        = &dvector_scalar_fma<T>;                                   \
+        table.dot               = &dvector_dot_kernel<T>;                                   \
+        table.sum               = &dvector_sum_kernel<T>;                                   \
+        table.minimum           = &dvector_min_kernel<T>;                                   \
+        table.maximum           = &dvector_max_kernel<T>;                                   \
+        table.axpy              = &dvector_axpy_kernel<T>;                                  \
+        table.classify          = &dvector_classify_kernel<T>;                              \
+        return table;                                                                       \
+    }
+
+namespace simd_scalar
+{
+
+    template <simd_op OP, class T> inline void
+    dvector_vector_kernel(T *dst, const T *src, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) dst[i] = dvector_apply<OP>(dst[i], src[i]);
+    }
+
+    template <simd_op OP, class T> inline void
+    dvector_scalar_kernel(T *dst, T value, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) dst[i] = dvector_apply<OP>(dst[i], value);
+    }
+
+    template <class T> inline void
+    dvector_vector_fma(T *dst, const T *multiplier, const T *addend, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) dst[i] = dst[i] * multiplier[i] + addend[i];
+    }
+
+    template <class T> inline void
+    dvector_scalar_fma(T *dst, T multiplier, T addend, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) dst[i] = dst[i] * multiplier + addend;
+    }
+
+    template <class T> inline T
+    dvector_dot_kernel(const T *lhs, const T *rhs, size_t count)
+    {
+        T result = T(0);
+        for (size_t i = 0; i < count; ++i) result += lhs[i] * rhs[i];
+        return result;
+    }
+
+    template <class T> inline T
+    dvector_sum_kernel(const T *src, size_t count)
+    {
+        T result = T(0);
+        for (size_t i = 0; i < count; ++i) result += src[i];
+        return result;
+    }
+
+    template <class T> inline T
+    dvector_min_kernel(const T *src, size_t count)
+    {
+        T result = src[0];
+        for (size_t i = 1; i < count; ++i) result = src[i] < result ? src[i] : result;
+        return result;
+    }
+
+    template <class T> inline T
+    dvector_max_kernel(const T *src, size_t count)
+    {
+        T result = src[0];
+        for (size_t i = 1; i < count; ++i) result = src[i] > result ? src[i] : result;
+        return result;
+    }
+
+    template <class T> inline void
+    dvector_axpy_kernel(T *dst, T alpha, const T *src, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) dst[i] = alpha * src[i] + dst[i];
+    }
+
+    template <class T> inline void
+    dvector_classify_kernel(const T *src, size_t count, uint32_t faults, uint64_t *mask)
+    {
+        for (size_t w = 0; w < (count + 63) / 64; ++w) mask[w] = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint64_t bad = (dvector_fault_kinds(src[i]) & faults) != 0;
+            mask[i / 64] |= bad << (i % 64);
+        }
+    }
+
+    template <class T> inline dvector_kernel_table<T>
+    dvector_kernels()
+    {
+        dvector_kernel_table<T> table;
+        table.vector_kernels[0] = &dvector_vector_kernel<simd_op::OP_ADD, T>;
+        table.vector_kernels[1] = &dvector_vector_kernel<simd_op::OP_SUB, T>;
+        table.vector_kernels[2] = &dvector_vector_kernel<simd_op::OP_MUL, T>;
+        table.vector_kernels[3] = &dvector_vector_kernel<simd_op::OP_DIV, T>;
+        table.scalar_kernels[0] = &dvector_scalar_kernel<simd_op::OP_ADD, T>;
+        table.scalar_kernels[1] = &dvector_scalar_kernel<simd_op::OP_SUB, T>;
+        table.scalar_kernels[2] = &dvector_scalar_kernel<simd_op::OP_MUL, T>;
+        table.scalar_kernels[3] = &dvector_scalar_kernel<simd_op::OP_DIV, T>;
+        table.vector_fma        = &dvector_vector_fma<T>;
+        table.scalar_fma        = &dvector_scalar_fma<T>;
+        table.dot               = &dvector_dot_kernel<T>;
+        table.sum               = &dvector_sum_kernel<T>;
+        table.minimum           = &dvector_min_kernel<T>;
+        table.maximum           = &dvector_max_kernel<T>;
+        table.axpy              = &dvector_axpy_kernel<T>;
+        table.classify          = &dvector_classify_kernel<T>;
+        return table;
+    }
+
+}
+
+#if SF_SIMD_X86
+
+SF_TARGET_REGION(SF_TARGET_SSE2)
+namespace simd_sse2 { SF_DVECTOR_DEFINE_KERNELS }
+SF_UNTARGET_REGION
+
+SF_TARGET_REGION(SF_TARGET_AVX2)
+namespace simd_avx2 { SF_DVECTOR_DEFINE_KERNELS }
+SF_UNTARGET_REGION
+
+SF_TARGET_REGION(SF_TARGET_AVX512)
+namespace simd_avx512 { SF_DVECTOR_DEFINE_KERNELS }
+SF_UNTARGET_REGION
 
-#if 1
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
-#       include <xmmintrin.h>
-#       include <emmintrin.h>
-#       pragma message("Using SSE intrinsics.")
-#       if defined(__AVX__) && SF_USE_AVX == 1
-#           include <immintrin.h>
-#           pragma message("Using AVX intrinsics.")
-#           define SF_ENABLE_AVX 1
-#       else
-#           define SF_ENABLE_AVX 0
-#       endif
-#   endif
 #endif
 
+template <class T> inline dvector_kernel_table<T>
+dvector_kernels_for(simd_isa isa)
+{
+
+#   if SF_SIMD_X86
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+        {
+            switch (isa)
+            {
+                case simd_isa::ISA_AVX512:  return simd_avx512::dvector_kernels<T>();
+                case simd_isa::ISA_AVX2:    return simd_avx2::dvector_kernels<T>();
+                case simd_isa::ISA_SSE2:    return simd_sse2::dvector_kernels<T>();
+                default:                    break;
+            }
+        }
+#   endif
+
+    return simd_scalar::dvector_kernels<T>();
+
+}
+
+template <class T> inline const dvector_kernel_table<T>&
+dvector_active_kernels()
+{
+
+    static const dvector_kernel_table<T> table = dvector_kernels_for<T>(simd_active_isa());
+    return table;
+
+}
+
+template <simd_op OP, class T> inline void
+dvector_dispatch(T *dst, const T *src, size_t count)
+{
+
+    dvector_active_kernels<T>().vector_kernels[static_cast<size_t>(OP)](dst, src, count);
+
+}
+
+template <simd_op OP, class T> inline void
+dvector_dispatch(T *dst, T value, size_t count)
+{
+
+    dvector_active_kernels<T>().scalar_kernels[static_cast<size_t>(OP)](dst, value, count);
+
+}
+
+// --- Expression Templates ----------------------------------------------------
+//
+// The arithmetic operators don't compute anything on their own. Instead, each one
+// returns a lightweight node describing the operation, and the whole tree is only
+// evaluated once it lands in a dvector through construction, assignment, or one of
+// the compound operators. This turns something like a = b + c * d - e into a single
+// loop over L with no intermediate vectors.
+//
+// Nodes hold dvector leaves by reference and sub-expressions by value, so an
+// expression must be consumed within the statement that builds it. Storing one in
+// an auto variable will leave it referring to whatever temporaries it was built
+// from. Generated code always names its types, so this is only a concern for
+// hand-written code.
+//
+// Every node is element-wise, so evaluating index i only ever reads index i of its
+// operands. Assigning an expression into one of its own operands is safe.
+//
+
+template <class T, size_t L> class dvector;
+
+template <class E>
+class dvector_expression
+{
+
+    public:
+        inline const E& self() const { return static_cast<const E&>(*this); }
+        inline auto     operator[](const size_t index) const { return this->self().evaluate(index); }
+
+};
+
+template <class E>
+struct dvector_operand
+{
+    using type = const E;
+};
+
+template <class T, size_t L>
+struct dvector_operand<dvector<T,L>>
+{
+    using type = const dvector<T,L>&;
+};
+
+struct dvector_add { template <class T> static inline T apply(T a, T b) { return a + b; } };
+struct dvector_sub { template <class T> static inline T apply(T a, T b) { return a - b; } };
+struct dvector_mul { template <class T> static inline T apply(T a, T b) { return a * b; } };
+struct dvector_div { template <class T> static inline T apply(T a, T b) { return a / b; } };
+
+template <class LHS, class RHS, class OP>
+class dvector_binary : public dvector_expression<dvector_binary<LHS, RHS, OP>>
+{
+
+    public:
+        using value_type = typename LHS::value_type;
+        static constexpr size_t length = LHS::length;
+
+        static_assert(LHS::length == RHS::length, "dvector expression length mismatch.");
+        static_assert(std::is_same_v<typename LHS::value_type, typename RHS::value_type>,
+                "dvector expression value type mismatch.");
+
+    public:
+        inline dvector_binary(const LHS &lhs, const RHS &rhs) : lhs(lhs), rhs(rhs) { }
+        inline value_type evaluate(const size_t index) const
+        {
+            return OP::apply(this->lhs.evaluate(index), this->rhs.evaluate(index));
+        }
+
+    protected:
+        typename dvector_operand<LHS>::type lhs;
+        typename dvector_operand<RHS>::type rhs;
+
+};
+
+template <class LHS, class OP>
+class dvector_scalar_right : public dvector_expression<dvector_scalar_right<LHS, OP>>
+{
+
+    public:
+        using value_type = typename LHS::value_type;
+        static constexpr size_t length = LHS::length;
+
+    public:
+        inline dvector_scalar_right(const LHS &lhs, value_type rhs) : lhs(lhs), rhs(rhs) { }
+        inline value_type evaluate(const size_t index) const
+        {
+            return OP::apply(this->lhs.evaluate(index), this->rhs);
+        }
+
+    protected:
+        typename dvector_operand<LHS>::type lhs;
+        value_type rhs;
+
+};
+
+template <class RHS, class OP>
+class dvector_scalar_left : public dvector_expression<dvector_scalar_left<RHS, OP>>
+{
+
+    public:
+        using value_type = typename RHS::value_type;
+        static constexpr size_t length = RHS::length;
+
+    public:
+        inline dvector_scalar_left(value_type lhs, const RHS &rhs) : lhs(lhs), rhs(rhs) { }
+        inline value_type evaluate(const size_t index) const
+        {
+            return OP::apply(this->lhs, this->rhs.evaluate(index));
+        }
+
+    protected:
+        value_type lhs;
+        typename dvector_operand<RHS>::type rhs;
+
+};
+
+template <class E>
+class dvector_negate : public dvector_expression<dvector_negate<E>>
+{
+
+    public:
+        using value_type = typename E::value_type;
+        static constexpr size_t length = E::length;
+
+    public:
+        inline dvector_negate(const E &operand) : operand(operand) { }
+        inline value_type evaluate(const size_t index) const
+        {
+            return -this->operand.evaluate(index);
+        }
+
+    protected:
+        typename dvector_operand<E>::type operand;
+
+};
+
 template <class T, size_t L>
-class dvector
+class dvector : public dvector_expression<dvector<T,L>>
 {
 
+    public:
+        using value_type = T;
+        static constexpr size_t length = L;
+
     public:
         inline          dvector();
         inline          dvector(const dvector<T,L> &vec);
-        inline          dvector(const dvector<T,L> &&vec);
+        inline          dvector(dvector<T,L> &&vec) noexcept;
         inline          dvector(std::initializer_list<T> list);
-        virtual inline ~dvector();
+        template <class E>
+        inline          dvector(const dvector_expression<E> &expression);
+        inline         ~dvector();
+
+        inline dvector& operator=(const dvector<T,L> &rhs);
+        inline dvector& operator=(dvector<T,L> &&rhs) noexcept;
+        template <class E>
+        inline dvector& operator=(const dvector_expression<E> &rhs);
 
         inline T&       operator[](const size_t index);
         inline const T& operator[](const size_t index) const;
 
         inline T&       at(const size_t index);
         inline const T& at(const size_t index) const;
+        inline T        evaluate(const size_t index) const;
 
+        inline T*       data();
+        inline const T* data() const;
         inline size_t   size() const;
 
+        inline dvector_mask<L> classify(uint32_t faults = FAULT_ANY) const;
+
         inline bool     contains_nans() const;
         inline bool     contains_inf() const;
         inline bool     contains_positive_inf() const;
@@ -51,66 +745,110 @@ class dvector
         inline bool     valid_at(const size_t index) const;
         inline bool     valid_in_range(const size_t start, const size_t end) const;
 
-        inline dvector& operator+=(double rhs);
-        inline dvector& operator-=(double rhs);
-        inline dvector& operator*=(double rhs);
-        inline dvector& operator/=(double rhs);
+        inline dvector& operator+=(T rhs);
+        inline dvector& operator-=(T rhs);
+        inline dvector& operator*=(T rhs);
+        inline dvector& operator/=(T rhs);
 
         inline dvector& operator+=(const dvector<T,L> &rhs);
         inline dvector& operator-=(const dvector<T,L> &rhs);
         inline dvector& operator*=(const dvector<T,L> &rhs);
         inline dvector& operator/=(const dvector<T,L> &rhs);
 
+        template <class E> inline dvector& operator+=(const dvector_expression<E> &rhs);
+        template <class E> inline dvector& operator-=(const dvector_expression<E> &rhs);
+        template <class E> inline dvector& operator*=(const dvector_expression<E> &rhs);
+        template <class E> inline dvector& operator/=(const dvector_expression<E> &rhs);
+
         inline bool     operator==(const dvector<T,L> &rhs) const;
         inline bool     operator!=(const dvector<T,L> &rhs) const;
 
-        inline dvector& component_wise_addition(double value);
-        inline dvector& component_wise_subtraction(double value);
-        inline dvector& component_wise_multiplication(double value);
-        inline dvector& component_wise_division(double value);
+        inline dvector& component_wise_addition(T value);
+        inline dvector& component_wise_subtraction(T value);
+        inline dvector& component_wise_multiplication(T value);
+        inline dvector& component_wise_division(T value);
 
         inline dvector& component_wise_addition(const dvector<T,L> &vector);
         inline dvector& component_wise_subtraction(const dvector<T,L> &vector);
         inline dvector& component_wise_multiplication(const dvector<T,L> &vector);
         inline dvector& component_wise_division(const dvector<T,L> &vector);
 
+        inline dvector& fused_multiply_add(T multiplier, T addend);
+        inline dvector& fused_multiply_add(const dvector<T,L> &multiplier, const dvector<T,L> &addend);
+
         inline bool     component_wise_compare(const dvector& rhs) const;
 
     protected:
-        std::vector<T> components;
+        static constexpr size_t alignment       = 64;
+        static constexpr size_t lane_count      = sizeof(T) < alignment ? alignment / sizeof(T) : 1;
+        static constexpr size_t padded_length   = (L + lane_count - 1) / lane_count * lane_count;
 
     protected:
-        static constexpr size_t alignment = 4;
+#       if SF_DVECTOR_HEAP_STORAGE == 1
+            std::vector<T, pool_allocator<T>> components;
+#       else
+            alignas(alignment) std::array<T, padded_length> components;
+#       endif
 
 };
 
-template <class T, size_t L> inline std::ostream& operator<<(std::ostream& os, const dvector<T,L> &rhs);
+template <class E> inline std::ostream& operator<<(std::ostream& os, const dvector_expression<E> &rhs);
+
+template <class E> inline auto operator-(const dvector_expression<E> &rhs);
+
+template <class E> inline auto operator+(typename E::value_type lhs, const dvector_expression<E> &rhs);
+template <class E> inline auto operator-(typename E::value_type lhs, const dvector_expression<E> &rhs);
+template <class E> inline auto operator*(typename E::value_type lhs, const dvector_expression<E> &rhs);
+template <class E> inline auto operator/(typename E::value_type lhs, const dvector_expression<E> &rhs);
+
+template <class E> inline auto operator+(const dvector_expression<E> &lhs, typename E::value_type rhs);
+template <class E> inline auto operator-(const dvector_expression<E> &lhs, typename E::value_type rhs);
+template <class E> inline auto operator*(const dvector_expression<E> &lhs, typename E::value_type rhs);
+template <class E> inline auto operator/(const dvector_expression<E> &lhs, typename E::value_type rhs);
 
-template <class T, size_t L> inline dvector<T,L>    operator+(double lhs, const dvector<T,L> &rhs);
-template <class T, size_t L> inline dvector<T,L>    operator-(double lhs, const dvector<T,L> &rhs);
-template <class T, size_t L> inline dvector<T,L>    operator*(double lhs, const dvector<T,L> &rhs);
-template <class T, size_t L> inline dvector<T,L>    operator/(double lhs, const dvector<T,L> &rhs);
+template <class T, size_t L> inline dvector<T,L> operator-(dvector<T,L> &&rhs);
 
-template <class T, size_t L> inline dvector<T,L>    operator+(const dvector<T,L> &lhs, double rhs);
-template <class T, size_t L> inline dvector<T,L>    operator-(const dvector<T,L> &lhs, double rhs);
-template <class T, size_t L> inline dvector<T,L>    operator*(const dvector<T,L> &lhs, double rhs);
-template <class T, size_t L> inline dvector<T,L>    operator/(const dvector<T,L> &lhs, double rhs);
+template <class T, size_t L> inline dvector<T,L> operator+(typename dvector<T,L>::value_type lhs, dvector<T,L> &&rhs);
+template <class T, size_t L> inline dvector<T,L> operator-(typename dvector<T,L>::value_type lhs, dvector<T,L> &&rhs);
+template <class T, size_t L> inline dvector<T,L> operator*(typename dvector<T,L>::value_type lhs, dvector<T,L> &&rhs);
+template <class T, size_t L> inline dvector<T,L> operator/(typename dvector<T,L>::value_type lhs, dvector<T,L> &&rhs);
 
-template <class T, size_t L> inline dvector<T,L>    operator+(const dvector<T,L> &lhs, const dvector<T,L> &rhs);
-template <class T, size_t L> inline dvector<T,L>    operator-(const dvector<T,L> &lhs, const dvector<T,L> &rhs);
-template <class T, size_t L> inline dvector<T,L>    operator*(const dvector<T,L> &lhs, const dvector<T,L> &rhs);
-template <class T, size_t L> inline dvector<T,L>    operator/(const dvector<T,L> &lhs, const dvector<T,L> &rhs);
+template <class T, size_t L> inline dvector<T,L> operator+(dvector<T,L> &&lhs, typename dvector<T,L>::value_type rhs);
+template <class T, size_t L> inline dvector<T,L> operator-(dvector<T,L> &&lhs, typename dvector<T,L>::value_type rhs);
+template <class T, size_t L> inline dvector<T,L> operator*(dvector<T,L> &&lhs, typename dvector<T,L>::value_type rhs);
+template <class T, size_t L> inline dvector<T,L> operator/(dvector<T,L> &&lhs, typename dvector<T,L>::value_type rhs);
+
+template <class T, size_t L, class B> inline dvector<T,L> operator+(dvector<T,L> &&lhs, const dvector_expression<B> &rhs);
+template <class T, size_t L, class B> inline dvector<T,L> operator-(dvector<T,L> &&lhs, const dvector_expression<B> &rhs);
+template <class T, size_t L, class B> inline dvector<T,L> operator*(dvector<T,L> &&lhs, const dvector_expression<B> &rhs);
+template <class T, size_t L, class B> inline dvector<T,L> operator/(dvector<T,L> &&lhs, const dvector_expression<B> &rhs);
+
+template <class A, class T, size_t L> inline dvector<T,L> operator+(const dvector_expression<A> &lhs, dvector<T,L> &&rhs);
+template <class A, class T, size_t L> inline dvector<T,L> operator-(const dvector_expression<A> &lhs, dvector<T,L> &&rhs);
+template <class A, class T, size_t L> inline dvector<T,L> operator*(const dvector_expression<A> &lhs, dvector<T,L> &&rhs);
+template <class A, class T, size_t L> inline dvector<T,L> operator/(const dvector_expression<A> &lhs, dvector<T,L> &&rhs);
+
+template <class T, size_t L> inline dvector<T,L> operator+(dvector<T,L> &&lhs, dvector<T,L> &&rhs);
+template <class T, size_t L> inline dvector<T,L> operator-(dvector<T,L> &&lhs, dvector<T,L> &&rhs);
+template <class T, size_t L> inline dvector<T,L> operator*(dvector<T,L> &&lhs, dvector<T,L> &&rhs);
+template <class T, size_t L> inline dvector<T,L> operator/(dvector<T,L> &&lhs, dvector<T,L> &&rhs);
+
+template <class A, class B> inline auto operator+(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs);
+template <class A, class B> inline auto operator-(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs);
+template <class A, class B> inline auto operator*(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs);
+template <class A, class B> inline auto operator/(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs);
 
 template <class T, size_t L> inline dvector<T,L>::         
 dvector()
 {
 
-    constexpr size_t size = (L + dvector::alignment - 1) & ~std::size_t(dvector::alignment - 1);
-    this->components.resize(size);
+#   if SF_DVECTOR_HEAP_STORAGE == 1
+        this->components.resize(dvector::padded_length);
+#   endif
 
-    for (auto c : this->components) 
+    for (size_t i = 0; i < dvector::padded_length; ++i)
     {
-        c = { };
+        this->components[i] = { };
     }
 
 }
@@ -119,32 +857,61 @@ template <class T, size_t L> inline dvector<T,L>::
 dvector(std::initializer_list<T> list)
 {
 
-    constexpr size_t size = (L + dvector::alignment - 1) & ~std::size_t(dvector::alignment - 1);
-    this->components.resize(size);
-    this->components = list;
+#   if SF_DVECTOR_HEAP_STORAGE == 1
+        this->components.resize(dvector::padded_length);
+#   endif
+
+    // Anything the list doesn't cover, including the padding, is zeroed.
+    size_t index = 0;
+    for (auto it = list.begin(); it != list.end() && index < L; ++it, ++index)
+    {
+        this->components[index] = *it;
+    }
+
+    for (; index < dvector::padded_length; ++index)
+    {
+        this->components[index] = { };
+    }
 
 }
 
 template <class T, size_t L> inline dvector<T,L>::         
 dvector(const dvector<T,L> &vec)
+    : components(vec.components)
 {
 
-    constexpr size_t size = (L + dvector::alignment - 1) & ~std::size_t(dvector::alignment - 1);
-    this->components.resize(size);
+}
+
+template <class T, size_t L> template <class E> inline dvector<T,L>::
+dvector(const dvector_expression<E> &expression)
+{
+
+    static_assert(E::length == L, "dvector expression length mismatch.");
+
+#   if SF_DVECTOR_HEAP_STORAGE == 1
+        this->components.resize(dvector::padded_length);
+#   endif
+
+    const E& source = expression.self();
     for (size_t i = 0; i < L; ++i)
     {
+        this->components[i] = source.evaluate(i);
+    }
 
-        this->components[i] = vec.components[i];
-
+    for (size_t i = L; i < dvector::padded_length; ++i)
+    {
+        this->components[i] = { };
     }
 
 }
 
 template <class T, size_t L> inline dvector<T,L>::
-dvector(const dvector<T,L> &&vec)
+dvector(dvector<T,L> &&vec) noexcept
+    : components(std::move(vec.components))
 {
 
-    this->components = std::move(vec.components);
+    // In heap mode this steals the buffer, leaving the source empty. A moved-from
+    // dvector may only be destroyed or assigned to, like any moved-from container.
 
 }
 
@@ -154,6 +921,49 @@ template <class T, size_t L> inline dvector<T,L>::
 
 
 
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator=(const dvector<T,L> &rhs)
+{
+
+    this->components = rhs.components;
+    return *this;
+
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator=(dvector<T,L> &&rhs) noexcept
+{
+
+    // Swapping rather than moving hands our old buffer to the source, so it stays
+    // usable in heap mode. Inline storage just copies either way.
+    std::swap(this->components, rhs.components);
+    return *this;
+
+}
+
+template <class T, size_t L> template <class E> inline dvector<T,L>& dvector<T,L>::
+operator=(const dvector_expression<E> &rhs)
+{
+
+    static_assert(E::length == L, "dvector expression length mismatch.");
+
+#   if SF_DVECTOR_HEAP_STORAGE == 1
+        if (this->components.size() != dvector::padded_length)
+        {
+            this->components.assign(dvector::padded_length, T{ });
+        }
+#   endif
+
+    const E& source = rhs.self();
+    for (size_t i = 0; i < L; ++i)
+    {
+        this->components[i] = source.evaluate(i);
+    }
+
+    return *this;
+
 }
 
 template <class T, size_t L> inline T& dvector<T,L>::
@@ -192,12 +1002,46 @@ at(const size_t index) const
 
 }
 
+template <class T, size_t L> inline T dvector<T,L>::
+evaluate(const size_t index) const
+{
+
+    return this->components[index];
+
+}
+
+template <class T, size_t L> inline T* dvector<T,L>::
+data()
+{
+
+    return this->components.data();
+
+}
+
+template <class T, size_t L> inline const T* dvector<T,L>::
+data() const
+{
+
+    return this->components.data();
+
+}
+
 template <class T, size_t L> inline size_t dvector<T,L>::
 size() const
 {
 
-    const size_t result = this->components.size();
-    return result;
+    // The backing buffer may be padded, so its size isn't the vector's length.
+    return L;
+
+}
+
+template <class T, size_t L> inline dvector_mask<L> dvector<T,L>::
+classify(uint32_t faults) const
+{
+
+    dvector_mask<L> mask;
+    dvector_active_kernels<T>().classify(this->components.data(), L, faults, mask.words);
+    return mask;
 
 }
 
@@ -205,17 +1049,7 @@ template <class T, size_t L> inline bool dvector<T,L>::
 contains_nans() const
 {
 
-    bool contains_nan = false;
-    for (size_t i = 0; i < L; ++i)
-    {
-        if (std::isnan(this->components[i]))
-        {
-            contains_nan = true;
-            break;
-        }
-    }
-
-    return contains_nan;
+    return this->classify(FAULT_NAN).any();
 
 }
 
@@ -223,17 +1057,7 @@ template <class T, size_t L> inline bool dvector<T,L>::
 contains_inf() const
 {
 
-    bool contains_inf = false;
-    for (size_t i = 0; i < L; ++i)
-    {
-        if (std::isinf(this->components[i]))
-        {
-            contains_inf = true;
-            break;
-        }
-    }
-
-    return contains_inf;
+    return this->classify(FAULT_INF).any();
 
 }
 
@@ -241,885 +1065,763 @@ template <class T, size_t L> inline bool dvector<T,L>::
 contains_positive_inf() const
 {
 
-    bool contains_pos_inf = false;
-    for (size_t i = 0; i < L; ++i)
-    {
+    return this->classify(FAULT_POSITIVE_INF).any();
 
-        const auto c = this->components[i];
-        if (std::isinf(c) && c >= 0)
-        {
-            contains_pos_inf = true;
-            break;
-        }
-    }
+}
 
-    return contains_pos_inf;
+template <class T, size_t L> inline bool dvector<T,L>::
+contains_negative_inf() const
+{
+
+    return this->classify(FAULT_NEGATIVE_INF).any();
 
 }
 
 template <class T, size_t L> inline bool dvector<T,L>::
-contains_negative_inf() const
+contains_valid_components() const
 {
 
-    bool contains_neg_inf = false;
-    for (size_t i = 0; i < L; ++i)
-    {
+    return !this->classify(FAULT_ANY).any();
 
-        const auto c = this->components[i];
-        if (std::isinf(c) && c < 0)
-        {
-            contains_neg_inf = true;
-            break;
-        }
+}
+
+template <class T, size_t L> inline bool dvector<T,L>::
+valid_at(const size_t index) const
+{
+
+    return dvector_fault_kinds(this->components[index]) == 0;
+
+}
+
+template <class T, size_t L> inline bool dvector<T,L>::
+valid_in_range(const size_t start, const size_t end) const
+{
+
+    const dvector_mask<L> mask = this->classify(FAULT_ANY);
+
+    bool values_are_valid = true;
+    for (size_t i = start; i < std::min(end, L); ++i)
+    {
+        if (mask.test(i)) values_are_valid = false;
     }
 
-    return contains_neg_inf;
+    return values_are_valid;
 
 }
 
 template <class T, size_t L> inline bool dvector<T,L>::
-contains_valid_components() const
+operator==(const dvector<T,L> &rhs) const
 {
 
-    bool contains_nans  = this->contains_nans();
-    bool contains_inf   = this->contains_inf();
+    auto result = this->component_wise_compare(rhs);
+    return result;
 
-    if (contains_nans || contains_inf) return false;
+}
 
-    bool all_normal = true;
-    for (size_t i = 0; i < L; ++i)
-    {
+template <class T, size_t L> inline bool dvector<T,L>::
+operator!=(const dvector<T,L> &rhs) const
+{
 
-        const auto c = this->components[i];
+    auto result = !(this->component_wise_compare(rhs));
+    return result;
 
-        // Perhaps subnormal?
-        if (show_classification(c) != FP_NORMAL)
-        {
-            all_normal = false;
-            break;
-        }
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator+=(T rhs)
+{
+
+    return this->component_wise_addition(rhs);
+
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator-=(T rhs)
+{
+
+    return this->component_wise_subtraction(rhs);
+
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator*=(T rhs)
+{
+
+    return this->component_wise_multiplication(rhs);
+
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator/=(T rhs)
+{
+
+    return this->component_wise_division(rhs);
+
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator+=(const dvector<T,L> &rhs)
+{
+
+    return this->component_wise_addition(rhs);
+
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator-=(const dvector<T,L> &rhs)
+{
+
+    return this->component_wise_subtraction(rhs);
+
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator*=(const dvector<T,L> &rhs)
+{
+
+    return this->component_wise_multiplication(rhs);
+
+}
+
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+operator/=(const dvector<T,L> &rhs)
+{
+
+    return this->component_wise_division(rhs);
+
+}
+
+template <class T, size_t L> template <class E> inline dvector<T,L>& dvector<T,L>::
+operator+=(const dvector_expression<E> &rhs)
+{
 
+    static_assert(E::length == L, "dvector expression length mismatch.");
+
+    const E& source = rhs.self();
+    for (size_t i = 0; i < L; ++i)
+    {
+        this->components[i] += source.evaluate(i);
     }
 
-    return all_normal;
+    return *this;
 
 }
 
-template <class T, size_t L> inline bool dvector<T,L>::
-valid_at(const size_t index) const
+template <class T, size_t L> template <class E> inline dvector<T,L>& dvector<T,L>::
+operator-=(const dvector_expression<E> &rhs)
 {
 
-    bool value_is_normal = true;
-    if (show_classification(this->components[index]) != FP_NORMAL)
-    {
-
-        // Perhaps subnormal?
-        value_is_normal = false;
+    static_assert(E::length == L, "dvector expression length mismatch.");
 
+    const E& source = rhs.self();
+    for (size_t i = 0; i < L; ++i)
+    {
+        this->components[i] -= source.evaluate(i);
     }
 
-    return value_is_normal;
+    return *this;
 
 }
 
-template <class T, size_t L> inline bool dvector<T,L>::
-valid_in_range(const size_t start, const size_t end) const
+template <class T, size_t L> template <class E> inline dvector<T,L>& dvector<T,L>::
+operator*=(const dvector_expression<E> &rhs)
 {
 
-    bool values_are_normal = true;
-    for (size_t i = start; i < std::min(end, L); ++i)
+    static_assert(E::length == L, "dvector expression length mismatch.");
+
+    const E& source = rhs.self();
+    for (size_t i = 0; i < L; ++i)
     {
+        this->components[i] *= source.evaluate(i);
+    }
 
-        if (show_classification(this->components[i]) != FP_NORMAL)
-        {
+    return *this;
 
-            // Perhaps subnormal?
-            values_are_normal= false;
-            break;
+}
 
-        }
+template <class T, size_t L> template <class E> inline dvector<T,L>& dvector<T,L>::
+operator/=(const dvector_expression<E> &rhs)
+{
 
+    static_assert(E::length == L, "dvector expression length mismatch.");
 
+    const E& source = rhs.self();
+    for (size_t i = 0; i < L; ++i)
+    {
+        this->components[i] /= source.evaluate(i);
     }
 
-    return values_are_normal;
+    return *this;
 
 }
 
-template <class T, size_t L> inline bool dvector<T,L>::
-operator==(const dvector<T,L> &rhs) const
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+component_wise_addition(T value)
 {
 
-    auto result = this->component_wise_compare(rhs);
-    return result;
+    dvector_dispatch<simd_op::OP_ADD>(this->components.data(), value, L);
+
+    return *this;
 
 }
 
-template <class T, size_t L> inline bool dvector<T,L>::
-operator!=(const dvector<T,L> &rhs) const
+template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
+component_wise_subtraction(T value)
 {
 
-    auto result = !(this->component_wise_compare(rhs));
-    return result;
+    dvector_dispatch<simd_op::OP_SUB>(this->components.data(), value, L);
+
+    return *this;
 
 }
 
 template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-operator+=(double rhs)
+component_wise_multiplication(T value)
 {
 
-    return this->component_wise_addition(rhs);
+    dvector_dispatch<simd_op::OP_MUL>(this->components.data(), value, L);
+
+    return *this;
 
 }
 
 template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-operator-=(double rhs)
+component_wise_division(T value)
 {
 
-    return this->component_wise_subtraction(rhs);
+    dvector_dispatch<simd_op::OP_DIV>(this->components.data(), value, L);
+
+    return *this;
 
 }
 
+
 template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-operator*=(double rhs)
+component_wise_addition(const dvector<T,L> &vector)
 {
 
-    return this->component_wise_multiplication(rhs);
+    dvector_dispatch<simd_op::OP_ADD>(this->components.data(), vector.components.data(), L);
+
+    return *this;
 
 }
 
 template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-operator/=(double rhs)
+component_wise_subtraction(const dvector<T,L> &vector)
 {
 
-    return this->component_wise_division(rhs);
+    dvector_dispatch<simd_op::OP_SUB>(this->components.data(), vector.components.data(), L);
+
+    return *this;
 
 }
 
 template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-operator+=(const dvector<T,L> &rhs)
+component_wise_multiplication(const dvector<T,L> &vector)
 {
 
-    return this->component_wise_addition(rhs);
+    dvector_dispatch<simd_op::OP_MUL>(this->components.data(), vector.components.data(), L);
+
+    return *this;
 
 }
 
 template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-operator-=(const dvector<T,L> &rhs)
+component_wise_division(const dvector<T,L> &vector)
 {
 
-    return this->component_wise_subtraction(rhs);
+    dvector_dispatch<simd_op::OP_DIV>(this->components.data(), vector.components.data(), L);
+
+    return *this;
 
 }
 
 template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-operator*=(const dvector<T,L> &rhs)
+fused_multiply_add(T multiplier, T addend)
 {
 
-    return this->component_wise_multiplication(rhs);
+    dvector_active_kernels<T>().scalar_fma(this->components.data(), multiplier, addend, L);
+    return *this;
 
 }
 
 template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-operator/=(const dvector<T,L> &rhs)
+fused_multiply_add(const dvector<T,L> &multiplier, const dvector<T,L> &addend)
 {
 
-    return this->component_wise_division(rhs);
+    dvector_active_kernels<T>().vector_fma(this->components.data(),
+            multiplier.components.data(), addend.components.data(), L);
+    return *this;
 
 }
 
-template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-component_wise_addition(double value)
+template <class T, size_t L> inline bool dvector<T,L>::
+component_wise_compare(const dvector<T,L> &vector) const
 {
 
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
+    bool components_equal = true;
+    for (size_t i = 0; i < L; ++i)
+    {
 
-        if constexpr (std::is_same_v<T, float>)
+        if (this->components[i] != vector.components[i])
         {
 
-#           if SF_ENABLE_AVX
-                __m256 v = _mm256_set1_ps(static_cast<float>(value));
-                for (size_t i = 0; i < L; i += 8)
-                {
-                    __m256 c = _mm256_load_ps(&components[i]);
-                    c = _mm256_add_ps(c, v);
-                    _mm256_store_ps(&components[i], c);
-                }
-#           else
-                __m128 v = _mm_set1_ps(static_cast<float>(value));
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m128 c = _mm_load_ps(&components[i]);
-                    c = _mm_add_ps(c, v);
-                    _mm_store_ps(&components[i], c);
-                }
-#           endif
-
-        }
-
-        else if constexpr (std::is_same_v<T, double>)
-        {
+            components_equal = false;
+            break;
 
-#           if SF_ENABLE_AVX
-                __m256d v = _mm256_set1_pd(value);
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m256d c = _mm256_load_pd(&components[i]);
-                    c = _mm256_add_pd(c, v);
-                    _mm256_store_pd(&components[i], c);
-                }
-#           else
-                __m128d v = _mm_set1_pd(value);
-                for (size_t i = 0; i < L; i += 2)
-                {
-                    __m128d c = _mm_load_pd(&components[i]);
-                    c = _mm_add_pd(c, v);
-                    _mm_store_pd(&components[i], c);
-                }
-#           endif
         }
 
-#   else
+    }
 
-        for (size_t i = 0; i < L; ++i)
-        {
+    return components_equal;
 
-            this->components[i] += value;
+}
 
-        }
+template <class E> inline std::ostream& 
+operator<<(std::ostream& os, const dvector_expression<E> &rhs)
+{
 
-#   endif
+    const E& source = rhs.self();
 
+    os << "[";
+    for (size_t i = 0; i < E::length; ++i)
+    {
+        os << source.evaluate(i);
+        if (i < E::length - 1) os << ", ";
+    }
+    os << "]";
 
-    return *this;
+    return os;
 
 }
 
-template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-component_wise_subtraction(double value)
+template <class E> inline auto
+operator-(const dvector_expression<E> &rhs)
 {
 
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
-
-        if constexpr (std::is_same_v<T, float>)
-        {
-
-#           if SF_ENABLE_AVX
-                __m256 v = _mm256_set1_ps(static_cast<float>(value));
-                for (size_t i = 0; i < L; i += 8)
-                {
-                    __m256 c = _mm256_load_ps(&components[i]);
-                    c = _mm256_sub_ps(c, v);
-                    _mm256_store_ps(&components[i], c);
-                }
-#           else
-                __m128 v = _mm_set1_ps(static_cast<float>(value));
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m128 c = _mm_load_ps(&components[i]);
-                    c = _mm_sub_ps(c, v);
-                    _mm_store_ps(&components[i], c);
-                }
-#           endif
-
-        }
+    return dvector_negate<E>(rhs.self());
 
-        else if constexpr (std::is_same_v<T, double>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                __m256d v = _mm256_set1_pd(value);
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m256d c = _mm256_load_pd(&components[i]);
-                    c = _mm256_sub_pd(c, v);
-                    _mm256_store_pd(&components[i], c);
-                }
-#           else
-                __m128d v = _mm_set1_pd(value);
-                for (size_t i = 0; i < L; i += 2)
-                {
-                    __m128d c = _mm_load_pd(&components[i]);
-                    c = _mm_sub_pd(c, v);
-                    _mm_store_pd(&components[i], c);
-                }
-#           endif
+template <class E> inline auto
+operator+(typename E::value_type lhs, const dvector_expression<E> &rhs)
+{
 
-        }
+    return dvector_scalar_left<E, dvector_add>(lhs, rhs.self());
 
-#   else
+}
 
-        for (size_t i = 0; i < L; ++i)
-        {
+template <class E> inline auto
+operator-(typename E::value_type lhs, const dvector_expression<E> &rhs)
+{
 
-            this->components[i] -= value;
+    return dvector_scalar_left<E, dvector_sub>(lhs, rhs.self());
 
-        }
+}
 
-#   endif
+template <class E> inline auto
+operator*(typename E::value_type lhs, const dvector_expression<E> &rhs)
+{
 
-    return *this;
+    return dvector_scalar_left<E, dvector_mul>(lhs, rhs.self());
 
 }
 
-template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-component_wise_multiplication(double value)
+template <class E> inline auto
+operator/(typename E::value_type lhs, const dvector_expression<E> &rhs)
 {
-    
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
 
-        if constexpr (std::is_same_v<T, float>)
-        {
-
-#           if SF_ENABLE_AVX
-                __m256 v = _mm256_set1_ps(static_cast<float>(value));
-                for (size_t i = 0; i < L; i += 8)
-                {
-                    __m256 c = _mm256_load_ps(&components[i]);
-                    c = _mm256_mul_ps(c, v);
-                    _mm256_store_ps(&components[i], c);
-                }
-#           else
-                __m128 v = _mm_set1_ps(static_cast<float>(value));
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m128 c = _mm_load_ps(&components[i]);
-                    c = _mm_mul_ps(c, v);
-                    _mm_store_ps(&components[i], c);
-                }
-#           endif
-
-        }
+    return dvector_scalar_left<E, dvector_div>(lhs, rhs.self());
 
-        else if constexpr (std::is_same_v<T, double>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                __m256d v = _mm256_set1_pd(value);
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m256d c = _mm256_load_pd(&components[i]);
-                    c = _mm256_mul_pd(c, v);
-                    _mm256_store_pd(&components[i], c);
-                }
-#           else
-                __m128d v = _mm_set1_pd(value);
-                for (size_t i = 0; i < L; i += 2)
-                {
-                    __m128d c = _mm_load_pd(&components[i]);
-                    c = _mm_mul_pd(c, v);
-                    _mm_store_pd(&components[i], c);
-                }
-#           endif
+template <class E> inline auto
+operator+(const dvector_expression<E> &lhs, typename E::value_type rhs)
+{
 
-        }
+    return dvector_scalar_right<E, dvector_add>(lhs.self(), rhs);
 
-#   else
+}
 
-        for (size_t i = 0; i < L; ++i)
-        {
+template <class E> inline auto
+operator-(const dvector_expression<E> &lhs, typename E::value_type rhs)
+{
 
-            this->components[i] *= value;
+    return dvector_scalar_right<E, dvector_sub>(lhs.self(), rhs);
 
-        }
+}
 
-#   endif
+template <class E> inline auto
+operator*(const dvector_expression<E> &lhs, typename E::value_type rhs)
+{
 
-    return *this;
+    return dvector_scalar_right<E, dvector_mul>(lhs.self(), rhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-component_wise_division(double value)
+template <class E> inline auto
+operator/(const dvector_expression<E> &lhs, typename E::value_type rhs)
 {
 
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
+    return dvector_scalar_right<E, dvector_div>(lhs.self(), rhs);
 
-        if constexpr (std::is_same_v<T, float>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                __m256 v = _mm256_set1_ps(static_cast<float>(value));
-                for (size_t i = 0; i < L; i += 8)
-                {
-                    __m256 c = _mm256_load_ps(&components[i]);
-                    c = _mm256_div_ps(c, v);
-                    _mm256_store_ps(&components[i], c);
-                }
-#           else
-                __m128 v = _mm_set1_ps(static_cast<float>(value));
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m128 c = _mm_load_ps(&components[i]);
-                    c = _mm_div_ps(c, v);
-                    _mm_store_ps(&components[i], c);
-                }
-#           endif
+template <class A, class B> inline auto
+operator+(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs)
+{
 
-        }
+    return dvector_binary<A, B, dvector_add>(lhs.self(), rhs.self());
 
-        else if constexpr (std::is_same_v<T, double>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                __m256d v = _mm256_set1_pd(value);
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m256d c = _mm256_load_pd(&components[i]);
-                    c = _mm256_div_pd(c, v);
-                    _mm256_store_pd(&components[i], c);
-                }
-#           else
-                __m128d v = _mm_set1_pd(value);
-                for (size_t i = 0; i < L; i += 2)
-                {
-                    __m128d c = _mm_load_pd(&components[i]);
-                    c = _mm_div_pd(c, v);
-                    _mm_store_pd(&components[i], c);
-                }
-#           endif
+template <class A, class B> inline auto
+operator-(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs)
+{
 
-        }
+    return dvector_binary<A, B, dvector_sub>(lhs.self(), rhs.self());
 
-#   else
+}
 
-        for (size_t i = 0; i < L; ++i)
-        {
+template <class A, class B> inline auto
+operator*(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs)
+{
 
-            this->components[i] /= value;
+    return dvector_binary<A, B, dvector_mul>(lhs.self(), rhs.self());
 
-        }
+}
 
-#   endif
+template <class A, class B> inline auto
+operator/(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs)
+{
 
-    return *this;
+    return dvector_binary<A, B, dvector_div>(lhs.self(), rhs.self());
 
 }
 
+// --- Evaluation --------------------------------------------------------------
+//
+// Generated code holds reused subexpressions in auto temporaries, which would keep
+// the expression node rather than its value. cosy_evaluate turns an expression into
+// the dvector it describes and passes any other value through unchanged.
+//
 
-template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-component_wise_addition(const dvector<T,L> &vector)
+template <class T, std::enable_if_t<!std::is_base_of_v<dvector_expression<T>, T>, int> = 0>
+inline T
+cosy_evaluate(const T &value)
 {
 
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
-
-        if constexpr (std::is_same_v<T, float>)
-        {
-
-#           if SF_ENABLE_AVX
-                for (size_t i = 0; i < L; i += 8)
-                {
-                    __m256 a = _mm256_load_ps(&this->components[i]);
-                    __m256 b = _mm256_load_ps(&vector.components[i]);
-                    a = _mm256_add_ps(a, b);
-                    _mm256_store_ps(&this->components[i], a);
-                }
-#           else
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m128 a = _mm_load_ps(&this->components[i]);
-                    __m128 b = _mm_load_ps(&vector.components[i]);
-                    a = _mm_add_ps(a, b);
-                    _mm_store_ps(&this->components[i], a);
-                }
-#           endif
+    return value;
 
-        }
+}
 
-        else if constexpr (std::is_same_v<T, double>)
-        {
+template <class E> inline dvector<typename E::value_type, E::length>
+cosy_evaluate(const dvector_expression<E> &expression)
+{
 
-#           if SF_ENABLE_AVX
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m256d a = _mm256_load_pd(&this->components[i]);
-                    __m256d b = _mm256_load_pd(&vector.components[i]);
-                    a = _mm256_add_pd(a, b);
-                    _mm256_store_pd(&this->components[i], a);
-                }
-#           else
-                for (size_t i = 0; i < L; i += 2)
-                {
-                    __m128d a = _mm_load_pd(&this->components[i]);
-                    __m128d b = _mm_load_pd(&vector.components[i]);
-                    a = _mm_add_pd(a, b);
-                    _mm_store_pd(&this->components[i], a);
-                }
-#           endif
+    return dvector<typename E::value_type, E::length>(expression);
 
-        }
+}
 
-#   else
+// --- Reductions --------------------------------------------------------------
+//
+// The reductions and BLAS-1 routines that the COSY intrinsics DOT, NORM, VSUM, VMIN,
+// VMAX, and AXPY lower to. They run through the same kernel table as the component
+// wise operators. An expression passed in is evaluated into a dvector first, since
+// the kernels need contiguous aligned storage to load from.
+//
 
-        for (size_t index = 0; index < L; ++index)
-        {
+template <class T, size_t L> inline T
+dvector_dot(const dvector<T,L> &lhs, const dvector<T,L> &rhs)
+{
 
-            this->components[index] += vector.components[index];
+    return dvector_active_kernels<T>().dot(lhs.data(), rhs.data(), L);
 
-        }
+}
 
-#   endif
+template <class A, class B> inline auto
+dvector_dot(const dvector_expression<A> &lhs, const dvector_expression<B> &rhs)
+{
 
-    return *this;
+    static_assert(A::length == B::length, "Dot product of vectors with different lengths.");
+    using T = typename A::value_type;
+    return dvector_dot(dvector<T, A::length>(lhs), dvector<T, B::length>(rhs));
 
 }
 
-template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-component_wise_subtraction(const dvector<T,L> &vector)
+template <class E> inline auto
+dvector_norm(const dvector_expression<E> &vector)
 {
 
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
+    return std::sqrt(dvector_dot(vector, vector));
 
-        if constexpr (std::is_same_v<T, float>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                for (size_t i = 0; i < L; i += 8)
-                {
-                    __m256 a = _mm256_load_ps(&this->components[i]);
-                    __m256 b = _mm256_load_ps(&vector.components[i]);
-                    a = _mm256_sub_ps(a, b);
-                    _mm256_store_ps(&this->components[i], a);
-                }
-#           else
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m128 a = _mm_load_ps(&this->components[i]);
-                    __m128 b = _mm_load_ps(&vector.components[i]);
-                    a = _mm_sub_ps(a, b);
-                    _mm_store_ps(&this->components[i], a);
-                }
-#           endif
+template <class T, size_t L> inline T
+dvector_sum(const dvector<T,L> &vector)
+{
 
-        }
+    return dvector_active_kernels<T>().sum(vector.data(), L);
 
-        else if constexpr (std::is_same_v<T, double>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m256d a = _mm256_load_pd(&this->components[i]);
-                    __m256d b = _mm256_load_pd(&vector.components[i]);
-                    a = _mm256_sub_pd(a, b);
-                    _mm256_store_pd(&this->components[i], a);
-                }
-#           else
-                for (size_t i = 0; i < L; i += 2)
-                {
-                    __m128d a = _mm_load_pd(&this->components[i]);
-                    __m128d b = _mm_load_pd(&vector.components[i]);
-                    a = _mm_sub_pd(a, b);
-                    _mm_store_pd(&this->components[i], a);
-                }
-#           endif
+template <class E> inline auto
+dvector_sum(const dvector_expression<E> &vector)
+{
 
-        }
+    return dvector_sum(dvector<typename E::value_type, E::length>(vector));
 
-#   else
+}
 
-        for (size_t index = 0; index < L; ++index)
-        {
+template <class T, size_t L> inline T
+dvector_min(const dvector<T,L> &vector)
+{
 
-            this->components[index] -= vector.components[index];
+    return dvector_active_kernels<T>().minimum(vector.data(), L);
 
-        }
+}
 
-#   endif
+template <class E> inline auto
+dvector_min(const dvector_expression<E> &vector)
+{
 
-    return *this;
+    return dvector_min(dvector<typename E::value_type, E::length>(vector));
 
 }
 
-template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-component_wise_multiplication(const dvector<T,L> &vector)
+template <class T, size_t L> inline T
+dvector_max(const dvector<T,L> &vector)
 {
 
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
+    return dvector_active_kernels<T>().maximum(vector.data(), L);
 
-        if constexpr (std::is_same_v<T, float>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                for (size_t i = 0; i < L; i += 8)
-                {
-                    __m256 a = _mm256_load_ps(&this->components[i]);
-                    __m256 b = _mm256_load_ps(&vector.components[i]);
-                    a = _mm256_mul_ps(a, b);
-                    _mm256_store_ps(&this->components[i], a);
-                }
-#           else
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m128 a = _mm_load_ps(&this->components[i]);
-                    __m128 b = _mm_load_ps(&vector.components[i]);
-                    a = _mm_mul_ps(a, b);
-                    _mm_store_ps(&this->components[i], a);
-                }
-#           endif
+template <class E> inline auto
+dvector_max(const dvector_expression<E> &vector)
+{
 
-        }
+    return dvector_max(dvector<typename E::value_type, E::length>(vector));
 
-        else if constexpr (std::is_same_v<T, double>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m256d a = _mm256_load_pd(&this->components[i]);
-                    __m256d b = _mm256_load_pd(&vector.components[i]);
-                    a = _mm256_mul_pd(a, b);
-                    _mm256_store_pd(&this->components[i], a);
-                }
-#           else
-                for (size_t i = 0; i < L; i += 2)
-                {
-                    __m128d a = _mm_load_pd(&this->components[i]);
-                    __m128d b = _mm_load_pd(&vector.components[i]);
-                    a = _mm_mul_pd(a, b);
-                    _mm_store_pd(&this->components[i], a);
-                }
-#           endif
+template <class T, size_t L> inline dvector<T,L>
+dvector_axpy(typename dvector<T,L>::value_type alpha, const dvector<T,L> &x, dvector<T,L> y)
+{
 
-        }
+    // Returns alpha * x + y, the sum lands in the copy of y taken by value.
+    dvector_active_kernels<T>().axpy(y.data(), alpha, x.data(), L);
+    return y;
 
-#   else
+}
 
-        for (size_t index = 0; index < L; ++index)
-        {
+template <class A, class B> inline auto
+dvector_axpy(typename A::value_type alpha, const dvector_expression<A> &x,
+        const dvector_expression<B> &y)
+{
 
-            this->components[index] *= vector.components[index];
+    static_assert(A::length == B::length, "AXPY of vectors with different lengths.");
+    using T = typename A::value_type;
+    return dvector_axpy(alpha, dvector<T, A::length>(x), dvector<T, B::length>(y));
 
-        }
+}
 
-#   endif
+// --- Rvalue Operators --------------------------------------------------------
+//
+// When an operand is a dvector that is about to die anyway, like the result of a
+// function call, the operators below compute into its buffer and pass it along
+// instead of building an expression that would need fresh storage once evaluated.
+// Chains such as f(x) * 0.5 + y keep recycling the same buffer. Since everything
+// is element-wise, writing into the rvalue while reading the other operand is fine
+// even when that operand refers back to it.
+//
+
+template <class T, size_t L> inline dvector<T,L>
+operator-(dvector<T,L> &&rhs)
+{
 
-    return *this;
+    rhs *= T(-1);
+    return std::move(rhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>& dvector<T,L>::
-component_wise_division(const dvector<T,L> &vector)
+template <class T, size_t L> inline dvector<T,L>
+operator+(typename dvector<T,L>::value_type lhs, dvector<T,L> &&rhs)
 {
 
-#   if defined(SF_USE_INTRINSICS) && SF_USE_INTRINSICS == 1
+    rhs += lhs;
+    return std::move(rhs);
 
-        if constexpr (std::is_same_v<T, float>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                for (size_t i = 0; i < L; i += 8)
-                {
-                    __m256 a = _mm256_load_ps(&this->components[i]);
-                    __m256 b = _mm256_load_ps(&vector.components[i]);
-                    a = _mm256_div_ps(a, b);
-                    _mm256_store_ps(&this->components[i], a);
-                }
-#           else
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m128 a = _mm_load_ps(&this->components[i]);
-                    __m128 b = _mm_load_ps(&vector.components[i]);
-                    a = _mm_div_ps(a, b);
-                    _mm_store_ps(&this->components[i], a);
-                }
-#           endif
+template <class T, size_t L> inline dvector<T,L>
+operator-(typename dvector<T,L>::value_type lhs, dvector<T,L> &&rhs)
+{
 
-        }
+    rhs = lhs - rhs;
+    return std::move(rhs);
 
-        else if constexpr (std::is_same_v<T, double>)
-        {
+}
 
-#           if SF_ENABLE_AVX
-                for (size_t i = 0; i < L; i += 4)
-                {
-                    __m256d a = _mm256_load_pd(&this->components[i]);
-                    __m256d b = _mm256_load_pd(&vector.components[i]);
-                    a = _mm256_div_pd(a, b);
-                    _mm256_store_pd(&this->components[i], a);
-                }
-#           else
-                for (size_t i = 0; i < L; i += 2)
-                {
-                    __m128d a = _mm_load_pd(&this->components[i]);
-                    __m128d b = _mm_load_pd(&vector.components[i]);
-                    a = _mm_div_pd(a, b);
-                    _mm_store_pd(&this->components[i], a);
-                }
-#           endif
+template <class T, size_t L> inline dvector<T,L>
+operator*(typename dvector<T,L>::value_type lhs, dvector<T,L> &&rhs)
+{
 
-        }
+    rhs *= lhs;
+    return std::move(rhs);
 
-#   else
+}
 
-        for (size_t index = 0; index < L; ++index)
-        {
+template <class T, size_t L> inline dvector<T,L>
+operator/(typename dvector<T,L>::value_type lhs, dvector<T,L> &&rhs)
+{
 
-            this->components[index] /= vector.components[index];
+    rhs = lhs / rhs;
+    return std::move(rhs);
 
-        }
+}
 
-#   endif
+template <class T, size_t L> inline dvector<T,L>
+operator+(dvector<T,L> &&lhs, typename dvector<T,L>::value_type rhs)
+{
 
-    return *this;
+    lhs += rhs;
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline bool dvector<T,L>::
-component_wise_compare(const dvector<T,L> &vector) const
+template <class T, size_t L> inline dvector<T,L>
+operator-(dvector<T,L> &&lhs, typename dvector<T,L>::value_type rhs)
 {
 
-    bool components_equal = true;
-    for (size_t i = 0; i < L; ++i)
-    {
-
-        if (this->components[i] != vector.components[i])
-        {
-
-            components_equal = false;
-            break;
+    lhs -= rhs;
+    return std::move(lhs);
 
-        }
+}
 
-    }
+template <class T, size_t L> inline dvector<T,L>
+operator*(dvector<T,L> &&lhs, typename dvector<T,L>::value_type rhs)
+{
 
-    return components_equal;
+    lhs *= rhs;
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline std::ostream& 
-operator<<(std::ostream& os, const dvector<T,L> &rhs)
+template <class T, size_t L> inline dvector<T,L>
+operator/(dvector<T,L> &&lhs, typename dvector<T,L>::value_type rhs)
 {
 
-    os << "[";
-    for (size_t i = 0; i < L; ++i)
-    {
-        os << rhs[i];
-        if (i < L - 1) os << ", ";
-    }
-    os << "]";
-
-    return os;
+    lhs /= rhs;
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator+(double lhs, const dvector<T,L> &rhs)
+template <class T, size_t L, class B> inline dvector<T,L>
+operator+(dvector<T,L> &&lhs, const dvector_expression<B> &rhs)
 {
 
-    dvector<T,L> result = rhs;
-    result += lhs;
-    return result;
+    lhs += rhs.self();
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator-(double lhs, const dvector<T,L> &rhs)
+template <class T, size_t L, class B> inline dvector<T,L>
+operator-(dvector<T,L> &&lhs, const dvector_expression<B> &rhs)
 {
 
-    dvector<T,L> result = rhs;
-    result -= lhs;
-    return result;
+    lhs -= rhs.self();
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator*(double lhs, const dvector<T,L> &rhs)
+template <class T, size_t L, class B> inline dvector<T,L>
+operator*(dvector<T,L> &&lhs, const dvector_expression<B> &rhs)
 {
 
-    dvector<T,L> result = rhs;
-    result *= lhs;
-    return result;
+    lhs *= rhs.self();
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator/(double lhs, const dvector<T,L> &rhs)
+template <class T, size_t L, class B> inline dvector<T,L>
+operator/(dvector<T,L> &&lhs, const dvector_expression<B> &rhs)
 {
 
-    dvector<T,L> result = rhs;
-    result /= lhs;
-    return result;
+    lhs /= rhs.self();
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator+(const dvector<T,L> &lhs, double rhs)
+template <class A, class T, size_t L> inline dvector<T,L>
+operator+(const dvector_expression<A> &lhs, dvector<T,L> &&rhs)
 {
 
-    dvector<T,L> result = lhs;
-    result += rhs;
-    return result;
+    rhs += lhs.self();
+    return std::move(rhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator-(const dvector<T,L> &lhs, double rhs)
+template <class A, class T, size_t L> inline dvector<T,L>
+operator-(const dvector_expression<A> &lhs, dvector<T,L> &&rhs)
 {
 
-    dvector<T,L> result = lhs;
-    result -= rhs;
-    return result;
+    rhs = lhs.self() - rhs;
+    return std::move(rhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator*(const dvector<T,L> &lhs, double rhs)
+template <class A, class T, size_t L> inline dvector<T,L>
+operator*(const dvector_expression<A> &lhs, dvector<T,L> &&rhs)
 {
 
-    dvector<T,L> result = lhs;
-    result *= rhs;
-    return result;
+    rhs *= lhs.self();
+    return std::move(rhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator/(const dvector<T,L> &lhs, double rhs)
+template <class A, class T, size_t L> inline dvector<T,L>
+operator/(const dvector_expression<A> &lhs, dvector<T,L> &&rhs)
 {
 
-    dvector<T,L> result = lhs;
-    result /= rhs;
-    return result;
+    rhs = lhs.self() / rhs;
+    return std::move(rhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator+(const dvector<T,L> &lhs, const dvector<T,L> &rhs)
+template <class T, size_t L> inline dvector<T,L>
+operator+(dvector<T,L> &&lhs, dvector<T,L> &&rhs)
 {
 
-    dvector<T,L> result = lhs;
-    result += rhs;
-    return result;
+    lhs += rhs;
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator-(const dvector<T,L> &lhs, const dvector<T,L> &rhs)
+template <class T, size_t L> inline dvector<T,L>
+operator-(dvector<T,L> &&lhs, dvector<T,L> &&rhs)
 {
 
-    dvector<T,L> result = lhs;
-    result -= rhs;
-    return result;
+    lhs -= rhs;
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator*(const dvector<T,L> &lhs, const dvector<T,L> &rhs)
+template <class T, size_t L> inline dvector<T,L>
+operator*(dvector<T,L> &&lhs, dvector<T,L> &&rhs)
 {
 
-    dvector<T,L> result = lhs;
-    result *= rhs;
-    return result;
+    lhs *= rhs;
+    return std::move(lhs);
 
 }
 
-template <class T, size_t L> inline dvector<T,L>    
-operator/(const dvector<T,L> &lhs, const dvector<T,L> &rhs)
+template <class T, size_t L> inline dvector<T,L>
+operator/(dvector<T,L> &&lhs, dvector<T,L> &&rhs)
 {
 
-    dvector<T,L> result = lhs;
-    result /= rhs;
-    return result;
+    lhs /= rhs;
+    return std::move(lhs);
 
 }
 
@@ -0,0 +1,75 @@
+#if defined(SF_ELEMENTS_UNIT_TEST) && SF_ELEMENTS_UNIT_TEST == 1
+#include <iostream>
+#include "elements.hpp"
+
+bool verify_elements()
+{
+
+    constexpr size_t particles = 700;
+    particle_bunch<double, 6> bunch(particles);
+    for (size_t i = 0; i < particles; ++i)
+    {
+        bunch[i] = dvector<double, 6>{ 0.001 * double(i % 13), -0.0005 * double(i % 7), 0.002 * double(i % 5),
+            0.0003 * double(i % 11), 0.0, 0.0001 * double(i % 3) };
+    }
+
+    const particle_bunch<double, 6> initial = bunch;
+    auto close = [&](size_t i, const dvector<double, 6> &expected)
+    {
+        bool equal = true;
+        for (size_t c = 0; c < 6; ++c) equal = equal && std::abs(bunch.column(c)[i] - expected[c]) <= 1e-13;
+        return equal;
+    };
+
+    // Drift and the sextupole kick against the formulas one particle at a time.
+    element_drift(bunch, 2.0);
+    element_thin_kick(bunch, 2, 3.0);
+    bool passed = true;
+    for (size_t i = 0; i < particles; ++i)
+    {
+        dvector<double, 6> p = initial[i];
+        p[0] += 2.0 * p[1];
+        p[2] += 2.0 * p[3];
+        p[1] -= 1.5 * (p[0] * p[0] - p[2] * p[2]);
+        p[3] += 3.0 * p[0] * p[2];
+        passed = passed && close(i, p);
+    }
+
+    // Running the quadrupole and dipole backwards undoes them.
+    bunch = initial;
+    element_quadrupole(bunch, 0.5, 1.2);
+    element_dipole(bunch, 1.5, 0.3);
+    element_quadrupole(bunch, 0.5, -0.8);
+    element_quadrupole(bunch, -0.5, -0.8);
+    element_dipole(bunch, -1.5, -0.3);
+    element_quadrupole(bunch, -0.5, 1.2);
+    for (size_t i = 0; i < particles; ++i) passed = passed && close(i, initial[i]);
+
+    // A thin quadrupole focuses horizontally as its thick counterpart does.
+    bunch = initial;
+    element_thin_kick(bunch, 1, 0.1);
+    for (size_t i = 0; i < particles; ++i)
+    {
+        dvector<double, 6> p = initial[i];
+        p[1] -= 0.1 * p[0];
+        p[3] += 0.1 * p[2];
+        passed = passed && close(i, p);
+    }
+
+    for (size_t i = particles; i < bunch.stride(); ++i) passed = passed && bunch.column(1)[i] == 0.0;
+    return passed;
+
+}
+
+int
+main()
+{
+
+    const bool element_passed = verify_elements();
+    std::cout << "Element check: " << (element_passed ? "passed" : "FAILED") << std::endl;
+
+    return element_passed ? 0 : 1;
+
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef SIGAMFOX_LIBRARY_ELEMENTS_HPP
+#define SIGAMFOX_LIBRARY_ELEMENTS_HPP
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "dvector.hpp"
+#include "bunch.hpp"
+
+// --- Optical Elements --------------------------------------------------------
+//
+// Symplectic element kernels that push every particle of a bunch through a drift, a
+// thin multipole kick, a thick quadrupole or a sector dipole. Particles use COSY's
+// coordinates (x, a, y, b, l, d): the transverse positions and slopes, then the path
+// length difference and the energy deviation. Bunches of fewer than six coordinates
+// are taken to be on energy, and the dipole only couples to l and d when both exist.
+//
+// Apart from the kick every element is the linear map of the element, which is
+// symplectic as written, and the kick is the gradient of a multipole potential, which
+// is symplectic for any strength. Each element reads and writes each column of the
+// bunch once, a chunk at a time so the scratch columns stay in L1, and all arithmetic
+// goes through the dvector kernels, so a turn made of these runs at the speed the
+// bunch streams through memory.
+//
+// COSY's own element procedures act on a global map, the intrinsics that call these
+// take the bunch as their first argument instead.
+//
+
+// Applies the 2x2 matrix { m00, m01, m10, m11 } to the coordinate pair (u, v).
+inline void
+element_linear_pair(const dvector_kernel_table<double> &kernels, double *u, double *v,
+        const double (&matrix)[4], double *scratch, size_t count)
+{
+
+    std::copy(u, u + count, scratch);
+    kernels.scalar_kernels[static_cast<size_t>(simd_op::OP_MUL)](scratch, matrix[0], count);
+    kernels.axpy(scratch, matrix[1], v, count);
+    kernels.scalar_kernels[static_cast<size_t>(simd_op::OP_MUL)](v, matrix[3], count);
+    kernels.axpy(v, matrix[2], u, count);
+    std::copy(scratch, scratch + count, u);
+
+}
+
+template <size_t D> inline void
+element_drift(particle_bunch<double, D> &bunch, double length)
+{
+
+    static_assert(D >= 4, "Elements need at least the four transverse coordinates.");
+    const dvector_kernel_table<double> &kernels = dvector_active_kernels<double>();
+
+    bunch.for_each_chunk([&](particle_chunk<double, D> &chunk)
+    {
+        double **column = chunk.columns;
+        kernels.axpy(column[0], length, column[1], chunk.count);
+        kernels.axpy(column[2], length, column[3], chunk.count);
+    });
+
+}
+
+template <size_t D> inline void
+element_thin_kick(particle_bunch<double, D> &bunch, int64_t order, double strength)
+{
+
+    // A normal 2(n+1)-pole of integrated strength k kicks the slopes by
+    // a -= Re[k (x + iy)^n / n!] and b += Im[k (x + iy)^n / n!].
+    static_assert(D >= 4, "Elements need at least the four transverse coordinates.");
+    const dvector_kernel_table<double> &kernels = dvector_active_kernels<double>();
+    const size_t mul = static_cast<size_t>(simd_op::OP_MUL);
+    const size_t sub = static_cast<size_t>(simd_op::OP_SUB);
+    const size_t add = static_cast<size_t>(simd_op::OP_ADD);
+
+    double factor = strength;
+    for (int64_t k = 2; k <= order; ++k) factor /= double(k);
+
+    constexpr size_t length = particle_bunch<double, D>::chunk_length;
+    std::vector<double, pool_allocator<double>> scratch(4 * length);
+    double *real = scratch.data();
+    double *imaginary = real + length;
+    double *next_real = imaginary + length;
+    double *product = next_real + length;
+
+    bunch.for_each_chunk([&](particle_chunk<double, D> &chunk)
+    {
+
+        double **column = chunk.columns;
+        const size_t count = chunk.count;
+        if (order <= 0)
+        {
+            kernels.scalar_kernels[sub](column[1], factor, count);
+            return;
+        }
+
+        std::copy(column[0], column[0] + count, real);
+        std::copy(column[2], column[2] + count, imaginary);
+        for (int64_t k = 1; k < order; ++k)
+        {
+
+            // (re + i im) * (x + i y), one column operation at a time.
+            std::copy(real, real + count, next_real);
+            kernels.vector_kernels[mul](next_real, column[0], count);
+            std::copy(imaginary, imaginary + count, product);
+            kernels.vector_kernels[mul](product, column[2], count);
+            kernels.vector_kernels[sub](next_real, product, count);
+
+            kernels.vector_kernels[mul](imaginary, column[0], count);
+            kernels.vector_kernels[mul](real, column[2], count);
+            kernels.vector_kernels[add](imaginary, real, count);
+            std::copy(next_real, next_real + count, real);
+
+        }
+
+        kernels.axpy(column[1], -factor, real, count);
+        kernels.axpy(column[3], factor, imaginary, count);
+
+    });
+
+}
+
+template <size_t D> inline void
+element_quadrupole(particle_bunch<double, D> &bunch, double length, double strength)
+{
+
+    // Positive strength focuses horizontally and defocuses vertically.
+    static_assert(D >= 4, "Elements need at least the four transverse coordinates.");
+    if (strength == 0.0) return element_drift(bunch, length);
+
+    const double omega = std::sqrt(std::abs(strength));
+    const double phase = omega * length;
+    const double focusing[4] = {
+        std::cos(phase), std::sin(phase) / omega, -omega * std::sin(phase), std::cos(phase) };
+    const double defocusing[4] = {
+        std::cosh(phase), std::sinh(phase) / omega, omega * std::sinh(phase), std::cosh(phase) };
+    const double (&horizontal)[4] = strength > 0.0 ? focusing : defocusing;
+    const double (&vertical)[4] = strength > 0.0 ? defocusing : focusing;
+
+    const dvector_kernel_table<double> &kernels = dvector_active_kernels<double>();
+    constexpr size_t chunk_length = particle_bunch<double, D>::chunk_length;
+    std::vector<double, pool_allocator<double>> scratch(chunk_length);
+
+    bunch.for_each_chunk([&](particle_chunk<double, D> &chunk)
+    {
+        double **column = chunk.columns;
+        element_linear_pair(kernels, column[0], column[1], horizontal, scratch.data(), chunk.count);
+        element_linear_pair(kernels, column[2], column[3], vertical, scratch.data(), chunk.count);
+    });
+
+}
+
+template <size_t D> inline void
+element_dipole(particle_bunch<double, D> &bunch, double length, double angle)
+{
+
+    // A sector dipole bending through angle over its arc length. Off-energy particles
+    // are dispersed horizontally, and the path length picks up the matching terms.
+    static_assert(D >= 4, "Elements need at least the four transverse coordinates.");
+    if (angle == 0.0) return element_drift(bunch, length);
+
+    const double radius = length / angle;
+    const double cosine = std::cos(angle);
+    const double sine = std::sin(angle);
+    const double horizontal[4] = { cosine, radius * sine, -sine / radius, cosine };
+    const double dispersion = radius * (1.0 - cosine);
+    constexpr bool chromatic = D >= 6;
+
+    const dvector_kernel_table<double> &kernels = dvector_active_kernels<double>();
+    constexpr size_t chunk_length = particle_bunch<double, D>::chunk_length;
+    std::vector<double, pool_allocator<double>> scratch(chunk_length);
+
+    bunch.for_each_chunk([&](particle_chunk<double, D> &chunk)
+    {
+
+        double **column = chunk.columns;
+        const size_t count = chunk.count;
+        if constexpr (chromatic)
+        {
+            kernels.axpy(column[4], -sine, column[0], count);
+            kernels.axpy(column[4], -dispersion, column[1], count);
+            kernels.axpy(column[4], -radius * (angle - sine), column[5], count);
+        }
+
+        element_linear_pair(kernels, column[0], column[1], horizontal, scratch.data(), count);
+        kernels.axpy(column[2], length, column[3], count);
+
+        if constexpr (chromatic)
+        {
+            kernels.axpy(column[0], dispersion, column[5], count);
+            kernels.axpy(column[1], sine, column[5], count);
+        }
+
+    });
+
+}
+
+#endif
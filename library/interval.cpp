@@ -0,0 +1,57 @@
+#if defined(SF_INTERVAL_UNIT_TEST) && SF_INTERVAL_UNIT_TEST == 1
+#include <iostream>
+#include <vector>
+#include "interval.hpp"
+
+bool verify_interval()
+{
+
+    // 0.1 + 0.2 isn't representable, the bounds are the doubles either side of it.
+    const interval sum = interval(0.1) + interval(0.2);
+    bool passed = sum.lower() == 0.3 && sum.upper() == 0.30000000000000004;
+
+    const interval mixed = interval(-1.0, 2.0) * interval(-3.0, 4.0);
+    const interval negative = interval(-2.0, -1.0) * interval(3.0, 4.0);
+    passed = passed && mixed.lower() == -6.0 && mixed.upper() == 8.0;
+    passed = passed && negative.lower() == -8.0 && negative.upper() == -3.0;
+    passed = passed && (interval(1.0, 2.0) - interval(0.5, 3.0)).lower() == -2.0;
+
+    const interval third = 1.0 / interval(3.0);
+    passed = passed && third.lower() < third.upper() && third.contains(1.0 / 3.0);
+    passed = passed && std::isinf((interval(1.0) / interval(-1.0, 1.0)).upper());
+    passed = passed && interval(1.0, 1.5).width() == 0.5;
+
+    // The batch kernels agree with the operators, and leave round to nearest behind.
+    constexpr size_t count = 64;
+    std::vector<interval> a(count), b(count), product(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        a[i] = interval(0.1 * double(i), 0.1 * double(i) + 0.01);
+        b[i] = interval(-0.3, 0.7 / double(i + 1));
+    }
+
+    interval_batch_multiply(product.data(), a.data(), b.data(), count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const interval expected = a[i] * b[i];
+        passed = passed && product[i].lower() == expected.lower() && product[i].upper() == expected.upper();
+    }
+
+    volatile double one = 1.0, three = 3.0;
+    passed = passed && one / three == 1.0 / 3.0 && -(one / three) == -1.0 / 3.0;
+    return passed;
+
+}
+
+int
+main()
+{
+
+    const bool interval_passed = verify_interval();
+    std::cout << "Interval check: " << (interval_passed ? "passed" : "FAILED") << std::endl;
+
+    return interval_passed ? 0 : 1;
+
+}
+
+#endif
@@ -0,0 +1,550 @@
+#ifndef SIGAMFOX_LIBRARY_INTERVAL_HPP
+#define SIGAMFOX_LIBRARY_INTERVAL_HPP
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <iostream>
+#include <iomanip>
+#include "simd.hpp"
+
+// --- Interval Arithmetic -----------------------------------------------------
+//
+// An interval is a rigorous enclosure [lower, upper]: every operation rounds its lower
+// bound down and its upper bound up, so the true result of the exact operation on any
+// values in the operands is always inside the result.
+//
+// Both bounds live in one 128-bit register, stored as (-lower, upper). Rounding the
+// negated lower bound up is the same as rounding the lower bound down, so with the
+// processor rounding upward every operation computes both bounds with one SSE2
+// instruction and no second rounding mode. Addition is a single add, negation swaps
+// the lanes, and multiplication takes four products and two maxima without branching
+// on the signs of the operands.
+//
+// Changing the rounding mode is slow next to an add, so it is done by an
+// interval_rounding guard, and guards nest. Each operator holds one for its own
+// duration, which switches the mode if no guard is active yet and costs a counter
+// increment if one is. A loop over many intervals should hold a guard around the
+// whole loop, as the batch kernels below do, so the mode is switched once per batch
+// rather than twice per operation. Outside of any guard the rounding mode is the
+// usual round to nearest.
+//
+// The compiler doesn't know arithmetic depends on the rounding mode, and would
+// happily fold constant operands or move an operation outside the guard. Operands
+// and results pass through interval_opaque, an empty asm statement it can't see
+// through, which pins each operation between the mode switches.
+//
+// Targets without SSE2 keep the same layout in two doubles and switch the mode
+// through <cfenv>.
+//
+
+#if SF_SIMD_X86 == 1 && (defined(__SSE2__) || defined(_M_X64))
+#   define SF_INTERVAL_SSE2 1
+#else
+#   define SF_INTERVAL_SSE2 0
+#   include <cfenv>
+#endif
+
+#if SF_INTERVAL_SSE2 == 1
+    using interval_register = __m128d;
+#else
+    struct interval_register { double lanes[2]; };
+#endif
+
+class interval_rounding
+{
+
+    public:
+        inline          interval_rounding();
+        inline         ~interval_rounding();
+
+                        interval_rounding(const interval_rounding&) = delete;
+        interval_rounding& operator=(const interval_rounding&) = delete;
+
+    protected:
+        static inline uint32_t& depth();
+        static inline uint32_t& saved_mode();
+
+};
+
+class interval
+{
+
+    public:
+        inline          interval();
+        inline          interval(double value);
+        inline          interval(double lower, double upper);
+        inline explicit interval(interval_register bounds);
+
+        inline double   lower() const;
+        inline double   upper() const;
+        inline double   width() const;
+        inline bool     contains(double value) const;
+
+        inline interval_register bounds() const;
+
+        inline interval& operator+=(const interval &rhs);
+        inline interval& operator-=(const interval &rhs);
+        inline interval& operator*=(const interval &rhs);
+        inline interval& operator/=(const interval &rhs);
+
+    protected:
+        interval_register negated_lower_upper;
+
+};
+
+// --- Rounding Mode -----------------------------------------------------------
+
+inline uint32_t& interval_rounding::
+depth()
+{
+
+    thread_local uint32_t guards = 0;
+    return guards;
+
+}
+
+inline uint32_t& interval_rounding::
+saved_mode()
+{
+
+    thread_local uint32_t mode = 0;
+    return mode;
+
+}
+
+inline interval_rounding::
+interval_rounding()
+{
+
+    if (depth()++ != 0) return;
+
+#   if SF_INTERVAL_SSE2 == 1
+        saved_mode() = _mm_getcsr();
+        _mm_setcsr((saved_mode() & ~_MM_ROUND_MASK) | _MM_ROUND_UP);
+#   else
+        saved_mode() = static_cast<uint32_t>(std::fegetround());
+        std::fesetround(FE_UPWARD);
+#   endif
+
+}
+
+inline interval_rounding::
+~interval_rounding()
+{
+
+    if (--depth() != 0) return;
+
+#   if SF_INTERVAL_SSE2 == 1
+        _mm_setcsr(saved_mode());
+#   else
+        std::fesetround(static_cast<int>(saved_mode()));
+#   endif
+
+}
+
+// --- Interval Kernels --------------------------------------------------------
+//
+// Every kernel expects upward rounding to be active.
+//
+
+inline interval_register
+interval_opaque(interval_register value)
+{
+
+#   if defined(__GNUC__) || defined(__clang__)
+#       if SF_INTERVAL_SSE2 == 1
+            __asm__ volatile("" : "+x"(value));
+#       else
+            __asm__ volatile("" : "+m"(value));
+#       endif
+#   endif
+    return value;
+
+}
+
+#if SF_INTERVAL_SSE2 == 1
+
+inline interval_register
+interval_pack(double negated_lower, double upper)
+{
+
+    return _mm_set_pd(upper, negated_lower);
+
+}
+
+inline double
+interval_lane(interval_register value, int lane)
+{
+
+    return lane == 0 ? _mm_cvtsd_f64(value) : _mm_cvtsd_f64(_mm_unpackhi_pd(value, value));
+
+}
+
+inline interval_register
+interval_add_kernel(interval_register lhs, interval_register rhs)
+{
+
+    return interval_opaque(_mm_add_pd(interval_opaque(lhs), interval_opaque(rhs)));
+
+}
+
+inline interval_register
+interval_negate_kernel(interval_register value)
+{
+
+    return _mm_shuffle_pd(value, value, 1);
+
+}
+
+inline interval_register
+interval_multiply_kernel(interval_register lhs, interval_register rhs)
+{
+
+    // Lane 0 collects the negated lower candidates, lane 1 the upper ones. Flipping
+    // the sign of one lane of each broadcast pairs every product with its negation.
+    lhs = interval_opaque(lhs);
+    rhs = interval_opaque(rhs);
+    const __m128d flip_low      = _mm_set_pd(0.0, -0.0);
+    const __m128d flip_high     = _mm_set_pd(-0.0, 0.0);
+    const __m128d lhs_low       = _mm_unpacklo_pd(lhs, lhs);
+    const __m128d lhs_high      = _mm_unpackhi_pd(lhs, lhs);
+    const __m128d rhs_low       = _mm_unpacklo_pd(rhs, rhs);
+    const __m128d rhs_high      = _mm_unpackhi_pd(rhs, rhs);
+
+    const __m128d first     = _mm_mul_pd(lhs_low, _mm_xor_pd(rhs_low, flip_low));
+    const __m128d second    = _mm_mul_pd(lhs_low, _mm_xor_pd(rhs_high, flip_high));
+    const __m128d third     = _mm_mul_pd(lhs_high, _mm_xor_pd(rhs_low, flip_high));
+    const __m128d fourth    = _mm_mul_pd(lhs_high, _mm_xor_pd(rhs_high, flip_low));
+    return interval_opaque(_mm_max_pd(_mm_max_pd(first, second), _mm_max_pd(third, fourth)));
+
+}
+
+inline interval_register
+interval_reciprocal_kernel(interval_register value)
+{
+
+    // 1 / [l, h] is [1 / h, 1 / l], stored as (-1 / h, 1 / l), one division.
+    value = interval_opaque(value);
+    const __m128d swapped = _mm_xor_pd(_mm_shuffle_pd(value, value, 1), _mm_set_pd(-0.0, 0.0));
+    return interval_opaque(_mm_div_pd(interval_opaque(_mm_set_pd(1.0, -1.0)), swapped));
+
+}
+
+#else
+
+inline interval_register
+interval_pack(double negated_lower, double upper)
+{
+
+    return interval_register{ { negated_lower, upper } };
+
+}
+
+inline double
+interval_lane(interval_register value, int lane)
+{
+
+    return value.lanes[lane];
+
+}
+
+inline interval_register
+interval_add_kernel(interval_register lhs, interval_register rhs)
+{
+
+    lhs = interval_opaque(lhs);
+    rhs = interval_opaque(rhs);
+    return interval_opaque(interval_pack(lhs.lanes[0] + rhs.lanes[0], lhs.lanes[1] + rhs.lanes[1]));
+
+}
+
+inline interval_register
+interval_negate_kernel(interval_register value)
+{
+
+    return interval_pack(value.lanes[1], value.lanes[0]);
+
+}
+
+inline interval_register
+interval_multiply_kernel(interval_register lhs, interval_register rhs)
+{
+
+    lhs = interval_opaque(lhs);
+    rhs = interval_opaque(rhs);
+    const double a = lhs.lanes[0], b = lhs.lanes[1], c = rhs.lanes[0], d = rhs.lanes[1];
+    const double negated_lower = std::fmax(std::fmax(a * -c, a * d), std::fmax(b * c, b * -d));
+    const double upper = std::fmax(std::fmax(a * c, a * -d), std::fmax(b * -c, b * d));
+    return interval_opaque(interval_pack(negated_lower, upper));
+
+}
+
+inline interval_register
+interval_reciprocal_kernel(interval_register value)
+{
+
+    value = interval_opaque(value);
+    return interval_opaque(interval_pack(-1.0 / value.lanes[1], 1.0 / -value.lanes[0]));
+
+}
+
+#endif
+
+inline interval_register
+interval_divide_kernel(interval_register lhs, interval_register rhs)
+{
+
+    // Dividing by an interval that holds zero can give anything.
+    if (interval_lane(rhs, 0) >= 0.0 && interval_lane(rhs, 1) >= 0.0)
+    {
+        const double infinity = std::numeric_limits<double>::infinity();
+        return interval_pack(infinity, infinity);
+    }
+
+    return interval_multiply_kernel(lhs, interval_reciprocal_kernel(rhs));
+
+}
+
+// --- Interval ----------------------------------------------------------------
+
+inline interval::
+interval()
+    : negated_lower_upper(interval_pack(-0.0, 0.0))
+{
+
+}
+
+inline interval::
+interval(double value)
+    : negated_lower_upper(interval_pack(-value, value))
+{
+
+}
+
+inline interval::
+interval(double lower, double upper)
+    : negated_lower_upper(interval_pack(-lower, upper))
+{
+
+}
+
+inline interval::
+interval(interval_register bounds)
+    : negated_lower_upper(bounds)
+{
+
+}
+
+inline double interval::
+lower() const
+{
+
+    return -interval_lane(this->negated_lower_upper, 0);
+
+}
+
+inline double interval::
+upper() const
+{
+
+    return interval_lane(this->negated_lower_upper, 1);
+
+}
+
+inline double interval::
+width() const
+{
+
+    // (-lower, upper) plus its swap is upper - lower in both lanes, rounded up.
+    interval_rounding rounding;
+    const interval_register bounds = this->negated_lower_upper;
+    return interval_lane(interval_add_kernel(bounds, interval_negate_kernel(bounds)), 1);
+
+}
+
+inline bool interval::
+contains(double value) const
+{
+
+    return this->lower() <= value && value <= this->upper();
+
+}
+
+inline interval_register interval::
+bounds() const
+{
+
+    return this->negated_lower_upper;
+
+}
+
+inline interval& interval::
+operator+=(const interval &rhs)
+{
+
+    interval_rounding rounding;
+    this->negated_lower_upper = interval_add_kernel(this->negated_lower_upper, rhs.negated_lower_upper);
+    return *this;
+
+}
+
+inline interval& interval::
+operator-=(const interval &rhs)
+{
+
+    interval_rounding rounding;
+    this->negated_lower_upper = interval_add_kernel(this->negated_lower_upper,
+            interval_negate_kernel(rhs.negated_lower_upper));
+    return *this;
+
+}
+
+inline interval& interval::
+operator*=(const interval &rhs)
+{
+
+    interval_rounding rounding;
+    this->negated_lower_upper = interval_multiply_kernel(this->negated_lower_upper, rhs.negated_lower_upper);
+    return *this;
+
+}
+
+inline interval& interval::
+operator/=(const interval &rhs)
+{
+
+    interval_rounding rounding;
+    this->negated_lower_upper = interval_divide_kernel(this->negated_lower_upper, rhs.negated_lower_upper);
+    return *this;
+
+}
+
+inline interval operator+(interval lhs, const interval &rhs)    { lhs += rhs; return lhs; }
+inline interval operator-(interval lhs, const interval &rhs)    { lhs -= rhs; return lhs; }
+inline interval operator*(interval lhs, const interval &rhs)    { lhs *= rhs; return lhs; }
+inline interval operator/(interval lhs, const interval &rhs)    { lhs /= rhs; return lhs; }
+inline interval operator+(interval lhs, double rhs)             { lhs += interval(rhs); return lhs; }
+inline interval operator-(interval lhs, double rhs)             { lhs -= interval(rhs); return lhs; }
+inline interval operator*(interval lhs, double rhs)             { lhs *= interval(rhs); return lhs; }
+inline interval operator/(interval lhs, double rhs)             { lhs /= interval(rhs); return lhs; }
+inline interval operator+(double lhs, const interval &rhs)      { return interval(lhs) + rhs; }
+inline interval operator-(double lhs, const interval &rhs)      { return interval(lhs) - rhs; }
+inline interval operator*(double lhs, const interval &rhs)      { return interval(lhs) * rhs; }
+inline interval operator/(double lhs, const interval &rhs)      { return interval(lhs) / rhs; }
+inline interval operator-(const interval &value)                { return interval(interval_negate_kernel(value.bounds())); }
+
+inline std::ostream&
+operator<<(std::ostream &os, const interval &value)
+{
+
+    os << std::setprecision(17) << "[" << value.lower() << ", " << value.upper() << "]"
+       << std::setprecision(6);
+    return os;
+
+}
+
+// --- Batch Kernels -----------------------------------------------------------
+//
+// Element-wise operations over arrays of intervals, switching the rounding mode once
+// for the whole array. The destination may alias either operand.
+//
+
+template <class K> inline void
+interval_batch(interval *dst, const interval *lhs, const interval *rhs, size_t count, K kernel)
+{
+
+    interval_rounding rounding;
+    for (size_t i = 0; i < count; ++i) dst[i] = interval(kernel(lhs[i].bounds(), rhs[i].bounds()));
+
+}
+
+inline void
+interval_batch_add(interval *dst, const interval *lhs, const interval *rhs, size_t count)
+{
+
+    interval_batch(dst, lhs, rhs, count, interval_add_kernel);
+
+}
+
+inline void
+interval_batch_subtract(interval *dst, const interval *lhs, const interval *rhs, size_t count)
+{
+
+    interval_batch(dst, lhs, rhs, count, [](interval_register a, interval_register b)
+    {
+        return interval_add_kernel(a, interval_negate_kernel(b));
+    });
+
+}
+
+inline void
+interval_batch_multiply(interval *dst, const interval *lhs, const interval *rhs, size_t count)
+{
+
+    interval_batch(dst, lhs, rhs, count, interval_multiply_kernel);
+
+}
+
+inline void
+interval_batch_divide(interval *dst, const interval *lhs, const interval *rhs, size_t count)
+{
+
+    interval_batch(dst, lhs, rhs, count, interval_divide_kernel);
+
+}
+
+// --- COSY Operations ---------------------------------------------------------
+
+inline interval
+interval_make(double lower, double upper)
+{
+
+    return interval(std::fmin(lower, upper), std::fmax(lower, upper));
+
+}
+
+inline double
+interval_lower(const interval &value)
+{
+
+    return value.lower();
+
+}
+
+inline double
+interval_upper(const interval &value)
+{
+
+    return value.upper();
+
+}
+
+inline double
+interval_width(const interval &value)
+{
+
+    return value.width();
+
+}
+
+// std::sqrt is correctly rounded in whichever mode is active, so one step outward
+// from each rounded root encloses the exact one, inside a guard or not. The negative
+// part of the argument has no real root and is cut off, and an interval that is
+// negative throughout gives NaN bounds, as std::sqrt does.
+inline interval
+math_sqrt(const interval &value)
+{
+
+    if (value.upper() < 0.0)
+    {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        return interval(nan, nan);
+    }
+
+    const double lower = std::sqrt(std::fmax(value.lower(), 0.0));
+    const double upper = std::sqrt(value.upper());
+    return interval(std::nextafter(lower, 0.0), std::nextafter(upper, std::numeric_limits<double>::infinity()));
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+#if defined(SF_MAP_UNIT_TEST) && SF_MAP_UNIT_TEST == 1
+#include <iostream>
+#include "map.hpp"
+
+bool verify_map()
+{
+
+    da_initialize(4, 3, 0);
+    const da x = da_variable(1);
+    const da y = da_variable(2);
+    const da z = da_variable(3);
+
+    transfer_map m(3);
+    m[0] = x + 0.1 * y * y + 0.5;
+    m[1] = y - 0.2 * x * y;
+    m[2] = z + x * x * x;
+
+    transfer_map n(3);
+    n[0] = 2.0 * x - z;
+    n[1] = y + 0.3 * x * z;
+    n[2] = z - y * y;
+
+    auto same = [](const da &a, const da &b)
+    {
+        bool equal = a.size() == b.size();
+        for (size_t k = 0; equal && k < a.size(); ++k)
+            equal = std::abs(a[k] - b[k]) <= 1e-12 * std::max(1.0, std::abs(b[k]));
+        return equal;
+    };
+
+    // Composing with the identity either way changes nothing, and composing with n
+    // agrees with substituting n into m by hand.
+    const transfer_map identity = map_identity(3);
+    const transfer_map left = map_compose(identity, m);
+    const transfer_map right = map_compose(m, identity);
+    transfer_map composed;
+    cosy_compose(m, n, composed);
+
+    bool passed = composed.dimension() == 3;
+    for (size_t c = 0; c < 3; ++c) passed = passed && same(left[c], m[c]) && same(right[c], m[c]);
+    passed = passed && same(composed[0], n[0] + 0.1 * n[1] * n[1] + 0.5);
+    passed = passed && same(composed[1], n[1] - 0.2 * n[0] * n[1]);
+    passed = passed && same(composed[2], n[2] + n[0] * n[0] * n[0]);
+
+    // Two turns through m for a bunch spanning several chunks, against evaluating the
+    // polynomials one particle at a time.
+    constexpr size_t particles = 1000;
+    particle_bunch<double, 3> bunch(particles);
+    std::vector<dvector<double, 3>> expected(particles);
+    for (size_t i = 0; i < particles; ++i)
+    {
+
+        dvector<double, 3> particle = { 0.001 * double(i % 17), -0.002 * double(i % 11), 0.0005 * double(i % 7) };
+        bunch[i] = particle;
+        for (int turn = 0; turn < 2; ++turn)
+        {
+            const double px = particle[0], py = particle[1], pz = particle[2];
+            particle[0] = px + 0.1 * py * py + 0.5;
+            particle[1] = py - 0.2 * px * py;
+            particle[2] = pz + px * px * px;
+        }
+        expected[i] = particle;
+
+    }
+
+    cosy_apply_map(m, bunch, 2);
+    for (size_t i = 0; i < particles; ++i)
+    {
+        for (size_t c = 0; c < 3; ++c)
+            passed = passed && std::abs(bunch.column(c)[i] - expected[i][c]) <= 1e-12;
+    }
+
+    for (size_t i = particles; i < bunch.stride(); ++i) passed = passed && bunch.column(0)[i] == 0.0;
+
+    return passed;
+
+}
+
+int
+main()
+{
+
+    const bool map_passed = verify_map();
+    std::cout << "Map check: " << (map_passed ? "passed" : "FAILED") << std::endl;
+
+    return map_passed ? 0 : 1;
+
+}
+
+#endif
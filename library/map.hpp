@@ -0,0 +1,335 @@
+#ifndef SIGAMFOX_LIBRARY_MAP_HPP
+#define SIGAMFOX_LIBRARY_MAP_HPP
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "dvector.hpp"
+#include "bunch.hpp"
+#include "da.hpp"
+
+// --- Transfer Map ------------------------------------------------------------
+//
+// A transfer map is one DA vector per phase-space coordinate, the polynomial that
+// takes a particle's coordinates at the start of an element, or a turn, to those at
+// its end. It is what a COSY array of DA becomes in generated code.
+//
+// Composing two maps and pushing particles through one are both polynomial
+// evaluation, and both go through a map_plan. The plan walks the monomial tree of
+// the active DA context depth first, visiting only the monomials some component
+// uses, and the monomials on the way to them. Each monomial's value is its parent's
+// times one variable, the same sharing Horner's rule gets in one variable, so every
+// power is computed once for all components and only one value per order is alive
+// at any time.
+//
+// Evaluating for particles keeps those values per particle, a chunk of the bunch at
+// a time, so the multiplies and accumulations run through the dvector kernels over
+// whole columns. Tracking over several turns runs every turn on one chunk before
+// moving to the next, while the chunk is still in cache.
+//
+
+class transfer_map
+{
+
+    public:
+        inline              transfer_map();
+        inline              transfer_map(size_t dimension);
+
+        inline da&          operator[](const size_t index);
+        inline const da&    operator[](const size_t index) const;
+
+        inline size_t       dimension() const;
+        inline void         resize(size_t dimension);
+
+    protected:
+        std::vector<da> components;
+
+};
+
+class map_plan
+{
+
+    public:
+        inline              map_plan(const da_context &context, const transfer_map &map);
+
+    public:
+        class step
+        {
+
+            public:
+                uint32_t    depth;
+                uint32_t    variable;
+                uint32_t    first_term;
+                uint32_t    term_count;
+
+        };
+
+        class term
+        {
+
+            public:
+                uint32_t    component;
+                double      coefficient;
+
+        };
+
+    public:
+        std::vector<step>       steps;
+        std::vector<term>       terms;
+        std::vector<double>     constants;
+        size_t                  depth;
+
+    protected:
+        inline void         walk(const da_context &context, const transfer_map &map,
+                                const std::vector<uint8_t> &needed, size_t monomial, uint32_t depth);
+
+};
+
+// --- Transfer Map ------------------------------------------------------------
+
+inline transfer_map::
+transfer_map()
+{
+
+}
+
+inline transfer_map::
+transfer_map(size_t dimension)
+    : components(dimension)
+{
+
+}
+
+inline da& transfer_map::
+operator[](const size_t index)
+{
+
+    return this->components[index];
+
+}
+
+inline const da& transfer_map::
+operator[](const size_t index) const
+{
+
+    return this->components[index];
+
+}
+
+inline size_t transfer_map::
+dimension() const
+{
+
+    return this->components.size();
+
+}
+
+inline void transfer_map::
+resize(size_t dimension)
+{
+
+    this->components.resize(dimension);
+
+}
+
+// --- Map Plan ----------------------------------------------------------------
+
+inline map_plan::
+map_plan(const da_context &context, const transfer_map &map)
+    : constants(map.dimension(), 0.0), depth(0)
+{
+
+    // Mark every monomial a component uses, and the path from the root to it.
+    std::vector<uint8_t> needed(context.monomial_count, 0);
+    for (size_t c = 0; c < map.dimension(); ++c)
+    {
+
+        const da &component = map[c];
+        const size_t count = std::min(component.size(), context.monomial_count);
+        if (count != 0) this->constants[c] = component[0];
+        for (size_t m = 1; m < count; ++m)
+        {
+            if (component[m] == 0.0) continue;
+            for (size_t at = m; at != 0 && !needed[at]; at = context.parent[at]) needed[at] = 1;
+        }
+
+    }
+
+    if (context.monomial_count != 0) this->walk(context, map, needed, 0, 0);
+
+}
+
+inline void map_plan::
+walk(const da_context &context, const transfer_map &map, const std::vector<uint8_t> &needed,
+        size_t monomial, uint32_t depth)
+{
+
+    // Children raise the highest variable of their parent or a later one, which gives
+    // every monomial exactly one place in the tree.
+    const size_t first_variable = monomial == 0 ? 0 : context.top_variable[monomial];
+    for (size_t v = first_variable; v < context.variables; ++v)
+    {
+
+        const size_t child = context.raise[monomial * context.variables + v];
+        if (child >= context.monomial_count || !needed[child]) continue;
+
+        step current;
+        current.depth       = depth + 1;
+        current.variable    = static_cast<uint32_t>(v);
+        current.first_term  = static_cast<uint32_t>(this->terms.size());
+        for (size_t c = 0; c < map.dimension(); ++c)
+        {
+            if (child >= map[c].size() || map[c][child] == 0.0) continue;
+            this->terms.push_back({ static_cast<uint32_t>(c), map[c][child] });
+        }
+
+        current.term_count = static_cast<uint32_t>(this->terms.size()) - current.first_term;
+        this->steps.push_back(current);
+        this->depth = std::max<size_t>(this->depth, current.depth);
+        this->walk(context, map, needed, child, depth + 1);
+
+    }
+
+}
+
+// --- Map Operations ----------------------------------------------------------
+
+inline transfer_map
+map_identity(size_t dimension)
+{
+
+    transfer_map identity(dimension);
+    for (size_t c = 0; c < dimension; ++c) identity[c] = da_variable(static_cast<int64_t>(c + 1));
+    return identity;
+
+}
+
+inline transfer_map
+map_compose(const transfer_map &outer, const transfer_map &inner)
+{
+
+    // outer(inner), variable v of the outer map is replaced by inner[v]. Variables
+    // past the inner map's dimension are carried through unchanged.
+    const da_context &context = da_active_context();
+    const map_plan plan(context, outer);
+
+    std::vector<da> inputs(context.variables);
+    for (size_t v = 0; v < context.variables; ++v)
+    {
+        inputs[v] = v < inner.dimension() ? inner[v] : da_variable(static_cast<int64_t>(v + 1));
+        inputs[v].conform();
+    }
+
+    transfer_map result(outer.dimension());
+    for (size_t c = 0; c < outer.dimension(); ++c) result[c] = da(plan.constants[c]);
+
+    const dvector_kernel_table<double> &kernels = dvector_active_kernels<double>();
+    std::vector<da> level(plan.depth + 1);
+    for (const map_plan::step &current : plan.steps)
+    {
+
+        if (current.depth == 1)
+            level[1] = inputs[current.variable];
+        else
+            da_multiply_kernel(context, level[current.depth - 1].data(), inputs[current.variable].data(),
+                    level[current.depth].data());
+
+        for (uint32_t t = current.first_term; t < current.first_term + current.term_count; ++t)
+        {
+            const map_plan::term &addend = plan.terms[t];
+            kernels.axpy(result[addend.component].data(), addend.coefficient,
+                    level[current.depth].data(), context.monomial_count);
+        }
+
+    }
+
+    return result;
+
+}
+
+template <size_t D> inline void
+map_apply(const transfer_map &map, particle_bunch<double, D> &bunch, size_t turns = 1)
+{
+
+    // Coordinates past the map's dimension are left alone, and DA variables past the
+    // bunch's dimension evaluate to zero.
+    const da_context &context = da_active_context();
+    const map_plan plan(context, map);
+    const size_t outputs = std::min(D, map.dimension());
+    constexpr size_t length = particle_bunch<double, D>::chunk_length;
+    using buffer = std::vector<double, pool_allocator<double>>;
+
+    const dvector_kernel_table<double> &kernels = dvector_active_kernels<double>();
+    buffer zeros(length, 0.0);
+    buffer level((plan.depth + 1) * length);
+    buffer result(D * length);
+
+    bunch.for_each_chunk([&](particle_chunk<double, D> &chunk)
+    {
+
+        const size_t count = chunk.count;
+        std::vector<const double*> inputs(context.variables, zeros.data());
+        for (size_t v = 0; v < std::min(D, context.variables); ++v) inputs[v] = chunk.columns[v];
+
+        for (size_t turn = 0; turn < turns; ++turn)
+        {
+
+            for (size_t c = 0; c < outputs; ++c)
+                std::fill(result.data() + c * length, result.data() + c * length + count, plan.constants[c]);
+
+            for (const map_plan::step &current : plan.steps)
+            {
+
+                double *value = level.data() + current.depth * length;
+                const double *variable = inputs[current.variable];
+                if (current.depth == 1)
+                {
+                    std::copy(variable, variable + count, value);
+                }
+                else
+                {
+                    const double *previous = value - length;
+                    std::copy(previous, previous + count, value);
+                    kernels.vector_kernels[static_cast<size_t>(simd_op::OP_MUL)](value, variable, count);
+                }
+
+                for (uint32_t t = current.first_term; t < current.first_term + current.term_count; ++t)
+                {
+                    const map_plan::term &addend = plan.terms[t];
+                    if (addend.component >= outputs) continue;
+                    kernels.axpy(result.data() + addend.component * length, addend.coefficient, value, count);
+                }
+
+            }
+
+            for (size_t c = 0; c < outputs; ++c)
+                std::copy(result.data() + c * length, result.data() + c * length + count, chunk.columns[c]);
+
+        }
+
+    });
+
+}
+
+// --- COSY Procedures ---------------------------------------------------------
+//
+// COSY procedures return through their arguments, so the intrinsic procedures take
+// the result last.
+//
+
+inline void
+cosy_compose(const transfer_map &outer, const transfer_map &inner, transfer_map &result)
+{
+
+    result = map_compose(outer, inner);
+
+}
+
+template <size_t D> inline void
+cosy_apply_map(const transfer_map &map, particle_bunch<double, D> &bunch, int64_t turns)
+{
+
+    map_apply(map, bunch, static_cast<size_t>(std::max<int64_t>(turns, 0)));
+
+}
+
+#endif
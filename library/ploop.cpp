@@ -0,0 +1,124 @@
+#if defined(SF_PLOOP_UNIT_TEST) && SF_PLOOP_UNIT_TEST == 1
+#include <cmath>
+#include <iostream>
+#include "ploop.hpp"
+
+bool verify_ploop()
+{
+
+    // Uneven iterations, the cost grows with the index, so the tail has to be stolen.
+    constexpr int64_t count = 2000;
+    dvector<double, count> shared;
+    ploop_gather<dvector<double, count>> gather(0, count);
+    ploop_run(0, count, [=, &gather](int64_t i) mutable
+    {
+        double value = 0.0;
+        for (int64_t k = 0; k <= i * 50; ++k) value += 1.0 / double(k + 1);
+        shared[i] = value;
+        gather.store(i, shared);
+    });
+    gather.merge(shared);
+
+    bool passed = true;
+    for (int64_t i = 0; i < count; ++i)
+    {
+        double expected = 0.0;
+        for (int64_t k = 0; k <= i * 50; ++k) expected += 1.0 / double(k + 1);
+        passed = passed && shared[i] == expected;
+    }
+
+    // Each element of a bunch or an array of numbers comes from its own iteration, and
+    // a scalar from the last.
+    particle_bunch<double, 2> bunch(64);
+    std::vector<double> numbers(64);
+    int64_t last = -1;
+    ploop_gather<particle_bunch<double, 2>> bunch_gather(0, 64);
+    ploop_gather<std::vector<double>> numbers_gather(0, 64);
+    ploop_gather<int64_t> last_gather(0, 64);
+    ploop_run(0, 64, [=, &bunch_gather, &numbers_gather, &last_gather](int64_t i) mutable
+    {
+        bunch[i][0] = double(i);
+        bunch[i][1] = -double(i);
+        numbers[i] = double(i * i);
+        last = i;
+        bunch_gather.store(i, bunch);
+        numbers_gather.store(i, numbers);
+        last_gather.store(i, last);
+    });
+
+    // Until the merge, the iterations only changed their own copies.
+    passed = passed && last == -1 && bunch[5][0] == 0.0 && numbers[5] == 0.0;
+    bunch_gather.merge(bunch);
+    numbers_gather.merge(numbers);
+    last_gather.merge(last);
+
+    for (size_t i = 0; i < 64; ++i) passed = passed && bunch[i][0] == double(i) && bunch[i][1] == -double(i);
+    for (size_t i = 0; i < 64; ++i) passed = passed && numbers[i] == double(i * i);
+    passed = passed && last == 63;
+
+    // Reductions fold in the same tree however the iterations were spread, so the sum
+    // on the pool is bit for bit the one a single thread gets. The range is long enough
+    // for every partial to cover a chunk of iterations, and doesn't divide evenly.
+    constexpr int64_t terms = 100003;
+    auto reduce = [](auto &pool, double &sum, dvector<double, 2> &moments, double &largest)
+    {
+        ploop_reduction<double, ploop_sum> sum_reduction(0, terms, sum);
+        ploop_reduction<dvector<double, 2>, ploop_sum> moment_reduction(0, terms, moments);
+        ploop_reduction<double, ploop_maximum> largest_reduction(0, terms, largest);
+        pool.run(0, terms, [=, &sum_reduction, &moment_reduction, &largest_reduction](int64_t i) mutable
+        {
+            sum = sum_reduction.start();
+            moments = moment_reduction.start();
+            largest = largest_reduction.start();
+            const double x = std::sin(double(i)) / double(i + 1);
+            sum = sum + x;
+            moments[0] = moments[0] + x;
+            moments[1] = moments[1] + x * x;
+            if (x > largest) largest = x;
+            sum_reduction.store(i, sum);
+            moment_reduction.store(i, moments);
+            largest_reduction.store(i, largest);
+        }, sum_reduction.grain());
+        sum_reduction.merge(sum);
+        moment_reduction.merge(moments);
+        largest_reduction.merge(largest);
+    };
+
+    ploop_pool single(1), three(3);
+    double sum = 1.0, single_sum = 1.0, three_sum = 1.0, largest = -1.0, single_largest = -1.0, three_largest = -1.0;
+    dvector<double, 2> moments, single_moments, three_moments;
+    reduce(ploop_pool::instance(), sum, moments, largest);
+    reduce(single, single_sum, single_moments, single_largest);
+    reduce(three, three_sum, three_moments, three_largest);
+
+    double expected_sum = 1.0, expected_largest = -1.0;
+    for (int64_t i = 0; i < terms; ++i)
+    {
+        const double x = std::sin(double(i)) / double(i + 1);
+        expected_sum += x;
+        expected_largest = x > expected_largest ? x : expected_largest;
+    }
+
+    passed = passed && sum == single_sum && moments[0] == single_moments[0] && moments[1] == single_moments[1];
+    passed = passed && sum == three_sum && moments[1] == three_moments[1] && largest == three_largest;
+    passed = passed && std::fabs(sum - expected_sum) < 1e-12 && std::fabs(moments[0] - (expected_sum - 1.0)) < 1e-12;
+    passed = passed && largest == expected_largest && largest == single_largest;
+
+    std::cout << "    " << ploop_pool::instance().size() << " threads" << std::endl;
+    return passed;
+
+}
+
+int
+main()
+{
+
+    std::cout << "Parallel loop:" << std::endl;
+    const bool ploop_passed = verify_ploop();
+    std::cout << "Ploop check: " << (ploop_passed ? "passed" : "FAILED") << std::endl;
+
+    return ploop_passed ? 0 : 1;
+
+}
+
+#endif
@@ -0,0 +1,655 @@
+#ifndef SIGAMFOX_LIBRARY_PLOOP_HPP
+#define SIGAMFOX_LIBRARY_PLOOP_HPP
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "dvector.hpp"
+#include "bunch.hpp"
+#include "map.hpp"
+
+// --- Parallel Loop -----------------------------------------------------------
+//
+// PLOOP runs its iterations on a pool of threads that share work by stealing. The
+// range of iterations is split evenly over the threads up front. Each thread takes
+// iterations one at a time from the front of its own range, and a thread whose range
+// runs out takes the back half of the largest range left, so an uneven loop, a scan
+// where some points track for much longer than others, still keeps every thread busy
+// until the end. A loop can ask for a grain, and then ranges are only ever split at
+// multiples of the grain from the first iteration, so every chunk of that many
+// iterations runs on one thread, in order, see ploop_reduction.
+//
+// COSY gives every process in a PLOOP its own copy of the program's variables, and
+// only the shared array named after ENDPLOOP is exchanged when the loop ends, element
+// I taken from the process that ran iteration I. The generated body is a lambda that
+// captures by value, and each thread runs its own copy of it, so each thread has its
+// own variables just the same. After every iteration the body stores its element of
+// the shared variable into that iteration's slot of a ploop_gather, and once every
+// iteration is done the slots are merged back in iteration order. ploop_share says
+// what an element is: one entry of an array of numbers, one component of a dvector,
+// one particle of a bunch, or one DA of a map. Any other type is shared whole, the
+// slot of the last iteration wins, as it would running in order.
+//
+// The pool starts on the first PLOOP with one thread per core, the thread running
+// the program included. Setting the SF_PLOOP_THREADS environment variable changes
+// the count, and 1 runs every PLOOP in order on the calling thread. A PLOOP inside
+// another runs in order on whichever thread reaches it. Generated programs link
+// against the platform's threads library for this.
+//
+
+class ploop_pool
+{
+
+    public:
+        inline              ploop_pool(size_t thread_count);
+        inline             ~ploop_pool();
+
+                            ploop_pool(const ploop_pool&) = delete;
+        ploop_pool&         operator=(const ploop_pool&) = delete;
+
+        static inline ploop_pool&   instance();
+        static inline size_t        default_thread_count();
+
+        inline size_t       size() const;
+
+        template <class F>
+        inline void         run(int64_t first, int64_t last, const F &body, int64_t grain = 1);
+
+        // Set on a thread already running PLOOP iterations, and in forked workers,
+        // where the pool's threads don't exist. Loops reached there run in order.
+        static inline bool& inside();
+
+    protected:
+        struct alignas(64) work_range
+        {
+            std::mutex      lock;
+            int64_t         begin;
+            int64_t         end;
+        };
+
+        struct job
+        {
+            void          (*execute)(void *context, size_t participant);
+            void           *context;
+        };
+
+        inline void         work(size_t participant);
+        inline bool         take(size_t participant, int64_t &iteration);
+        inline bool         steal(size_t participant);
+        inline int64_t      split(int64_t begin, int64_t end) const;
+        inline void         worker(size_t participant);
+
+    protected:
+        std::vector<std::thread>                    threads;
+        std::unique_ptr<work_range[]>               ranges;
+        size_t                                      participants;
+        int64_t                                     origin;
+        int64_t                                     grain;
+
+        std::mutex                                  run_lock;
+        std::mutex                                  state_lock;
+        std::condition_variable                     started;
+        std::condition_variable                     finished;
+        job                                         current;
+        uint64_t                                    generation;
+        size_t                                      active;
+        bool                                        stopping;
+        std::exception_ptr                          failure;
+
+};
+
+inline ploop_pool& ploop_pool::
+instance()
+{
+
+    static ploop_pool pool(default_thread_count());
+    return pool;
+
+}
+
+inline size_t ploop_pool::
+default_thread_count()
+{
+
+    const char *requested = std::getenv("SF_PLOOP_THREADS");
+    if (requested != nullptr)
+    {
+        const long count = std::strtol(requested, nullptr, 10);
+        if (count > 0) return size_t(count);
+    }
+
+    const size_t cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+
+}
+
+inline bool& ploop_pool::
+inside()
+{
+
+    thread_local bool inside_ploop = false;
+    return inside_ploop;
+
+}
+
+inline ploop_pool::
+ploop_pool(size_t thread_count)
+    : ranges(new work_range[thread_count > 0 ? thread_count : 1]),
+      participants(thread_count > 0 ? thread_count : 1), origin(0), grain(1), current{ nullptr, nullptr },
+      generation(0), active(0), stopping(false)
+{
+
+    // Participant zero is whichever thread calls run().
+    for (size_t participant = 1; participant < this->participants; ++participant)
+        this->threads.emplace_back(&ploop_pool::worker, this, participant);
+
+}
+
+inline ploop_pool::
+~ploop_pool()
+{
+
+    {
+        std::lock_guard<std::mutex> guard(this->state_lock);
+        this->stopping = true;
+    }
+
+    this->started.notify_all();
+    for (auto &thread : this->threads) thread.join();
+
+}
+
+inline size_t ploop_pool::
+size() const
+{
+
+    return this->participants;
+
+}
+
+template <class F> inline void ploop_pool::
+run(int64_t first, int64_t last, const F &body, int64_t grain)
+{
+
+    if (first >= last) return;
+    if (this->participants == 1 || inside())
+    {
+        F local = body;
+        for (int64_t iteration = first; iteration < last; ++iteration) local(iteration);
+        return;
+    }
+
+    std::lock_guard<std::mutex> exclusive(this->run_lock);
+
+    // Every participant runs its own copy of the body, so each has its own variables.
+    struct context_type
+    {
+        ploop_pool         *pool;
+        std::vector<F>      bodies;
+    } context = { this, std::vector<F>(this->participants, body) };
+
+    // The ranges start out as even shares of the chunks.
+    this->origin = first;
+    this->grain = grain > 0 ? grain : 1;
+    const int64_t chunks = (last - first + this->grain - 1) / this->grain;
+    for (size_t participant = 0; participant < this->participants; ++participant)
+    {
+        work_range &range = this->ranges[participant];
+        range.begin = std::min(last, first + this->grain * (chunks * int64_t(participant) / int64_t(this->participants)));
+        range.end = std::min(last, first + this->grain * (chunks * int64_t(participant + 1) / int64_t(this->participants)));
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(this->state_lock);
+        this->current.context = &context;
+        this->current.execute = [](void *pointer, size_t participant)
+        {
+            auto *context = static_cast<context_type*>(pointer);
+            F &local = context->bodies[participant];
+            int64_t iteration;
+            do
+            {
+                while (context->pool->take(participant, iteration)) local(iteration);
+            }
+            while (context->pool->steal(participant));
+        };
+        this->failure = nullptr;
+        this->active = this->participants;
+        this->generation++;
+    }
+
+    this->started.notify_all();
+    this->work(0);
+
+    std::unique_lock<std::mutex> guard(this->state_lock);
+    this->finished.wait(guard, [this] { return this->active == 0; });
+    if (this->failure != nullptr) std::rethrow_exception(this->failure);
+
+}
+
+inline void ploop_pool::
+work(size_t participant)
+{
+
+    inside() = true;
+    try
+    {
+        this->current.execute(this->current.context, participant);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> guard(this->state_lock);
+        if (this->failure == nullptr) this->failure = std::current_exception();
+    }
+    inside() = false;
+
+    std::lock_guard<std::mutex> guard(this->state_lock);
+    if (--this->active == 0) this->finished.notify_all();
+
+}
+
+inline bool ploop_pool::
+take(size_t participant, int64_t &iteration)
+{
+
+    work_range &range = this->ranges[participant];
+    std::lock_guard<std::mutex> guard(range.lock);
+    if (range.begin >= range.end) return false;
+    iteration = range.begin++;
+    return true;
+
+}
+
+inline bool ploop_pool::
+steal(size_t participant)
+{
+
+    // The range with the most left to give gives up its back half. Nobody else adds
+    // to an empty range, so the thief's own range can be refilled after the victim is
+    // unlocked.
+    while (true)
+    {
+
+        size_t victim = participant;
+        int64_t largest = 0;
+        for (size_t other = 0; other < this->participants; ++other)
+        {
+            if (other == participant) continue;
+            work_range &range = this->ranges[other];
+            std::lock_guard<std::mutex> guard(range.lock);
+            if (range.end - this->split(range.begin, range.end) > largest)
+            {
+                largest = range.end - this->split(range.begin, range.end);
+                victim = other;
+            }
+        }
+
+        if (victim == participant) return false;
+
+        int64_t begin, end;
+        {
+            work_range &range = this->ranges[victim];
+            std::lock_guard<std::mutex> guard(range.lock);
+            if (this->split(range.begin, range.end) >= range.end) continue;
+            end = range.end;
+            begin = this->split(range.begin, range.end);
+            range.end = begin;
+        }
+
+        work_range &own = this->ranges[participant];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.begin = begin;
+        own.end = end;
+        return true;
+
+    }
+
+}
+
+inline int64_t ploop_pool::
+split(int64_t begin, int64_t end) const
+{
+
+    // The middle, rounded up to the next chunk, so a chunk the owner has started
+    // stays with it.
+    const int64_t middle = begin + (end - begin) / 2 - this->origin;
+    return this->origin + (middle + this->grain - 1) / this->grain * this->grain;
+
+}
+
+inline void ploop_pool::
+worker(size_t participant)
+{
+
+    uint64_t seen = 0;
+    while (true)
+    {
+
+        {
+            std::unique_lock<std::mutex> guard(this->state_lock);
+            this->started.wait(guard, [&] { return this->stopping || this->generation != seen; });
+            if (this->stopping) return;
+            seen = this->generation;
+        }
+
+        this->work(participant);
+
+    }
+
+}
+
+// --- Shared Variables --------------------------------------------------------
+
+template <class T>
+class ploop_share
+{
+
+    public:
+        using element = T;
+
+        static inline element   gather(const T &value, int64_t) { return value; }
+        static inline void      merge(T &value, const element &slot, int64_t) { value = slot; }
+
+};
+
+template <class T>
+class ploop_share<std::vector<T>>
+{
+
+    public:
+        using element = T;
+
+        static inline element   gather(const std::vector<T> &value, int64_t index)
+        {
+            return index >= 0 && size_t(index) < value.size() ? value[index] : T();
+        }
+
+        static inline void      merge(std::vector<T> &value, const element &slot, int64_t index)
+        {
+            if (index >= 0 && size_t(index) < value.size()) value[index] = slot;
+        }
+
+};
+
+template <class T, size_t N>
+class ploop_share<dvector<T,N>>
+{
+
+    public:
+        using element = T;
+
+        static inline element   gather(const dvector<T,N> &value, int64_t index)
+        {
+            return index >= 0 && size_t(index) < N ? value[index] : T();
+        }
+
+        static inline void      merge(dvector<T,N> &value, const element &slot, int64_t index)
+        {
+            if (index >= 0 && size_t(index) < N) value[index] = slot;
+        }
+
+};
+
+template <class T, size_t D>
+class ploop_share<particle_bunch<T,D>>
+{
+
+    public:
+        using element = dvector<T,D>;
+
+        static inline element   gather(const particle_bunch<T,D> &value, int64_t index)
+        {
+            return index >= 0 && size_t(index) < value.size() ? value[index] : element();
+        }
+
+        static inline void      merge(particle_bunch<T,D> &value, const element &slot, int64_t index)
+        {
+            if (index >= 0 && size_t(index) < value.size()) value[index] = slot;
+        }
+
+};
+
+template <>
+class ploop_share<transfer_map>
+{
+
+    public:
+        using element = da;
+
+        static inline element   gather(const transfer_map &value, int64_t index)
+        {
+            return index >= 0 && size_t(index) < value.dimension() ? value[index] : da();
+        }
+
+        static inline void      merge(transfer_map &value, const element &slot, int64_t index)
+        {
+            if (index >= 0 && size_t(index) < value.dimension()) value[index] = slot;
+        }
+
+};
+
+template <class T>
+class ploop_gather
+{
+
+    public:
+        using element = typename ploop_share<T>::element;
+
+        inline              ploop_gather(int64_t first, int64_t last);
+
+        inline int64_t      grain() const;
+        inline void         store(int64_t iteration, const T &value);
+        inline void         merge(T &value) const;
+
+        inline typename ploop_share<T>::element& slot(int64_t iteration);
+
+    protected:
+        int64_t                                         first;
+        std::vector<typename ploop_share<T>::element>   slots;
+
+};
+
+template <class T> inline ploop_gather<T>::
+ploop_gather(int64_t first, int64_t last)
+    : first(first), slots(last > first ? size_t(last - first) : 0)
+{
+
+}
+
+template <class T> inline int64_t ploop_gather<T>::
+grain() const
+{
+
+    return 1;
+
+}
+
+template <class T> inline void ploop_gather<T>::
+store(int64_t iteration, const T &value)
+{
+
+    // Each slot is written by the one iteration it belongs to.
+    this->slots[size_t(iteration - this->first)] = ploop_share<T>::gather(value, iteration);
+
+}
+
+template <class T> inline void ploop_gather<T>::
+merge(T &value) const
+{
+
+    for (size_t slot = 0; slot < this->slots.size(); ++slot)
+        ploop_share<T>::merge(value, this->slots[slot], this->first + int64_t(slot));
+
+}
+
+template <class T> inline typename ploop_share<T>::element& ploop_gather<T>::
+slot(int64_t iteration)
+{
+
+    return this->slots[size_t(iteration - this->first)];
+
+}
+
+// --- Reductions --------------------------------------------------------------
+//
+// A loop that sums into a variable, or keeps its largest or smallest value, runs in
+// parallel as a reduction. Each iteration starts the variable over, from zero for a
+// sum and from its value before the loop for an extreme, and stores what it ends
+// with into the partial result of its chunk. The range is cut into at most 1024
+// chunks of equal size, and the loop runs with the chunk size as its grain, so each
+// chunk is accumulated by one thread, in iteration order. After the loop the partial
+// results are folded in a fixed tree, neighbours pairwise, then neighbouring pairs,
+// and so on, and the result into the variable. The chunks and the tree depend only
+// on the range, not on the thread count or on which thread stole what, so a floating
+// point sum rounds the same way on every run, and on one thread, as on many, and a
+// reduction never holds more than 1024 values however long the loop is.
+//
+
+class ploop_sum
+{
+
+    public:
+        template <class T> static inline T  start(const T &) { return T(); }
+        template <class T> static inline T  combine(const T &left, const T &right) { return T(left + right); }
+
+};
+
+class ploop_maximum
+{
+
+    public:
+        template <class T> static inline T  start(const T &initial) { return initial; }
+        template <class T> static inline T  combine(const T &left, const T &right) { return right > left ? right : left; }
+
+};
+
+class ploop_minimum
+{
+
+    public:
+        template <class T> static inline T  start(const T &initial) { return initial; }
+        template <class T> static inline T  combine(const T &left, const T &right) { return right < left ? right : left; }
+
+};
+
+template <class T, class R>
+class ploop_reduction
+{
+
+    public:
+        using element = T;
+
+        static constexpr int64_t    partial_limit = 1024;
+
+        inline              ploop_reduction(int64_t first, int64_t last, const T &initial);
+
+        inline const T&     start() const;
+        inline int64_t      grain() const;
+        inline void         store(int64_t iteration, const T &value);
+        inline void         merge(T &value);
+
+        inline element&     slot(int64_t iteration);
+
+    protected:
+        int64_t             first;
+        int64_t             chunk;
+        T                   initial;
+        std::vector<T>      partials;
+
+};
+
+template <class T, class R> inline ploop_reduction<T,R>::
+ploop_reduction(int64_t first, int64_t last, const T &initial)
+    : first(first), chunk(last > first ? (last - first + partial_limit - 1) / partial_limit : 1),
+      initial(R::start(initial)),
+      partials(last > first ? size_t((last - first + this->chunk - 1) / this->chunk) : 0, R::start(initial))
+{
+
+}
+
+template <class T, class R> inline const T& ploop_reduction<T,R>::
+start() const
+{
+
+    return this->initial;
+
+}
+
+template <class T, class R> inline int64_t ploop_reduction<T,R>::
+grain() const
+{
+
+    return this->chunk;
+
+}
+
+template <class T, class R> inline void ploop_reduction<T,R>::
+store(int64_t iteration, const T &value)
+{
+
+    T &partial = this->slot(iteration);
+    partial = R::combine(partial, value);
+
+}
+
+template <class T, class R> inline void ploop_reduction<T,R>::
+merge(T &value)
+{
+
+    // Folds in place, the partials hold the tree's inner results afterwards.
+    const size_t count = this->partials.size();
+    for (size_t width = 1; width < count; width *= 2)
+    {
+        for (size_t left = 0; left + width < count; left += 2 * width)
+            this->partials[left] = R::combine(this->partials[left], this->partials[left + width]);
+    }
+
+    if (count > 0) value = R::combine(value, this->partials[0]);
+
+}
+
+template <class T, class R> inline T& ploop_reduction<T,R>::
+slot(int64_t iteration)
+{
+
+    return this->partials[size_t((iteration - this->first) / this->chunk)];
+
+}
+
+// --- Loop Bounds -------------------------------------------------------------
+//
+// Generated loops with a constant step, and every parallel loop, count an int64_t
+// iterator up to a bound taken once before the loop, which gives the compiler a trip
+// count it can vectorize against. The iterator runs while it's below the end, so a
+// real end is rounded up, I < 7.5 runs to 7.
+//
+
+template <class T> inline int64_t
+loop_bound(const T &end)
+{
+
+    if constexpr (std::is_floating_point<T>::value)
+        return int64_t(std::ceil(end));
+    else
+        return int64_t(end);
+
+}
+
+template <class F> inline void
+ploop_run(int64_t first, int64_t last, const F &body, int64_t grain = 1)
+{
+
+    ploop_pool::instance().run(first, last, body, grain);
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+#if defined(SF_POOL_UNIT_TEST) && SF_POOL_UNIT_TEST == 1
+#include <iostream>
+#include "pool.hpp"
+#include "da.hpp"
+
+bool verify_pool()
+{
+
+    buffer_pool *pool = buffer_pool_local();
+    bool passed = pool != nullptr;
+
+    // A freed buffer is the next one handed out of its class, and buffers are aligned.
+    void *first = pool->acquire(1000);
+    pool->release(first, 1000);
+    void *second = pool->acquire(1024);
+    passed = passed && first == second && reinterpret_cast<uintptr_t>(second) % 64 == 0;
+    pool->release(second, 1024);
+
+    // After a warm-up iteration, a DA computation makes no system allocations at all.
+    da_initialize(6, 4, 0);
+    const da x = da_variable(1);
+    const da y = da_variable(2);
+    da state = x + y;
+    buffer_pool_statistics warm = { };
+    for (int iteration = 0; iteration < 200; ++iteration)
+    {
+        if (iteration == 1) warm = buffer_pool_counters();
+        state = state * (1.0 - 0.01 * x * y) + 0.5 * da_derive(state, 1) - y;
+    }
+
+    // Every warm iteration's temporaries come back out of the pool.
+    const buffer_pool_statistics counters = buffer_pool_counters();
+    passed = passed && counters.system_allocations == warm.system_allocations &&
+        counters.recycled - warm.recycled >= 199 * 4;
+    std::cout << "    " << counters.system_allocations << " system allocations, " << counters.recycled
+              << " recycled, " << counters.cached_bytes << " bytes cached" << std::endl;
+    return passed;
+
+}
+
+int
+main()
+{
+
+    std::cout << "Buffer pool:" << std::endl;
+    const bool pool_passed = verify_pool();
+    std::cout << "Pool check: " << (pool_passed ? "passed" : "FAILED") << std::endl;
+
+    return pool_passed ? 0 : 1;
+
+}
+
+#endif
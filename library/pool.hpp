@@ -0,0 +1,235 @@
+#ifndef SIGAMFOX_LIBRARY_POOL_HPP
+#define SIGAMFOX_LIBRARY_POOL_HPP
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+// --- Buffer Pool -------------------------------------------------------------
+//
+// DA vectors, and dvectors in heap storage mode, are made and dropped constantly as
+// temporaries. The buffer pool keeps the coefficient buffers they free and hands
+// them back out, so after the first few iterations of a computation its allocations
+// are served without going to the system at all.
+//
+// Each thread has its own pool, so nothing is locked. Requests are rounded up to a
+// power of two size class of at least 64 bytes, and each class keeps its free buffers
+// in a list threaded through the buffers themselves. The list is last in, first out,
+// so the next request gets the buffer freed most recently, the one most likely still
+// in cache. A buffer freed on another thread joins that thread's pool.
+//
+// Requests above the largest class go to the system directly, as do frees once a
+// pool holds cache_limit bytes, which bounds what a pool can keep hold of. Every
+// buffer is 64 byte aligned, what the dvector kernels expect.
+//
+
+class buffer_pool_statistics
+{
+
+    public:
+        size_t  system_allocations;
+        size_t  system_releases;
+        size_t  recycled;
+        size_t  returned;
+        size_t  cached_bytes;
+
+};
+
+class buffer_pool
+{
+
+    public:
+        inline              buffer_pool(bool &finished);
+        inline             ~buffer_pool();
+
+                            buffer_pool(const buffer_pool&) = delete;
+        buffer_pool&        operator=(const buffer_pool&) = delete;
+
+        inline void*        acquire(size_t bytes);
+        inline void         release(void *block, size_t bytes);
+
+        inline const buffer_pool_statistics& statistics() const;
+        static inline size_t    block_bytes(size_t bytes);
+
+    public:
+        static constexpr size_t alignment       = 64;
+        static constexpr size_t smallest_class  = 6;
+        static constexpr size_t class_count     = 21;
+        static constexpr size_t cache_limit     = size_t(256) << 20;
+
+    protected:
+        static inline size_t    size_class(size_t bytes);
+
+    protected:
+        struct free_block { free_block *next; };
+
+        free_block             *free_lists[class_count];
+        buffer_pool_statistics  counters;
+        bool                   *finished;
+
+};
+
+inline buffer_pool*
+buffer_pool_local()
+{
+
+    // The flag outlives the pool, so buffers freed by static destructors after the
+    // thread's pool is gone go straight back to the system.
+    thread_local bool finished = false;
+    if (finished) return nullptr;
+    thread_local buffer_pool pool(finished);
+    return &pool;
+
+}
+
+inline buffer_pool_statistics
+buffer_pool_counters()
+{
+
+    buffer_pool *pool = buffer_pool_local();
+    return pool != nullptr ? pool->statistics() : buffer_pool_statistics{};
+
+}
+
+inline buffer_pool::
+buffer_pool(bool &finished)
+    : counters{}, finished(&finished)
+{
+
+    for (size_t c = 0; c < class_count; ++c) this->free_lists[c] = nullptr;
+
+}
+
+inline buffer_pool::
+~buffer_pool()
+{
+
+    for (size_t c = 0; c < class_count; ++c)
+    {
+        while (this->free_lists[c] != nullptr)
+        {
+            free_block *block = this->free_lists[c];
+            this->free_lists[c] = block->next;
+            ::operator delete(static_cast<void*>(block), std::align_val_t(alignment));
+        }
+    }
+
+    *this->finished = true;
+
+}
+
+inline size_t buffer_pool::
+size_class(size_t bytes)
+{
+
+    size_t size_class = 0;
+    while ((size_t(1) << (size_class + smallest_class)) < bytes) ++size_class;
+    return size_class;
+
+}
+
+inline size_t buffer_pool::
+block_bytes(size_t bytes)
+{
+
+    const size_t index = size_class(bytes);
+    return index < class_count ? size_t(1) << (index + smallest_class) : bytes;
+
+}
+
+inline void* buffer_pool::
+acquire(size_t bytes)
+{
+
+    const size_t index = size_class(bytes);
+    if (index >= class_count)
+    {
+        this->counters.system_allocations++;
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    free_block *block = this->free_lists[index];
+    if (block != nullptr)
+    {
+        this->free_lists[index] = block->next;
+        this->counters.recycled++;
+        this->counters.cached_bytes -= size_t(1) << (index + smallest_class);
+        return static_cast<void*>(block);
+    }
+
+    this->counters.system_allocations++;
+    return ::operator new(size_t(1) << (index + smallest_class), std::align_val_t(alignment));
+
+}
+
+inline void buffer_pool::
+release(void *block, size_t bytes)
+{
+
+    const size_t index = size_class(bytes);
+    const size_t class_bytes = size_t(1) << (index + smallest_class);
+    if (index >= class_count || this->counters.cached_bytes + class_bytes > cache_limit)
+    {
+        this->counters.system_releases++;
+        ::operator delete(block, std::align_val_t(alignment));
+        return;
+    }
+
+    free_block *freed = static_cast<free_block*>(block);
+    freed->next = this->free_lists[index];
+    this->free_lists[index] = freed;
+    this->counters.returned++;
+    this->counters.cached_bytes += class_bytes;
+
+}
+
+inline const buffer_pool_statistics& buffer_pool::
+statistics() const
+{
+
+    return this->counters;
+
+}
+
+// --- Pool Allocator ----------------------------------------------------------
+
+template <class T>
+class pool_allocator
+{
+
+    public:
+        using value_type = T;
+        template <class U> struct rebind { using other = pool_allocator<U>; };
+
+    public:
+        inline          pool_allocator() = default;
+        template <class U>
+        inline          pool_allocator(const pool_allocator<U> &) { }
+
+        inline T*       allocate(size_t count)
+        {
+            // Without a pool the block is still rounded to its class, it may be freed
+            // into another thread's pool and handed out again at the class size.
+            buffer_pool *pool = buffer_pool_local();
+            if (pool == nullptr)
+                return static_cast<T*>(::operator new(buffer_pool::block_bytes(count * sizeof(T)),
+                            std::align_val_t(buffer_pool::alignment)));
+            return static_cast<T*>(pool->acquire(count * sizeof(T)));
+        }
+
+        inline void     deallocate(T *ptr, size_t count)
+        {
+            buffer_pool *pool = buffer_pool_local();
+            if (pool == nullptr)
+                ::operator delete(static_cast<void*>(ptr), std::align_val_t(buffer_pool::alignment));
+            else
+                pool->release(static_cast<void*>(ptr), count * sizeof(T));
+        }
+
+        template <class U>
+        inline bool     operator==(const pool_allocator<U> &) const { return true; }
+        template <class U>
+        inline bool     operator!=(const pool_allocator<U> &) const { return false; }
+
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef SIGAMFOX_LIBRARY_POWER_HPP
+#define SIGAMFOX_LIBRARY_POWER_HPP
+#include <cstdint>
+#include <type_traits>
+#include "dvector.hpp"
+#include "interval.hpp"
+#include "complex.hpp"
+#include "transcendental.hpp"
+
+// --- Constant Powers ---------------------------------------------------------
+//
+// The generator turns x^n with a literal integer exponent into ipow<n>(x), and a
+// literal half-integer exponent into ipow_half<2n>(x), rather than std::pow. The
+// exponent is a template argument, so the power unrolls at compile time into the
+// shortest chain of squarings: x^2 is one multiply, x^3 two, and x^8 three. A
+// negative power is one division by the positive power.
+//
+// Anything with a multiply works for ipow, so it covers reals, dvectors and particles
+// element-wise, DA vectors, complex values and intervals. ipow_half also needs a
+// math_sqrt, which reals, dvectors, complex values and intervals have and DA vectors
+// don't, so the evaluator only lets a DA through with a whole, non-negative power.
+// Integers are raised as doubles, like std::pow would. A dvector expression is
+// evaluated once into a dvector before the chain starts, so every factor reads the
+// same values.
+//
+
+template <class T, class = void>
+struct ipow_value
+{
+    using type = std::conditional_t<std::is_integral_v<T>, double, T>;
+};
+
+template <class T>
+struct ipow_value<T, std::enable_if_t<std::is_base_of_v<dvector_expression<T>, T>>>
+{
+    using type = dvector<typename T::value_type, T::length>;
+};
+
+template <uint64_t N, class T> inline T
+ipow_positive(const T &x)
+{
+
+    if constexpr (N == 1)
+    {
+        return x;
+    }
+    else
+    {
+        const T half = ipow_positive<N / 2>(x);
+        if constexpr (N % 2 == 0) return half * half;
+        else return half * half * x;
+    }
+
+}
+
+template <int64_t N, class T> inline typename ipow_value<T>::type
+ipow(const T &base)
+{
+
+    using value = typename ipow_value<T>::type;
+    const value x = base;
+
+    // x^0 is one whatever x is, infinities and NaN included, as std::pow has it.
+    if constexpr (N == 0)
+    {
+        if constexpr (std::is_base_of_v<dvector_expression<value>, value>) return value() += 1.0;
+        else return value(1.0);
+    }
+    else if constexpr (N > 0) return ipow_positive<uint64_t(N)>(x);
+    else return 1.0 / ipow_positive<uint64_t(-N)>(x);
+
+}
+
+// x^(N/2) for odd N, an integer power times one square root.
+template <int64_t N, class T> inline typename ipow_value<T>::type
+ipow_half(const T &base)
+{
+
+    static_assert(N % 2 != 0, "ipow_half takes an odd number of halves, use ipow otherwise.");
+
+    using value = typename ipow_value<T>::type;
+    const value x = base;
+    constexpr int64_t whole = (N < 0 ? -N : N) / 2;
+
+    value root = math_sqrt(x);
+    if constexpr (whole != 0) root = ipow<whole>(x) * root;
+    if constexpr (N < 0) return 1.0 / root;
+    else return root;
+
+}
+
+#endif
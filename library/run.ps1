@@ -1 +1,11 @@
-./dvector.exe 10000
+./dvector_inline.exe 10000
+$env:SF_SIMD_ISA="sse2"; ./dvector_inline.exe 10000
+$env:SF_SIMD_ISA="scalar"; ./dvector_inline.exe 10000
+Remove-Item Env:SF_SIMD_ISA
+./dvector_heap.exe 10000
+foreach ($check in "bunch", "da", "map", "elements", "interval", "complex", "transcendental", "pool", "ploop", "transport") {
+    & "./$($check)_inline.exe"
+    $env:SF_SIMD_ISA="scalar"; & "./$($check)_inline.exe"
+    Remove-Item Env:SF_SIMD_ISA
+    & "./$($check)_heap.exe"
+}
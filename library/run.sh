@@ -0,0 +1,9 @@
+./dvector_inline 10000
+SF_SIMD_ISA=sse2 ./dvector_inline 10000
+SF_SIMD_ISA=scalar ./dvector_inline 10000
+./dvector_heap 10000
+for check in bunch da map elements interval complex transcendental pool ploop transport; do
+    ./${check}_inline
+    SF_SIMD_ISA=scalar ./${check}_inline
+    ./${check}_heap
+done
@@ -0,0 +1,406 @@
+#ifndef SIGAMFOX_LIBRARY_SIMD_HPP
+#define SIGAMFOX_LIBRARY_SIMD_HPP
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+// --- SIMD Runtime Dispatch ---------------------------------------------------
+//
+// Generated projects are built once and then run on whatever nodes are available,
+// so the SIMD paths can't be picked with compiler flags. Instead, every kernel is
+// compiled for each instruction set we support and the widest one the processor
+// and operating system can actually run is chosen once, at first use.
+//
+// The per-ISA code is compiled inside a target region, which tells GCC and Clang
+// to allow the wider intrinsics in that section of the file without raising the
+// baseline for the rest of the program. MSVC doesn't need this; it allows any
+// intrinsic anywhere.
+//
+// Setting the SF_SIMD_ISA environment variable to scalar, sse2, avx2, or avx512
+// caps the selection, which is useful for comparing paths on a single machine. It
+// never selects something the processor doesn't support. Defining SF_SIMD_DISABLE=1
+// compiles the intrinsic paths out entirely.
+//
+
+#if !defined(SF_SIMD_DISABLE)
+#   define SF_SIMD_DISABLE 0
+#endif
+
+#if SF_SIMD_DISABLE == 0 && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#   define SF_SIMD_X86 1
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#   endif
+#else
+#   define SF_SIMD_X86 0
+#endif
+
+// Every region for a given instruction set has to name the same target, otherwise
+// GCC won't inline the lane traits into the kernels built on top of them.
+#define SF_TARGET_SSE2      "sse2"
+#define SF_TARGET_AVX2      "avx2,fma"
+#define SF_TARGET_AVX512    "avx512f"
+
+#define SF_SIMD_STRINGIFY(x) #x
+#if defined(_MSC_VER) && !defined(__clang__)
+#   define SF_TARGET_REGION(isa)
+#   define SF_UNTARGET_REGION
+#elif defined(__clang__)
+#   define SF_TARGET_REGION(isa) \
+        _Pragma(SF_SIMD_STRINGIFY(clang attribute push(__attribute__((target(isa))), apply_to = function)))
+#   define SF_UNTARGET_REGION _Pragma("clang attribute pop")
+#else
+#   define SF_TARGET_REGION(isa) \
+        _Pragma("GCC push_options") _Pragma(SF_SIMD_STRINGIFY(GCC target(isa)))
+#   define SF_UNTARGET_REGION _Pragma("GCC pop_options")
+#endif
+
+enum class simd_isa
+{
+    ISA_SCALAR,
+    ISA_SSE2,
+    ISA_AVX2,
+    ISA_AVX512,
+};
+
+enum class simd_op
+{
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+};
+
+inline const char*
+simd_isa_name(simd_isa isa)
+{
+
+    switch (isa)
+    {
+        case simd_isa::ISA_SCALAR:  return "scalar";
+        case simd_isa::ISA_SSE2:    return "sse2";
+        case simd_isa::ISA_AVX2:    return "avx2";
+        case simd_isa::ISA_AVX512:  return "avx512";
+    }
+
+    return "unknown";
+
+}
+
+#if SF_SIMD_X86
+
+inline void
+simd_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+
+#   if defined(_MSC_VER)
+        int result[4];
+        __cpuidex(result, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (int i = 0; i < 4; ++i) registers[i] = static_cast<uint32_t>(result[i]);
+#   else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#   endif
+
+}
+
+inline uint64_t
+simd_xgetbv()
+{
+
+#   if defined(_MSC_VER)
+        return _xgetbv(0);
+#   else
+        uint32_t low, high;
+        __asm__ volatile ("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (static_cast<uint64_t>(high) << 32) | low;
+#   endif
+
+}
+
+#endif
+
+inline simd_isa
+simd_detect_isa()
+{
+
+#   if SF_SIMD_X86
+
+        uint32_t registers[4] = { };
+        simd_cpuid(0, 0, registers);
+        const uint32_t max_leaf = registers[0];
+
+        simd_cpuid(1, 0, registers);
+        const bool sse2     = (registers[3] >> 26) & 1;
+        const bool osxsave  = (registers[2] >> 27) & 1;
+        const bool avx      = (registers[2] >> 28) & 1;
+        const bool fma      = (registers[2] >> 12) & 1;
+        if (!sse2) return simd_isa::ISA_SCALAR;
+
+        // The processor supporting AVX isn't enough, the OS has to save the wider
+        // registers on a context switch or their upper halves get clobbered.
+        const uint64_t xcr0 = osxsave ? simd_xgetbv() : 0;
+        const bool ymm_state = (xcr0 & 0x06) == 0x06;
+        const bool zmm_state = (xcr0 & 0xE6) == 0xE6;
+
+        bool avx2       = false;
+        bool avx512f    = false;
+        if (max_leaf >= 7)
+        {
+            simd_cpuid(7, 0, registers);
+            avx2    = (registers[1] >> 5) & 1;
+            avx512f = (registers[1] >> 16) & 1;
+        }
+
+        if (avx512f && zmm_state) return simd_isa::ISA_AVX512;
+        // The AVX2 kernels lean on FMA, which every AVX2 part we know of has anyway.
+        if (avx && avx2 && fma && ymm_state) return simd_isa::ISA_AVX2;
+        return simd_isa::ISA_SSE2;
+
+#   else
+
+        return simd_isa::ISA_SCALAR;
+
+#   endif
+
+}
+
+inline simd_isa
+simd_active_isa()
+{
+
+    static const simd_isa active = []
+    {
+
+        simd_isa detected = simd_detect_isa();
+        const char *requested = std::getenv("SF_SIMD_ISA");
+        if (requested == nullptr) return detected;
+
+        simd_isa cap = detected;
+        if (std::strcmp(requested, "scalar") == 0)      cap = simd_isa::ISA_SCALAR;
+        else if (std::strcmp(requested, "sse2") == 0)   cap = simd_isa::ISA_SSE2;
+        else if (std::strcmp(requested, "avx2") == 0)   cap = simd_isa::ISA_AVX2;
+        else if (std::strcmp(requested, "avx512") == 0) cap = simd_isa::ISA_AVX512;
+
+        return cap < detected ? cap : detected;
+
+    }();
+
+    return active;
+
+}
+
+// --- SIMD Lanes --------------------------------------------------------------
+//
+// Each instruction set gets a namespace with a lanes<T> trait that wraps the load,
+// store, broadcast, arithmetic, min/max, and comparison intrinsics for float and
+// double. The aligned loads and stores expect an address aligned to the register
+// width. SSE2 has no fused multiply-add, so its fmadd is a multiply followed by an
+// add. Comparisons return the instruction set's native mask, a register for SSE2
+// and AVX2 and a mask register for AVX-512, which movemask flattens to one bit per
+// lane. Kernels written against lanes<T> can then be stamped out once per namespace.
+// They have to be defined inside the same target region as the trait, since GCC
+// refuses to inline a wider intrinsic into a function compiled for a narrower target.
+//
+// lanes<double> also has the few operations the math kernels in transcendental.hpp
+// build on: square root, rounding to the nearest integer, a per-lane select, and
+// pow2, which makes 2^k for integral k between -1022 and 1023 directly in the
+// exponent bits. SSE2 can't round, so it adds and subtracts 1.5 * 2^52, which
+// rounds exactly for magnitudes below 2^51.
+//
+
+#if SF_SIMD_X86
+
+SF_TARGET_REGION(SF_TARGET_SSE2)
+namespace simd_sse2
+{
+
+    template <class T> struct lanes;
+
+    template <> struct lanes<double>
+    {
+        using reg = __m128d;
+        using mask = reg;
+        static constexpr size_t width = 2;
+        static inline reg load(const double *p)            { return _mm_loadu_pd(p); }
+        static inline void store(double *p, reg v)         { _mm_storeu_pd(p, v); }
+        static inline reg load_aligned(const double *p)    { return _mm_load_pd(p); }
+        static inline void store_aligned(double *p, reg v) { _mm_store_pd(p, v); }
+        static inline reg set1(double v)                   { return _mm_set1_pd(v); }
+        static inline reg add(reg a, reg b)                { return _mm_add_pd(a, b); }
+        static inline reg sub(reg a, reg b)                { return _mm_sub_pd(a, b); }
+        static inline reg mul(reg a, reg b)                { return _mm_mul_pd(a, b); }
+        static inline reg div(reg a, reg b)                { return _mm_div_pd(a, b); }
+        static inline reg min(reg a, reg b)                { return _mm_min_pd(a, b); }
+        static inline reg max(reg a, reg b)                { return _mm_max_pd(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c)       { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        static inline reg abs(reg a)                       { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+        static inline mask cmp_eq(reg a, reg b)            { return _mm_cmpeq_pd(a, b); }
+        static inline mask cmp_lt(reg a, reg b)            { return _mm_cmplt_pd(a, b); }
+        static inline mask cmp_unord(reg a, reg b)         { return _mm_cmpunord_pd(a, b); }
+        static inline uint32_t movemask(mask m)            { return static_cast<uint32_t>(_mm_movemask_pd(m)); }
+        static inline reg sqrt(reg a)                      { return _mm_sqrt_pd(a); }
+        static inline reg round(reg a)                     { const reg m = _mm_set1_pd(6755399441055744.0);
+                                                             return _mm_sub_pd(_mm_add_pd(a, m), m); }
+        static inline reg select(mask m, reg a, reg b)     { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+        static inline reg pow2(reg k)                      { const reg biased = _mm_add_pd(k, _mm_set1_pd(4503599627371519.0));
+                                                             return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(biased), 52)); }
+    };
+
+    template <> struct lanes<float>
+    {
+        using reg = __m128;
+        using mask = reg;
+        static constexpr size_t width = 4;
+        static inline reg load(const float *p)             { return _mm_loadu_ps(p); }
+        static inline void store(float *p, reg v)          { _mm_storeu_ps(p, v); }
+        static inline reg load_aligned(const float *p)     { return _mm_load_ps(p); }
+        static inline void store_aligned(float *p, reg v)  { _mm_store_ps(p, v); }
+        static inline reg set1(float v)                    { return _mm_set1_ps(v); }
+        static inline reg add(reg a, reg b)                { return _mm_add_ps(a, b); }
+        static inline reg sub(reg a, reg b)                { return _mm_sub_ps(a, b); }
+        static inline reg mul(reg a, reg b)                { return _mm_mul_ps(a, b); }
+        static inline reg div(reg a, reg b)                { return _mm_div_ps(a, b); }
+        static inline reg min(reg a, reg b)                { return _mm_min_ps(a, b); }
+        static inline reg max(reg a, reg b)                { return _mm_max_ps(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c)       { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static inline reg abs(reg a)                       { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static inline mask cmp_eq(reg a, reg b)            { return _mm_cmpeq_ps(a, b); }
+        static inline mask cmp_lt(reg a, reg b)            { return _mm_cmplt_ps(a, b); }
+        static inline mask cmp_unord(reg a, reg b)         { return _mm_cmpunord_ps(a, b); }
+        static inline uint32_t movemask(mask m)            { return static_cast<uint32_t>(_mm_movemask_ps(m)); }
+    };
+
+}
+SF_UNTARGET_REGION
+
+SF_TARGET_REGION(SF_TARGET_AVX2)
+namespace simd_avx2
+{
+
+    template <class T> struct lanes;
+
+    template <> struct lanes<double>
+    {
+        using reg = __m256d;
+        using mask = reg;
+        static constexpr size_t width = 4;
+        static inline reg load(const double *p)            { return _mm256_loadu_pd(p); }
+        static inline void store(double *p, reg v)         { _mm256_storeu_pd(p, v); }
+        static inline reg load_aligned(const double *p)    { return _mm256_load_pd(p); }
+        static inline void store_aligned(double *p, reg v) { _mm256_store_pd(p, v); }
+        static inline reg set1(double v)                   { return _mm256_set1_pd(v); }
+        static inline reg add(reg a, reg b)                { return _mm256_add_pd(a, b); }
+        static inline reg sub(reg a, reg b)                { return _mm256_sub_pd(a, b); }
+        static inline reg mul(reg a, reg b)                { return _mm256_mul_pd(a, b); }
+        static inline reg div(reg a, reg b)                { return _mm256_div_pd(a, b); }
+        static inline reg min(reg a, reg b)                { return _mm256_min_pd(a, b); }
+        static inline reg max(reg a, reg b)                { return _mm256_max_pd(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c)       { return _mm256_fmadd_pd(a, b, c); }
+        static inline reg abs(reg a)                       { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+        static inline mask cmp_eq(reg a, reg b)            { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+        static inline mask cmp_lt(reg a, reg b)            { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+        static inline mask cmp_unord(reg a, reg b)         { return _mm256_cmp_pd(a, b, _CMP_UNORD_Q); }
+        static inline uint32_t movemask(mask m)            { return static_cast<uint32_t>(_mm256_movemask_pd(m)); }
+        static inline reg sqrt(reg a)                      { return _mm256_sqrt_pd(a); }
+        static inline reg round(reg a)                     { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static inline reg select(mask m, reg a, reg b)     { return _mm256_blendv_pd(b, a, m); }
+        static inline reg pow2(reg k)                      { const reg biased = _mm256_add_pd(k, _mm256_set1_pd(4503599627371519.0));
+                                                             return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(biased), 52)); }
+    };
+
+    template <> struct lanes<float>
+    {
+        using reg = __m256;
+        using mask = reg;
+        static constexpr size_t width = 8;
+        static inline reg load(const float *p)             { return _mm256_loadu_ps(p); }
+        static inline void store(float *p, reg v)          { _mm256_storeu_ps(p, v); }
+        static inline reg load_aligned(const float *p)     { return _mm256_load_ps(p); }
+        static inline void store_aligned(float *p, reg v)  { _mm256_store_ps(p, v); }
+        static inline reg set1(float v)                    { return _mm256_set1_ps(v); }
+        static inline reg add(reg a, reg b)                { return _mm256_add_ps(a, b); }
+        static inline reg sub(reg a, reg b)                { return _mm256_sub_ps(a, b); }
+        static inline reg mul(reg a, reg b)                { return _mm256_mul_ps(a, b); }
+        static inline reg div(reg a, reg b)                { return _mm256_div_ps(a, b); }
+        static inline reg min(reg a, reg b)                { return _mm256_min_ps(a, b); }
+        static inline reg max(reg a, reg b)                { return _mm256_max_ps(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c)       { return _mm256_fmadd_ps(a, b, c); }
+        static inline reg abs(reg a)                       { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static inline mask cmp_eq(reg a, reg b)            { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+        static inline mask cmp_lt(reg a, reg b)            { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static inline mask cmp_unord(reg a, reg b)         { return _mm256_cmp_ps(a, b, _CMP_UNORD_Q); }
+        static inline uint32_t movemask(mask m)            { return static_cast<uint32_t>(_mm256_movemask_ps(m)); }
+    };
+
+}
+SF_UNTARGET_REGION
+
+SF_TARGET_REGION(SF_TARGET_AVX512)
+namespace simd_avx512
+{
+
+    template <class T> struct lanes;
+
+    template <> struct lanes<double>
+    {
+        using reg = __m512d;
+        using mask = __mmask8;
+        static constexpr size_t width = 8;
+        static inline reg load(const double *p)            { return _mm512_loadu_pd(p); }
+        static inline void store(double *p, reg v)         { _mm512_storeu_pd(p, v); }
+        static inline reg load_aligned(const double *p)    { return _mm512_load_pd(p); }
+        static inline void store_aligned(double *p, reg v) { _mm512_store_pd(p, v); }
+        static inline reg set1(double v)                   { return _mm512_set1_pd(v); }
+        static inline reg add(reg a, reg b)                { return _mm512_add_pd(a, b); }
+        static inline reg sub(reg a, reg b)                { return _mm512_sub_pd(a, b); }
+        static inline reg mul(reg a, reg b)                { return _mm512_mul_pd(a, b); }
+        static inline reg div(reg a, reg b)                { return _mm512_div_pd(a, b); }
+        static inline reg min(reg a, reg b)                { return _mm512_min_pd(a, b); }
+        static inline reg max(reg a, reg b)                { return _mm512_max_pd(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c)       { return _mm512_fmadd_pd(a, b, c); }
+        static inline reg abs(reg a)                       { return _mm512_abs_pd(a); }
+        static inline mask cmp_eq(reg a, reg b)            { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+        static inline mask cmp_lt(reg a, reg b)            { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+        static inline mask cmp_unord(reg a, reg b)         { return _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q); }
+        static inline uint32_t movemask(mask m)            { return static_cast<uint32_t>(m); }
+        static inline reg sqrt(reg a)                      { return _mm512_sqrt_pd(a); }
+        static inline reg round(reg a)                     { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT); }
+        static inline reg select(mask m, reg a, reg b)     { return _mm512_mask_blend_pd(m, b, a); }
+        static inline reg pow2(reg k)                      { const reg biased = _mm512_add_pd(k, _mm512_set1_pd(4503599627371519.0));
+                                                             return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(biased), 52)); }
+    };
+
+    template <> struct lanes<float>
+    {
+        using reg = __m512;
+        using mask = __mmask16;
+        static constexpr size_t width = 16;
+        static inline reg load(const float *p)             { return _mm512_loadu_ps(p); }
+        static inline void store(float *p, reg v)          { _mm512_storeu_ps(p, v); }
+        static inline reg load_aligned(const float *p)     { return _mm512_load_ps(p); }
+        static inline void store_aligned(float *p, reg v)  { _mm512_store_ps(p, v); }
+        static inline reg set1(float v)                    { return _mm512_set1_ps(v); }
+        static inline reg add(reg a, reg b)                { return _mm512_add_ps(a, b); }
+        static inline reg sub(reg a, reg b)                { return _mm512_sub_ps(a, b); }
+        static inline reg mul(reg a, reg b)                { return _mm512_mul_ps(a, b); }
+        static inline reg div(reg a, reg b)                { return _mm512_div_ps(a, b); }
+        static inline reg min(reg a, reg b)                { return _mm512_min_ps(a, b); }
+        static inline reg max(reg a, reg b)                { return _mm512_max_ps(a, b); }
+        static inline reg fmadd(reg a, reg b, reg c)       { return _mm512_fmadd_ps(a, b, c); }
+        static inline reg abs(reg a)                       { return _mm512_abs_ps(a); }
+        static inline mask cmp_eq(reg a, reg b)            { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+        static inline mask cmp_lt(reg a, reg b)            { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+        static inline mask cmp_unord(reg a, reg b)         { return _mm512_cmp_ps_mask(a, b, _CMP_UNORD_Q); }
+        static inline uint32_t movemask(mask m)            { return static_cast<uint32_t>(m); }
+    };
+
+}
+SF_UNTARGET_REGION
+
+#endif
+
+#endif
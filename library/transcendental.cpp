@@ -0,0 +1,91 @@
+#if defined(SF_TRANSCENDENTAL_UNIT_TEST) && SF_TRANSCENDENTAL_UNIT_TEST == 1
+#include <iostream>
+#include <vector>
+#include "transcendental.hpp"
+#include "benchmark.hpp"
+
+// Checks each math kernel at both accuracies against libm over a range of arguments,
+// including the odd lengths and out of range values that take the fallback paths, and
+// times the kernels against calling libm on every element.
+bool verify_math()
+{
+
+    constexpr size_t count = 4099;
+    constexpr size_t trials = 200;
+    const char *names[4] = { "sin", "cos", "exp", "sqrt" };
+    const double tolerances[2] = { 4e-16, 5e-8 };
+
+    std::vector<double> x(count), y(count), expected(count);
+    bool passed = true;
+    for (size_t f = 0; f < 4; ++f)
+    {
+
+        const math_function function = static_cast<math_function>(f);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const double t = double(i) / double(count);
+            x[i] = function == math_function::FUNCTION_EXP ? 1400.0 * t - 700.0 :
+                   function == math_function::FUNCTION_SQRT ? 1e3 * t : 200.0 * t - 100.0;
+            expected[i] = math_libm(function, x[i]);
+        }
+        x[count - 1] = 1e6;
+        expected[count - 1] = math_libm(function, x[count - 1]);
+
+        // sin and cos are compared absolutely, they pass through zero.
+        for (size_t a = 0; a < 2; ++a)
+        {
+            math_apply(function, y.data(), x.data(), count, static_cast<math_accuracy>(a));
+            for (size_t i = 0; i < count; ++i)
+            {
+                const double scale = f < 2 ? 1.0 : std::abs(expected[i]);
+                passed = passed && (y[i] == expected[i] || std::abs(y[i] - expected[i]) <= tolerances[a] * scale);
+            }
+        }
+
+        HighResolutionTimer timer;
+        timer.start();
+        for (size_t trial = 0; trial < trials; ++trial)
+        {
+            for (size_t i = 0; i < count; ++i) y[i] = math_libm(function, x[i]);
+            benchmark_sink = benchmark_sink + y[trial % count];
+        }
+        const double libm_time = timer.stop();
+
+        double kernel_times[2];
+        for (size_t a = 0; a < 2; ++a)
+        {
+            timer.start();
+            for (size_t trial = 0; trial < trials; ++trial)
+            {
+                math_apply(function, y.data(), x.data(), count, static_cast<math_accuracy>(a));
+                benchmark_sink = benchmark_sink + y[trial % count];
+            }
+            kernel_times[a] = timer.stop();
+        }
+
+        std::cout << "    " << names[f] << ": libm " << libm_time / trials * 1e6 << "us, full "
+                  << kernel_times[0] / trials * 1e6 << "us, fast " << kernel_times[1] / trials * 1e6
+                  << "us per " << count << " values" << std::endl;
+
+    }
+
+    dvector<double, 3> angles = { 0.0, 1.0, -2.5 };
+    const dvector<double, 3> sines = math_sin(angles * 2.0);
+    passed = passed && std::abs(sines[2] - std::sin(-5.0)) < 1e-15 && math_sqrt(4.0) == 2.0;
+    return passed;
+
+}
+
+int
+main()
+{
+
+    std::cout << "Math kernels:" << std::endl;
+    const bool math_passed = verify_math();
+    std::cout << "Math check: " << (math_passed ? "passed" : "FAILED") << std::endl;
+
+    return math_passed ? 0 : 1;
+
+}
+
+#endif
@@ -0,0 +1,332 @@
+#ifndef SIGAMFOX_LIBRARY_TRANSCENDENTAL_HPP
+#define SIGAMFOX_LIBRARY_TRANSCENDENTAL_HPP
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "simd.hpp"
+#include "dvector.hpp"
+
+// --- Transcendental Kernels --------------------------------------------------
+//
+// Batched sin, cos, exp and sqrt over arrays of doubles: dvectors, particles, and
+// the columns of a bunch a chunk at a time. Calling libm on each element costs a
+// call and a scalar evaluation per value. These kernels evaluate a whole register of
+// values at once, with the same table of per-ISA kernels the dvector operations use,
+// see dvector.hpp.
+//
+// sin and cos reduce the argument by multiples of pi/2 in three parts, which is
+// exact for magnitudes up to 1e5. They then evaluate polynomials for sine and cosine
+// on [-pi/4, pi/4] and pick one and a sign by quadrant. exp reduces by multiples of
+// ln 2 and scales the polynomial by 2^k through the exponent bits. sqrt is the
+// instruction, which is already exact.
+//
+// Accuracy is selectable per call:
+//
+//      ACCURACY_FULL   fdlibm's minimax polynomials for sin and cos, and a degree 13
+//                      series for exp, within a couple of ulp of libm.
+//      ACCURACY_FAST   shorter series, good to a few parts in 1e8, around half the
+//                      work. Plenty for tracking, not for a closed orbit search.
+//
+// The default is full. Setting the SF_MATH_ACCURACY environment variable to fast
+// changes it for the whole program, as SF_SIMD_ISA does for the instruction set.
+//
+// A register holding an argument outside the range the reduction is exact for, an
+// infinity or a NaN is handed to libm element by element. So is everything on a
+// machine without SIMD support. The scalar overloads call libm too, since a single
+// value gains nothing from a vector kernel.
+//
+
+enum class math_function
+{
+    FUNCTION_SIN,
+    FUNCTION_COS,
+    FUNCTION_EXP,
+    FUNCTION_SQRT,
+};
+
+enum class math_accuracy
+{
+    ACCURACY_FULL,
+    ACCURACY_FAST,
+};
+
+struct math_kernel_table
+{
+    void (*kernels[4][2])(double *dst, const double *src, size_t count);
+};
+
+inline double
+math_libm(math_function function, double x)
+{
+
+    switch (function)
+    {
+        case math_function::FUNCTION_SIN:   return std::sin(x);
+        case math_function::FUNCTION_COS:   return std::cos(x);
+        case math_function::FUNCTION_EXP:   return std::exp(x);
+        case math_function::FUNCTION_SQRT:  return std::sqrt(x);
+    }
+
+    return x;
+
+}
+
+// The coefficients 1 / n! of the exponential's series up to degree D.
+template <size_t D>
+struct math_exp_series
+{
+    double coefficients[D + 1];
+
+    constexpr math_exp_series()
+        : coefficients()
+    {
+        double factorial = 1.0;
+        for (size_t n = 0; n <= D; ++n)
+        {
+            if (n > 1) factorial *= double(n);
+            this->coefficients[n] = 1.0 / factorial;
+        }
+    }
+};
+
+#define SF_MATH_DEFINE_KERNELS                                                              \
+    template <math_accuracy A> inline typename lanes<double>::reg                           \
+    math_lane_sine(typename lanes<double>::reg x, bool cosine)                              \
+    {                                                                                       \
+        using L = lanes<double>;                                                            \
+        using reg = typename L::reg;                                                        \
+        const reg q = L::round(L::mul(x, L::set1(6.36619772367581382433e-01)));             \
+        reg r = L::fmadd(q, L::set1(-1.57079632673412561417e+00), x);                       \
+        r = L::fmadd(q, L::set1(-6.07710050630396597660e-11), r);                           \
+        r = L::fmadd(q, L::set1(-2.02226624871116645580e-21), r);                           \
+        const reg z = L::mul(r, r);                                                         \
+                                                                                            \
+        reg s, c;                                                                           \
+        if constexpr (A == math_accuracy::ACCURACY_FULL)                                    \
+        {                                                                                   \
+            s = L::fmadd(z, L::set1(1.58969099521155010221e-10), L::set1(-2.50507602534068634195e-08)); \
+            s = L::fmadd(z, s, L::set1(2.75573137070700676789e-06));                        \
+            s = L::fmadd(z, s, L::set1(-1.98412698298579493134e-04));                       \
+            s = L::fmadd(z, s, L::set1(8.33333333332248946124e-03));                        \
+            s = L::fmadd(z, s, L::set1(-1.66666666666666324348e-01));                       \
+            c = L::fmadd(z, L::set1(-1.13596475577881948265e-11), L::set1(2.08757232129817482790e-09)); \
+            c = L::fmadd(z, c, L::set1(-2.75573143513906633035e-07));                       \
+            c = L::fmadd(z, c, L::set1(2.48015872894767294178e-05));                        \
+            c = L::fmadd(z, c, L::set1(-1.38888888888741095749e-03));                       \
+            c = L::fmadd(z, c, L::set1(4.16666666666666019037e-02));                        \
+        }                                                                                   \
+        else                                                                                \
+        {                                                                                   \
+            s = L::fmadd(z, L::set1(2.75573192239858906526e-06), L::set1(-1.98412698412698412698e-04)); \
+            s = L::fmadd(z, s, L::set1(8.33333333333333333333e-03));                        \
+            s = L::fmadd(z, s, L::set1(-1.66666666666666666667e-01));                       \
+            c = L::fmadd(z, L::set1(2.48015873015873015873e-05), L::set1(-1.38888888888888888889e-03)); \
+            c = L::fmadd(z, c, L::set1(4.16666666666666666667e-02));                        \
+        }                                                                                   \
+        s = L::fmadd(L::mul(z, r), s, r);                                                   \
+        c = L::fmadd(L::mul(z, z), c, L::fmadd(z, L::set1(-0.5), L::set1(1.0)));            \
+                                                                                            \
+        /* Quadrant q of the sine is quadrant q + 1 of the cosine. Even quadrants take */   \
+        /* the sine polynomial, and quadrants 2 and 3 mod 4 are negated. */                 \
+        const reg quadrant = cosine ? L::add(q, L::set1(1.0)) : q;                          \
+        const reg half = L::mul(quadrant, L::set1(0.5));                                    \
+        const reg nearest = L::round(half);                                                 \
+        const reg value = L::select(L::cmp_eq(nearest, half), s, c);                        \
+        const reg lower = L::select(L::cmp_lt(half, nearest), L::sub(nearest, L::set1(1.0)), nearest); \
+        const reg parity = L::mul(lower, L::set1(0.5));                                     \
+        return L::select(L::cmp_eq(L::round(parity), parity), value, L::sub(L::set1(0.0), value)); \
+    }                                                                                       \
+                                                                                            \
+    template <math_accuracy A> inline typename lanes<double>::reg                           \
+    math_lane_exp(typename lanes<double>::reg x)                                            \
+    {                                                                                       \
+        using L = lanes<double>;                                                            \
+        using reg = typename L::reg;                                                        \
+        const reg k = L::round(L::mul(x, L::set1(1.44269504088896338700e+00)));             \
+        reg r = L::fmadd(k, L::set1(-6.93147180369123816490e-01), x);                       \
+        r = L::fmadd(k, L::set1(-1.90821492927058770002e-10), r);                           \
+                                                                                            \
+        /* Taylor series of e^r for |r| <= ln(2) / 2, by Horner's rule. */                  \
+        constexpr size_t degree = A == math_accuracy::ACCURACY_FULL ? 13 : 7;               \
+        static constexpr math_exp_series<degree> series{};                                  \
+        reg p = L::set1(series.coefficients[degree]);                                       \
+        for (size_t n = degree; n > 0; --n) p = L::fmadd(p, r, L::set1(series.coefficients[n - 1])); \
+        return L::mul(p, L::pow2(k));                                                       \
+    }                                                                                       \
+                                                                                            \
+    template <math_function F, math_accuracy A> inline typename lanes<double>::reg          \
+    math_lane_apply(typename lanes<double>::reg x)                                          \
+    {                                                                                       \
+        if constexpr (F == math_function::FUNCTION_SIN) return math_lane_sine<A>(x, false);  \
+        else if constexpr (F == math_function::FUNCTION_COS) return math_lane_sine<A>(x, true); \
+        else if constexpr (F == math_function::FUNCTION_EXP) return math_lane_exp<A>(x);    \
+        else return lanes<double>::sqrt(x);                                                 \
+    }                                                                                       \
+                                                                                            \
+    template <math_function F, math_accuracy A> inline bool                                 \
+    math_lane_block(double *dst, const double *src)                                         \
+    {                                                                                       \
+        using L = lanes<double>;                                                            \
+        const typename L::reg x = L::load(src);                                             \
+        if constexpr (F != math_function::FUNCTION_SQRT)                                    \
+        {                                                                                   \
+            const double limit = F == math_function::FUNCTION_EXP ? 708.0 : 1e5;            \
+            const uint32_t inside = L::movemask(L::cmp_lt(L::abs(x), L::set1(limit)));      \
+            if (inside != (uint32_t(1) << L::width) - 1) return false;                      \
+        }                                                                                   \
+        L::store(dst, math_lane_apply<F, A>(x));                                            \
+        return true;                                                                        \
+    }                                                                                       \
+                                                                                            \
+    template <math_function F, math_accuracy A> inline void                                 \
+    math_kernel(double *dst, const double *src, size_t count)                               \
+    {                                                                                       \
+        constexpr size_t width = lanes<double>::width;                                      \
+        size_t i = 0;                                                                       \
+        for (; i + width <= count; i += width)                                              \
+        {                                                                                   \
+            if (math_lane_block<F, A>(dst + i, src + i)) continue;                          \
+            for (size_t j = i; j < i + width; ++j) dst[j] = math_libm(F, src[j]);           \
+        }                                                                                   \
+        if (i == count) return;                                                             \
+                                                                                            \
+        /* The tail goes through a full register too, so every element of a vector */      \
+        /* gets the same polynomial. */                                                     \
+        double in[width] = { }, out[width];                                                 \
+        std::memcpy(in, src + i, (count - i) * sizeof(double));                             \
+        if (math_lane_block<F, A>(out, in)) std::memcpy(dst + i, out, (count - i) * sizeof(double)); \
+        else for (size_t j = i; j < count; ++j) dst[j] = math_libm(F, src[j]);              \
+    }                                                                                       \
+                                                                                            \
+    inline math_kernel_table                                                                \
+    math_kernels()                                                                          \
+    {                                                                                       \
+        constexpr math_accuracy full = math_accuracy::ACCURACY_FULL;                        \
+        constexpr math_accuracy fast = math_accuracy::ACCURACY_FAST;                        \
+        math_kernel_table table;                                                            \
+        table.kernels[0][0] = &math_kernel<math_function::FUNCTION_SIN, full>;              \
+        table.kernels[0][1] = &math_kernel<math_function::FUNCTION_SIN, fast>;              \
+        table.kernels[1][0] = &math_kernel<math_function::FUNCTION_COS, full>;              \
+        table.kernels[1][1] = &math_kernel<math_function::FUNCTION_COS, fast>;              \
+        table.kernels[2][0] = &math_kernel<math_function::FUNCTION_EXP, full>;              \
+        table.kernels[2][1] = &math_kernel<math_function::FUNCTION_EXP, fast>;              \
+        table.kernels[3][0] = &math_kernel<math_function::FUNCTION_SQRT, full>;             \
+        table.kernels[3][1] = &math_kernel<math_function::FUNCTION_SQRT, fast>;             \
+        return table;                                                                       \
+    }
+
+namespace simd_scalar
+{
+
+    template <math_function F> inline void
+    math_kernel(double *dst, const double *src, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) dst[i] = math_libm(F, src[i]);
+    }
+
+    inline math_kernel_table
+    math_kernels()
+    {
+        math_kernel_table table;
+        table.kernels[0][0] = table.kernels[0][1] = &math_kernel<math_function::FUNCTION_SIN>;
+        table.kernels[1][0] = table.kernels[1][1] = &math_kernel<math_function::FUNCTION_COS>;
+        table.kernels[2][0] = table.kernels[2][1] = &math_kernel<math_function::FUNCTION_EXP>;
+        table.kernels[3][0] = table.kernels[3][1] = &math_kernel<math_function::FUNCTION_SQRT>;
+        return table;
+    }
+
+}
+
+#if SF_SIMD_X86
+
+SF_TARGET_REGION(SF_TARGET_SSE2)
+namespace simd_sse2 { SF_MATH_DEFINE_KERNELS }
+SF_UNTARGET_REGION
+
+SF_TARGET_REGION(SF_TARGET_AVX2)
+namespace simd_avx2 { SF_MATH_DEFINE_KERNELS }
+SF_UNTARGET_REGION
+
+SF_TARGET_REGION(SF_TARGET_AVX512)
+namespace simd_avx512 { SF_MATH_DEFINE_KERNELS }
+SF_UNTARGET_REGION
+
+#endif
+
+inline math_kernel_table
+math_kernels_for(simd_isa isa)
+{
+
+#   if SF_SIMD_X86
+        switch (isa)
+        {
+            case simd_isa::ISA_AVX512:  return simd_avx512::math_kernels();
+            case simd_isa::ISA_AVX2:    return simd_avx2::math_kernels();
+            case simd_isa::ISA_SSE2:    return simd_sse2::math_kernels();
+            default:                    break;
+        }
+#   endif
+
+    return simd_scalar::math_kernels();
+
+}
+
+inline const math_kernel_table&
+math_active_kernels()
+{
+
+    static const math_kernel_table table = math_kernels_for(simd_active_isa());
+    return table;
+
+}
+
+inline math_accuracy
+math_default_accuracy()
+{
+
+    static const math_accuracy accuracy = []
+    {
+        const char *requested = std::getenv("SF_MATH_ACCURACY");
+        if (requested != nullptr && std::strcmp(requested, "fast") == 0) return math_accuracy::ACCURACY_FAST;
+        return math_accuracy::ACCURACY_FULL;
+    }();
+
+    return accuracy;
+
+}
+
+// Applies the function to count values of src into dst, which may be src itself.
+inline void
+math_apply(math_function function, double *dst, const double *src, size_t count,
+        math_accuracy accuracy = math_default_accuracy())
+{
+
+    math_active_kernels().kernels[static_cast<size_t>(function)][static_cast<size_t>(accuracy)](dst, src, count);
+
+}
+
+template <math_function F, class E> inline dvector<double, E::length>
+math_apply(const dvector_expression<E> &argument, math_accuracy accuracy = math_default_accuracy())
+{
+
+    static_assert(std::is_same_v<typename E::value_type, double>, "The math kernels are double precision.");
+    dvector<double, E::length> result(argument);
+    math_apply(F, result.data(), result.data(), E::length, accuracy);
+    return result;
+
+}
+
+// --- COSY Functions ----------------------------------------------------------
+
+inline double math_sin(double x) { return std::sin(x); }
+inline double math_cos(double x) { return std::cos(x); }
+inline double math_exp(double x) { return std::exp(x); }
+inline double math_sqrt(double x) { return std::sqrt(x); }
+
+template <class E> inline auto math_sin(const dvector_expression<E> &x) { return math_apply<math_function::FUNCTION_SIN>(x); }
+template <class E> inline auto math_cos(const dvector_expression<E> &x) { return math_apply<math_function::FUNCTION_COS>(x); }
+template <class E> inline auto math_exp(const dvector_expression<E> &x) { return math_apply<math_function::FUNCTION_EXP>(x); }
+template <class E> inline auto math_sqrt(const dvector_expression<E> &x) { return math_apply<math_function::FUNCTION_SQRT>(x); }
+
+#endif
@@ -0,0 +1,121 @@
+#if defined(SF_TRANSPORT_UNIT_TEST) && SF_TRANSPORT_UNIT_TEST == 1
+#include <iostream>
+#include "transport.hpp"
+
+bool verify_transport()
+{
+
+#   if SF_PLOOP_PROCESSES == 0
+        return true;
+#   else
+    // Elements packed in worker processes come back whole, a DA vector included.
+    da_initialize(4, 2, 0);
+    ploop_transport_install(std::make_unique<ploop_shared_memory_transport>(4));
+
+    constexpr int64_t count = 40;
+    dvector<double, count> shared;
+    int64_t process = 0;
+    ploop_gather<dvector<double, count>> gather(0, count);
+    ploop_gather<int64_t> process_gather(0, count);
+    ploop_distribute(0, count, [=, &gather](int64_t i) mutable
+    {
+        double value = 0.0;
+        for (int64_t k = 0; k <= i * 1000; ++k) value += 1.0 / double(k + 1);
+        shared[i] = value;
+        gather.store(i, shared);
+    }, gather);
+    gather.merge(shared);
+
+    bool passed = true;
+    for (int64_t i = 0; i < count; ++i)
+    {
+        double expected = 0.0;
+        for (int64_t k = 0; k <= i * 1000; ++k) expected += 1.0 / double(k + 1);
+        passed = passed && shared[i] == expected;
+    }
+
+    const int64_t parent = int64_t(getpid());
+    int64_t square = 0;
+    ploop_gather<int64_t> square_gather(0, count);
+    ploop_distribute(0, count, [=, &process_gather, &square_gather](int64_t i) mutable
+    {
+        process = int64_t(getpid());
+        square = i * i;
+        process_gather.store(i, process);
+        square_gather.store(i, square);
+    }, process_gather, square_gather);
+    process_gather.merge(process);
+    square_gather.merge(square);
+    passed = passed && square == (count - 1) * (count - 1);
+
+    // A reduction's partials cross processes the way a gather's slots do, chunk by
+    // chunk, and fold to the same bits a single thread gets.
+    constexpr int64_t terms = 3001;
+    double total = 0.5, single_total = 0.5, expected_total = 0.5;
+    ploop_reduction<double, ploop_sum> total_reduction(0, terms, total);
+    ploop_distribute(0, terms, [=, &total_reduction](int64_t i) mutable
+    {
+        total = total_reduction.start();
+        total = total + 1.0 / double(i + 1);
+        total_reduction.store(i, total);
+    }, total_reduction);
+    total_reduction.merge(total);
+
+    ploop_pool single(1);
+    ploop_reduction<double, ploop_sum> single_reduction(0, terms, single_total);
+    single.run(0, terms, [=, &single_reduction](int64_t i) mutable
+    {
+        single_total = single_reduction.start();
+        single_total = single_total + 1.0 / double(i + 1);
+        single_reduction.store(i, single_total);
+    }, single_reduction.grain());
+    single_reduction.merge(single_total);
+
+    for (int64_t i = 0; i < terms; ++i) expected_total += 1.0 / double(i + 1);
+    passed = passed && total == single_total && std::fabs(total - expected_total) < 1e-12;
+
+    da polynomial;
+    const da x = da_variable(1);
+    ploop_gather<da> da_gather(0, 8);
+    ploop_distribute(0, 8, [=, &da_gather](int64_t i) mutable
+    {
+        polynomial = (1.0 + x) * double(i);
+        da_gather.store(i, polynomial);
+    }, da_gather);
+    da_gather.merge(polynomial);
+    passed = passed && polynomial[0] == 7.0 && polynomial.size() == x.size();
+
+    // Another transport slots in the same way, this one runs everything in place.
+    ploop_transport_install(std::make_unique<ploop_local_transport>());
+    int64_t local = 0;
+    ploop_gather<int64_t> local_gather(0, 4);
+    ploop_distribute(0, 4, [=, &local_gather](int64_t i) mutable
+    {
+        local = int64_t(getpid()) + i;
+        local_gather.store(i, local);
+    }, local_gather);
+    local_gather.merge(local);
+    passed = passed && local == parent + 3;
+
+    ploop_transport_install(std::make_unique<ploop_shared_memory_transport>(
+                ploop_shared_memory_transport::default_process_count()));
+    std::cout << "    4 processes, last iteration ran in "
+              << (process == parent ? "the caller" : "a worker") << std::endl;
+    return passed && process != 0;
+#   endif
+
+}
+
+int
+main()
+{
+
+    std::cout << "Process loop:" << std::endl;
+    const bool transport_passed = verify_transport();
+    std::cout << "Transport check: " << (transport_passed ? "passed" : "FAILED") << std::endl;
+
+    return transport_passed ? 0 : 1;
+
+}
+
+#endif
@@ -0,0 +1,489 @@
+#ifndef SIGAMFOX_LIBRARY_TRANSPORT_HPP
+#define SIGAMFOX_LIBRARY_TRANSPORT_HPP
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "dvector.hpp"
+#include "da.hpp"
+#include "ploop.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <sys/types.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#   define SF_PLOOP_PROCESSES 1
+#else
+#   define SF_PLOOP_PROCESSES 0
+#endif
+
+// --- Process Loop ------------------------------------------------------------
+//
+// A PLOOP generated with --ploop-processes fans its iterations out over processes
+// instead of threads, the way COSY runs it under MPI. The loop is the same as on the
+// thread pool, see ploop.hpp: a body that works on its own copy of the variables and
+// stores its element of the shared variable into a ploop_gather. What changes is
+// that the gather in a worker process isn't the caller's, so after each iteration
+// the element is packed into bytes and handed to a transport, and once the loop is
+// done the caller unpacks every iteration's bytes back into its own gather.
+//
+// A transport decides where iterations run and how their bytes come back. It gets
+// the range, a grain and the size of one slot, runs every iteration somewhere, every
+// chunk of grain iterations from the first in one place and in order, and when it
+// returns each iteration's slot has to be readable in the calling process. The
+// default one forks workers on this machine and shares slots through a POSIX shared
+// memory segment. Something like MPI fits the same contract, with every rank running
+// its part of the range and an allgather before execute() returns, and can be put in
+// place with ploop_transport_install().
+//
+// The shared memory transport forks SF_PLOOP_PROCESSES workers, one per core if it
+// isn't set, and the calling process takes iterations alongside them. Iterations are
+// handed out a chunk at a time through a counter in the segment, one at a time unless
+// a reduction asks for more, so a slow point doesn't hold up a fixed share of the
+// range. The segment is unlinked as soon as it's mapped,
+// nothing is left behind if the program dies. A fork that fails leaves its share of
+// the iterations to the others, and a worker that dies before finishing the one it
+// took makes the loop throw. A PLOOP inside a worker runs in order, as one on a
+// thread does.
+//
+// ploop_pack says how an element becomes bytes. Every element of a share variable is
+// the same size, its size is taken from an element the gather made. Anything trivially
+// copyable is copied as is, dvectors by component and DA vectors by coefficient. A
+// loop with several shared variables packs one element of each into every slot.
+//
+
+template <class E>
+class ploop_pack
+{
+
+    public:
+        static_assert(std::is_trivially_copyable<E>::value,
+            "A PLOOP share variable can only cross processes if its elements can be packed.");
+
+        static inline size_t    bytes(const E &) { return sizeof(E); }
+        static inline void      write(const E &element, void *slot) { std::memcpy(slot, &element, sizeof(E)); }
+        static inline void      read(E &element, const void *slot) { std::memcpy(&element, slot, sizeof(E)); }
+
+};
+
+template <class T, size_t N>
+class ploop_pack<dvector<T,N>>
+{
+
+    public:
+        static inline size_t    bytes(const dvector<T,N> &element) { return N * sizeof(T); }
+
+        static inline void      write(const dvector<T,N> &element, void *slot)
+        {
+            unsigned char *target = static_cast<unsigned char*>(slot);
+            for (size_t i = 0; i < N; ++i) std::memcpy(target + i * sizeof(T), &element[i], sizeof(T));
+        }
+
+        static inline void      read(dvector<T,N> &element, const void *slot)
+        {
+            const unsigned char *source = static_cast<const unsigned char*>(slot);
+            for (size_t i = 0; i < N; ++i) std::memcpy(&element[i], source + i * sizeof(T), sizeof(T));
+        }
+
+};
+
+template <>
+class ploop_pack<da>
+{
+
+    public:
+        static inline size_t    bytes(const da &element) { return element.size() * sizeof(double); }
+
+        static inline void      write(const da &element, void *slot)
+        {
+            std::memcpy(slot, element.data(), element.size() * sizeof(double));
+        }
+
+        static inline void      read(da &element, const void *slot)
+        {
+            std::memcpy(element.data(), slot, element.size() * sizeof(double));
+        }
+
+};
+
+// --- Transports --------------------------------------------------------------
+
+class ploop_transport
+{
+
+    public:
+        using task = std::function<void(int64_t iteration, void *slot)>;
+
+    public:
+        virtual                 ~ploop_transport() = default;
+
+        virtual size_t          size() const = 0;
+        virtual void            execute(int64_t first, int64_t last, int64_t grain, size_t slot_bytes,
+                                    const task &body) = 0;
+        virtual const void*     result(int64_t iteration) const = 0;
+
+};
+
+// Runs every iteration in the calling process, for platforms without fork and for
+// loops nested in a worker.
+class ploop_local_transport : public ploop_transport
+{
+
+    public:
+        inline size_t           size() const override;
+        inline void             execute(int64_t first, int64_t last, int64_t grain, size_t slot_bytes,
+                                    const task &body) override;
+        inline const void*      result(int64_t iteration) const override;
+
+    protected:
+        int64_t                 first = 0;
+        size_t                  slot_bytes = 0;
+        std::vector<unsigned char> slots;
+
+};
+
+inline size_t ploop_local_transport::
+size() const
+{
+
+    return 1;
+
+}
+
+inline void ploop_local_transport::
+execute(int64_t first, int64_t last, int64_t, size_t slot_bytes, const task &body)
+{
+
+    this->first = first;
+    this->slot_bytes = slot_bytes;
+    this->slots.assign(size_t(last - first) * slot_bytes, 0);
+    for (int64_t iteration = first; iteration < last; ++iteration)
+        body(iteration, this->slots.data() + size_t(iteration - first) * slot_bytes);
+
+}
+
+inline const void* ploop_local_transport::
+result(int64_t iteration) const
+{
+
+    return this->slots.data() + size_t(iteration - this->first) * this->slot_bytes;
+
+}
+
+#if SF_PLOOP_PROCESSES == 1
+
+class ploop_shared_memory_transport : public ploop_transport
+{
+
+    public:
+        inline                  ploop_shared_memory_transport(size_t process_count);
+        inline                 ~ploop_shared_memory_transport();
+
+        static inline size_t    default_process_count();
+
+        inline size_t           size() const override;
+        inline void             execute(int64_t first, int64_t last, int64_t grain, size_t slot_bytes,
+                                    const task &body) override;
+        inline const void*      result(int64_t iteration) const override;
+
+    protected:
+        struct alignas(64) header
+        {
+            std::atomic<int64_t>    next;
+            std::atomic<int64_t>    completed;
+        };
+
+        static_assert(std::atomic<int64_t>::is_always_lock_free,
+            "The segment's counters have to work across processes.");
+
+        inline void             map_segment(size_t bytes);
+        inline void             unmap_segment();
+        inline void             work(const task &body);
+        inline unsigned char*   slot(int64_t iteration) const;
+
+    protected:
+        size_t                  processes;
+        void                   *segment;
+        size_t                  segment_bytes;
+        int64_t                 first;
+        int64_t                 last;
+        int64_t                 grain;
+        size_t                  slot_bytes;
+
+};
+
+inline ploop_shared_memory_transport::
+ploop_shared_memory_transport(size_t process_count)
+    : processes(process_count > 0 ? process_count : 1), segment(nullptr), segment_bytes(0),
+      first(0), last(0), grain(1), slot_bytes(0)
+{
+
+}
+
+inline ploop_shared_memory_transport::
+~ploop_shared_memory_transport()
+{
+
+    this->unmap_segment();
+
+}
+
+inline size_t ploop_shared_memory_transport::
+default_process_count()
+{
+
+    const char *requested = std::getenv("SF_PLOOP_PROCESSES");
+    if (requested != nullptr)
+    {
+        const long count = std::strtol(requested, nullptr, 10);
+        if (count > 0) return size_t(count);
+    }
+
+    const size_t cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+
+}
+
+inline size_t ploop_shared_memory_transport::
+size() const
+{
+
+    return this->processes;
+
+}
+
+inline void ploop_shared_memory_transport::
+map_segment(size_t bytes)
+{
+
+    static std::atomic<uint64_t> segment_count(0);
+    const std::string name = "/sigmafox-ploop-" + std::to_string(uint64_t(getpid())) + "-" +
+        std::to_string(segment_count++);
+
+    const int descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (descriptor < 0) throw std::runtime_error("PLOOP couldn't create a shared memory segment.");
+    shm_unlink(name.c_str());
+
+    void *mapped = MAP_FAILED;
+    if (ftruncate(descriptor, off_t(bytes)) == 0)
+        mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (mapped == MAP_FAILED) throw std::runtime_error("PLOOP couldn't map a shared memory segment.");
+
+    this->segment = mapped;
+    this->segment_bytes = bytes;
+
+}
+
+inline void ploop_shared_memory_transport::
+unmap_segment()
+{
+
+    if (this->segment == nullptr) return;
+    munmap(this->segment, this->segment_bytes);
+    this->segment = nullptr;
+    this->segment_bytes = 0;
+
+}
+
+inline unsigned char* ploop_shared_memory_transport::
+slot(int64_t iteration) const
+{
+
+    return static_cast<unsigned char*>(this->segment) + sizeof(header) +
+        size_t(iteration - this->first) * this->slot_bytes;
+
+}
+
+inline void ploop_shared_memory_transport::
+work(const task &body)
+{
+
+    header *shared = static_cast<header*>(this->segment);
+    while (true)
+    {
+        const int64_t begin = shared->next.fetch_add(this->grain);
+        if (begin >= this->last) return;
+        const int64_t end = std::min(this->last, begin + this->grain);
+        for (int64_t iteration = begin; iteration < end; ++iteration)
+        {
+            body(iteration, this->slot(iteration));
+            shared->completed.fetch_add(1);
+        }
+    }
+
+}
+
+inline void ploop_shared_memory_transport::
+execute(int64_t first, int64_t last, int64_t grain, size_t slot_bytes, const task &body)
+{
+
+    this->unmap_segment();
+    this->first = first;
+    this->last = last;
+    this->grain = grain > 0 ? grain : 1;
+    this->slot_bytes = slot_bytes;
+    this->map_segment(sizeof(header) + size_t(last - first) * slot_bytes);
+
+    header *shared = new (this->segment) header;
+    shared->next.store(first);
+    shared->completed.store(0);
+
+    // Anything still buffered would be written again by every worker.
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    std::vector<pid_t> workers;
+    const int64_t count = last - first;
+    const int64_t chunks = (count + this->grain - 1) / this->grain;
+    for (size_t process = 1; process < this->processes && int64_t(process) < chunks; ++process)
+    {
+
+        const pid_t worker = fork();
+        if (worker < 0) break;
+        if (worker > 0)
+        {
+            workers.push_back(worker);
+            continue;
+        }
+
+        // The worker has one thread and no pool, loops it reaches run in order.
+        ploop_pool::inside() = true;
+        int status = 0;
+        try
+        {
+            this->work(body);
+        }
+        catch (...)
+        {
+            status = 1;
+        }
+
+        std::cout.flush();
+        std::fflush(nullptr);
+        _exit(status);
+
+    }
+
+    const bool inside = ploop_pool::inside();
+    ploop_pool::inside() = true;
+    std::exception_ptr failure = nullptr;
+    try
+    {
+        this->work(body);
+    }
+    catch (...)
+    {
+        failure = std::current_exception();
+    }
+    ploop_pool::inside() = inside;
+
+    for (pid_t worker : workers)
+    {
+        int status = 0;
+        while (waitpid(worker, &status, 0) < 0 && errno == EINTR) { }
+    }
+
+    if (failure != nullptr) std::rethrow_exception(failure);
+    if (shared->completed.load() != count)
+        throw std::runtime_error("A PLOOP worker process failed before finishing its iterations.");
+
+}
+
+inline const void* ploop_shared_memory_transport::
+result(int64_t iteration) const
+{
+
+    return this->slot(iteration);
+
+}
+
+#endif
+
+inline std::unique_ptr<ploop_transport>&
+ploop_transport_storage()
+{
+
+#   if SF_PLOOP_PROCESSES == 1
+        static std::unique_ptr<ploop_transport> transport = std::make_unique<ploop_shared_memory_transport>(
+                ploop_shared_memory_transport::default_process_count());
+#   else
+        static std::unique_ptr<ploop_transport> transport = std::make_unique<ploop_local_transport>();
+#   endif
+    return transport;
+
+}
+
+inline ploop_transport&
+ploop_transport_active()
+{
+
+    return *ploop_transport_storage();
+
+}
+
+inline void
+ploop_transport_install(std::unique_ptr<ploop_transport> transport)
+{
+
+    ploop_transport_storage() = std::move(transport);
+
+}
+
+// --- Distribution ------------------------------------------------------------
+//
+// An iteration's slot holds its element of every gather, one after another. A
+// reduction's slot is its chunk's partial result as the iteration left it, see
+// ploop_reduction. Slots are unpacked in iteration order, so the last iteration of a
+// chunk is the one whose partial stays. Anything with an element type, a grain and a
+// slot per iteration can follow the body, and the loop runs with the largest grain.
+//
+
+template <class F, class... G> inline void
+ploop_distribute(int64_t first, int64_t last, const F &body, G&... gathers)
+{
+
+    if (first >= last) return;
+
+    ploop_local_transport nested;
+    ploop_transport &transport = ploop_pool::inside() ? nested : ploop_transport_active();
+
+    F local = body;
+    int64_t grain = 1;
+    size_t slot_bytes = 0;
+    ((grain = std::max(grain, gathers.grain())), ...);
+    ((slot_bytes += ploop_pack<typename G::element>::bytes(gathers.slot(first))), ...);
+
+    transport.execute(first, last, grain, slot_bytes, [&](int64_t iteration, void *slot)
+    {
+        local(iteration);
+        unsigned char *cursor = static_cast<unsigned char*>(slot);
+        ((ploop_pack<typename G::element>::write(gathers.slot(iteration), cursor),
+          cursor += ploop_pack<typename G::element>::bytes(gathers.slot(iteration))), ...);
+    });
+
+    for (int64_t iteration = first; iteration < last; ++iteration)
+    {
+        const unsigned char *cursor = static_cast<const unsigned char*>(transport.result(iteration));
+        ((ploop_pack<typename G::element>::read(gathers.slot(iteration), cursor),
+          cursor += ploop_pack<typename G::element>::bytes(gathers.slot(iteration))), ...);
+    }
+
+}
+
+#endif
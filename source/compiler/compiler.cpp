@@ -2,6 +2,11 @@
 #include <compiler/reference.hpp>
 #include <compiler/parser/parser.hpp>
 #include <compiler/generation/generator.hpp>
+#include <compiler/generation/vectorization.hpp>
+#include <compiler/optimization/folder.hpp>
+#include <compiler/optimization/hoister.hpp>
+#include <compiler/optimization/eliminator.hpp>
+#include <compiler/optimization/parallelizer.hpp>
 
 Compiler::
 Compiler(string entry_file)
@@ -66,10 +71,25 @@ parse(bool show_reference)
 }
 
 bool Compiler::
-validate() const
+validate()
 {
 
     if (root == nullptr) return false;
+
+    // Optimization passes, run over the whole tree before generation.
+    ConstantFolder folder(&this->environment, &this->nodes);
+    this->root->accept(&folder);
+
+    InvariantHoister hoister(&this->environment, &this->nodes);
+    this->root->accept(&hoister);
+
+    SubexpressionEliminator eliminator(&this->nodes);
+    this->root->accept(&eliminator);
+
+    LoopParallelizer parallelizer(&this->environment);
+    this->root->accept(&parallelizer);
+    for (auto &line : parallelizer.get_report()) std::cout << "-- " << line << std::endl;
+
     return true;
 
 }
@@ -85,12 +105,27 @@ generate() const
 
 #else
 
-    TranspileCPPGenerator generator;
+    TranspileCPPGenerator generator("./output", this->generator_options);
     this->root->accept(&generator);
     //generator.dump_output();
     generator.generate_files();
+
+    if (this->generator_options.vectorization_report)
+    {
+        Vectorizationreport report("./output", generator.get_entry_file());
+        report.collect();
+        for (auto &line : report.get_report()) std::cout << "-- " << line << std::endl;
+    }
 #endif
 
     return true;
 
 }
+
+void Compiler::
+set_generator_options(Generatoroptions options)
+{
+
+    this->generator_options = options;
+
+}
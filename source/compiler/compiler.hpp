@@ -4,6 +4,7 @@
 #include <compiler/environment.hpp>
 #include <compiler/graph.hpp>
 #include <compiler/parser/node.hpp>
+#include <compiler/generation/generator.hpp>
 
 class Compiler
 {
@@ -13,10 +14,13 @@ class Compiler
         virtual    ~Compiler();
 
         bool        parse(bool show_reference = false);
-        bool        validate() const;
+        bool        validate();
         bool        generate() const;
 
+        void        set_generator_options(Generatoroptions options);
+
     protected:
+        Generatoroptions            generator_options;
         DependencyGraph             graph;
         Environment                 environment;
         SyntaxNode*                 root;
@@ -1,6 +1,9 @@
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <compiler/generation/generator.hpp>
+#include <compiler/optimization/expressions.hpp>
 #include <utilities/path.hpp>
 
 // --- Core Transpiler Routines ------------------------------------------------
@@ -21,6 +24,15 @@ TranspileCPPGenerator(string output)
 
 }
 
+TranspileCPPGenerator::
+TranspileCPPGenerator(string output, Generatoroptions options)
+{
+
+    this->output = output;
+    this->options = options;
+
+}
+
 TranspileCPPGenerator::
 ~TranspileCPPGenerator()
 {
@@ -69,12 +81,24 @@ generate_files()
 
 }
 
+string TranspileCPPGenerator::
+get_entry_file() const
+{
+
+    return this->main_file != nullptr ? this->main_file->get_file_path() : "";
+
+}
+
 // --- Visitor Routines --------------------------------------------------------
 
 void TranspileCPPGenerator::    
 visit(SyntaxNodeRoot* node)
 {
 
+    string enclosing_source = this->source_name;
+    this->source_name = node->relative_base;
+    std::replace(this->source_name.begin(), this->source_name.end(), '\\', '/');
+
     bool is_entry = false;
     if (this->source_files.empty())
     {
@@ -100,7 +124,12 @@ visit(SyntaxNodeRoot* node)
         this->current_file->insert_line_with_tabs("SET(CMAKE_BUILD_TYPE Debug)");
         this->current_file->insert_blank_line();
         this->current_file->insert_line_with_tabs("ADD_EXECUTABLE(cosyproject");
-        this->current_file->insert_line_with_tabs("    \"./library/dvector.hpp\"");
+        for (auto library_file : runtime_library_files)
+        {
+            this->current_file->insert_line_with_tabs("    \"./library/");
+            this->current_file->append_to_current_line(library_file);
+            this->current_file->append_to_current_line("\"");
+        }
         this->current_file->pop_region();
 
         this->current_file->push_region_as_body();
@@ -115,6 +144,21 @@ visit(SyntaxNodeRoot* node)
         this->current_file->insert_line_with_tabs(")");
         this->current_file->insert_blank_line();
         this->current_file->insert_line_with_tabs("target_include_directories(cosyproject PUBLIC \"library\")");
+        this->current_file->insert_line_with_tabs("find_package(Threads REQUIRED)");
+        this->current_file->insert_line_with_tabs("target_link_libraries(cosyproject PUBLIC Threads::Threads)");
+        this->current_file->insert_line_with_tabs("include(CheckCXXCompilerFlag)");
+        this->current_file->insert_line_with_tabs("check_cxx_compiler_flag(-fopenmp-simd SF_OPENMP_SIMD)");
+        this->current_file->insert_line_with_tabs("if (SF_OPENMP_SIMD)");
+        this->current_file->insert_line_with_tabs("    target_compile_options(cosyproject PUBLIC -fopenmp-simd)");
+        this->current_file->insert_line_with_tabs("endif()");
+        if (this->options.strict_ieee)
+            this->current_file->insert_line_with_tabs("target_compile_definitions(cosyproject PUBLIC SF_COMPLEX_STRICT_IEEE=1)");
+        if (this->options.ploop_processes)
+        {
+            this->current_file->insert_line_with_tabs("if (UNIX AND NOT APPLE)");
+            this->current_file->insert_line_with_tabs("    target_link_libraries(cosyproject PUBLIC rt)");
+            this->current_file->insert_line_with_tabs("endif()");
+        }
         this->current_file->insert_blank_line();
         this->current_file->insert_blank_line();
         this->current_file->pop_region();
@@ -177,8 +221,16 @@ visit(SyntaxNodeRoot* node)
     this->current_file->insert_line("#include <string>");
     this->current_file->insert_line("#include <cstdint>");
     this->current_file->insert_line("#include <dvector.hpp>");
-    this->current_file->insert_blank_line();
-    this->current_file->insert_line("typedef std::complex<double> complexd;");
+    this->current_file->insert_line("#include <bunch.hpp>");
+    this->current_file->insert_line("#include <da.hpp>");
+    this->current_file->insert_line("#include <map.hpp>");
+    this->current_file->insert_line("#include <elements.hpp>");
+    this->current_file->insert_line("#include <interval.hpp>");
+    this->current_file->insert_line("#include <complex.hpp>");
+    this->current_file->insert_line("#include <transcendental.hpp>");
+    this->current_file->insert_line("#include <power.hpp>");
+    this->current_file->insert_line("#include <ploop.hpp>");
+    this->current_file->insert_line("#include <transport.hpp>");
     this->current_file->insert_blank_line();
     this->current_file->pop_region();
 
@@ -198,6 +250,7 @@ visit(SyntaxNodeRoot* node)
         this->current_file->pop_region();
     }
 
+    this->source_name = enclosing_source;
     SF_ASSERT(!this->source_stack.empty());
     this->source_stack.pop();
     if (this->source_stack.empty()) return;
@@ -279,53 +332,8 @@ visit(SyntaxNodeFunctionStatement* node)
         Datatype function_datatype = variable_node->data_type;
         Structuretype function_structure_type = variable_node->structure_type;
         i32 function_structure_length = variable_node->structure_length;
-        if (function_structure_type == Structuretype::STRUCTURE_TYPE_SCALAR ||
-            function_structure_type == Structuretype::STRUCTURE_TYPE_STRING)
-        {
-            switch (function_datatype)
-            {
-
-                case Datatype::DATA_TYPE_STRING:
-                {
-                    this->current_file->append_to_current_line("std::string ");
-                } break;
-
-                case Datatype::DATA_TYPE_INTEGER:
-                {
-                    this->current_file->append_to_current_line("int64_t ");
-                } break;
-
-                case Datatype::DATA_TYPE_REAL:
-                {
-                    this->current_file->append_to_current_line("double ");
-                } break;
-
-                case Datatype::DATA_TYPE_COMPLEX:
-                {
-                    this->current_file->append_to_current_line("std::complex<double> ");
-                } break;
-
-                case Datatype::DATA_TYPE_UNKNOWN:
-                {
-                    this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                } break;
-
-                default:
-                {
-                    this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                    //SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-                };
-
-            }
-        }
-        else
-        {
-
-            this->current_file->append_to_current_line("dvector<double, ");
-            this->current_file->append_to_current_line(std::to_string(function_structure_length));
-            this->current_file->append_to_current_line("> ");
-
-        }
+        this->current_file->append_to_current_line(this->cpp_type_of(function_datatype, function_structure_type,
+            function_structure_length) + " ");
 
         
         this->current_file->insert_line_with_tabs("fn_");
@@ -339,56 +347,8 @@ visit(SyntaxNodeFunctionStatement* node)
                 dynamic_cast<SyntaxNodeVariableStatement*>(node->parameters[i]);
             SF_ENSURE_PTR(parameter_variable_node);
 
-            Datatype parameter_datatype = parameter_variable_node->data_type;
-            Structuretype parameter_structure_type = parameter_variable_node->structure_type;
-            i32 parameter_structure_length = parameter_variable_node->structure_length;
-            if (parameter_structure_type == Structuretype::STRUCTURE_TYPE_SCALAR ||
-                parameter_structure_type == Structuretype::STRUCTURE_TYPE_STRING)
-            {
-                switch (parameter_datatype)
-                {
-
-                    case Datatype::DATA_TYPE_STRING:
-                    {
-                        this->current_file->append_to_current_line("std::string ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_INTEGER:
-                    {
-                        this->current_file->append_to_current_line("int64_t ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_REAL:
-                    {
-                        this->current_file->append_to_current_line("double ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_COMPLEX:
-                    {
-                        this->current_file->append_to_current_line("std::complex<double> ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_UNKNOWN:
-                    {
-                        this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                    } break;
-
-                    default:
-                    {
-                        this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                        //SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-                    };
-
-                }
-            }
-            else
-            {
-
-                this->current_file->append_to_current_line("dvector<double, ");
-                this->current_file->append_to_current_line(std::to_string(parameter_structure_length));
-                this->current_file->append_to_current_line("> ");
-
-            }
+            this->current_file->append_to_current_line(this->cpp_type_of(parameter_variable_node->data_type,
+                parameter_variable_node->structure_type, parameter_variable_node->structure_length) + " ");
 
             this->current_file->append_to_current_line(parameter_variable_node->identifier);
             if (i < node->parameters.size() - 1)
@@ -405,35 +365,8 @@ visit(SyntaxNodeFunctionStatement* node)
         this->current_file->insert_blank_line();
         this->current_file->push_tabs();
 
-        switch (function_datatype)
-        {
-
-            case Datatype::DATA_TYPE_STRING:
-            {
-                this->current_file->insert_line_with_tabs("std::string ");
-            } break;
-
-            case Datatype::DATA_TYPE_INTEGER:
-            {
-                this->current_file->insert_line_with_tabs("int64_t ");
-            } break;
-
-            case Datatype::DATA_TYPE_REAL:
-            {
-                this->current_file->insert_line_with_tabs("double ");
-            } break;
-
-            case Datatype::DATA_TYPE_COMPLEX:
-            {
-                this->current_file->insert_line_with_tabs("std::complex<double> ");
-            } break;
-
-            default:
-            {
-                SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-            };
-
-        }
+        this->current_file->insert_line_with_tabs(this->cpp_type_of(function_datatype, function_structure_type,
+            function_structure_length) + " ");
 
         this->current_file->append_to_current_line(variable_node->identifier);
         this->current_file->append_to_current_line(";");
@@ -483,56 +416,8 @@ auto myLambda = [](int x, int y) -> double {
                 dynamic_cast<SyntaxNodeVariableStatement*>(node->parameters[i]);
             SF_ENSURE_PTR(parameter_variable_node);
 
-            Datatype parameter_datatype = parameter_variable_node->data_type;
-            Structuretype parameter_structure_type = parameter_variable_node->structure_type;
-            i32 parameter_structure_length = parameter_variable_node->structure_length;
-            if (parameter_structure_type == Structuretype::STRUCTURE_TYPE_SCALAR ||
-                parameter_structure_type == Structuretype::STRUCTURE_TYPE_STRING)
-            {
-                switch (parameter_datatype)
-                {
-
-                    case Datatype::DATA_TYPE_STRING:
-                    {
-                        this->current_file->append_to_current_line("std::string ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_INTEGER:
-                    {
-                        this->current_file->append_to_current_line("int64_t ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_REAL:
-                    {
-                        this->current_file->append_to_current_line("double ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_COMPLEX:
-                    {
-                        this->current_file->append_to_current_line("std::complex<double> ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_UNKNOWN:
-                    {
-                        this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                    } break;
-
-                    default:
-                    {
-                        this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                        //SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-                    };
-
-                }
-            }
-            else
-            {
-
-                this->current_file->append_to_current_line("dvector<double, ");
-                this->current_file->append_to_current_line(std::to_string(parameter_structure_length));
-                this->current_file->append_to_current_line("> ");
-
-            }
+            this->current_file->append_to_current_line(this->cpp_type_of(parameter_variable_node->data_type,
+                parameter_variable_node->structure_type, parameter_variable_node->structure_length) + " ");
 
             this->current_file->append_to_current_line(parameter_variable_node->identifier);
             if (i < node->parameters.size() - 1)
@@ -548,88 +433,16 @@ auto myLambda = [](int x, int y) -> double {
         Datatype function_datatype = variable_node->data_type;
         Structuretype function_structure_type = variable_node->structure_type;
         i32 function_structure_length = variable_node->structure_length;
-        if (function_structure_type == Structuretype::STRUCTURE_TYPE_SCALAR ||
-            function_structure_type == Structuretype::STRUCTURE_TYPE_STRING)
-        {
-            switch (function_datatype)
-            {
-
-                case Datatype::DATA_TYPE_STRING:
-                {
-                    this->current_file->append_to_current_line("std::string ");
-                } break;
-
-                case Datatype::DATA_TYPE_INTEGER:
-                {
-                    this->current_file->append_to_current_line("int64_t ");
-                } break;
-
-                case Datatype::DATA_TYPE_REAL:
-                {
-                    this->current_file->append_to_current_line("double ");
-                } break;
-
-                case Datatype::DATA_TYPE_COMPLEX:
-                {
-                    this->current_file->append_to_current_line("std::complex<double> ");
-                } break;
-
-                case Datatype::DATA_TYPE_UNKNOWN:
-                {
-                    this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                } break;
-
-                default:
-                {
-                    this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                    //SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-                };
-
-            }
-        }
-        else
-        {
-
-            this->current_file->append_to_current_line("dvector<double, ");
-            this->current_file->append_to_current_line(std::to_string(function_structure_length));
-            this->current_file->append_to_current_line("> ");
-
-        }
+        this->current_file->append_to_current_line(this->cpp_type_of(function_datatype, function_structure_type,
+            function_structure_length) + " ");
 
 
         this->current_file->insert_line_with_tabs("{");
         this->current_file->insert_blank_line();
         this->current_file->push_tabs();
 
-        switch (function_datatype)
-        {
-
-            case Datatype::DATA_TYPE_STRING:
-            {
-                this->current_file->insert_line_with_tabs("std::string ");
-            } break;
-
-            case Datatype::DATA_TYPE_INTEGER:
-            {
-                this->current_file->insert_line_with_tabs("int64_t ");
-            } break;
-
-            case Datatype::DATA_TYPE_REAL:
-            {
-                this->current_file->insert_line_with_tabs("double ");
-            } break;
-
-            case Datatype::DATA_TYPE_COMPLEX:
-            {
-                this->current_file->insert_line_with_tabs("std::complex<double> ");
-            } break;
-
-            default:
-            {
-                SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-            };
-
-        }
+        this->current_file->insert_line_with_tabs(this->cpp_type_of(function_datatype, function_structure_type,
+            function_structure_length) + " ");
 
         this->current_file->append_to_current_line(variable_node->identifier);
         this->current_file->append_to_current_line(";");
@@ -693,56 +506,8 @@ visit(SyntaxNodeProcedureStatement* node)
                 dynamic_cast<SyntaxNodeVariableStatement*>(node->parameters[i]);
             SF_ENSURE_PTR(parameter_variable_node);
 
-            Datatype parameter_datatype = parameter_variable_node->data_type;
-            Structuretype parameter_structure_type = parameter_variable_node->structure_type;
-            i32 parameter_structure_length = parameter_variable_node->structure_length;
-            if (parameter_structure_type == Structuretype::STRUCTURE_TYPE_SCALAR ||
-                parameter_structure_type == Structuretype::STRUCTURE_TYPE_STRING)
-            {
-                switch (parameter_datatype)
-                {
-
-                    case Datatype::DATA_TYPE_STRING:
-                    {
-                        this->current_file->append_to_current_line("std::string ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_INTEGER:
-                    {
-                        this->current_file->append_to_current_line("int64_t ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_REAL:
-                    {
-                        this->current_file->append_to_current_line("double ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_COMPLEX:
-                    {
-                        this->current_file->append_to_current_line("std::complex<double> ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_UNKNOWN:
-                    {
-                        this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                    } break;
-
-                    default:
-                    {
-                        this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                        //SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-                    };
-
-                }
-            }
-            else
-            {
-
-                this->current_file->append_to_current_line("dvector<double, ");
-                this->current_file->append_to_current_line(std::to_string(parameter_structure_length));
-                this->current_file->append_to_current_line("> ");
-
-            }
+            this->current_file->append_to_current_line(this->cpp_type_of(parameter_variable_node->data_type,
+                parameter_variable_node->structure_type, parameter_variable_node->structure_length) + " ");
 
             this->current_file->append_to_current_line(parameter_variable_node->identifier);
             if (i < node->parameters.size() - 1)
@@ -787,56 +552,8 @@ visit(SyntaxNodeProcedureStatement* node)
                 dynamic_cast<SyntaxNodeVariableStatement*>(node->parameters[i]);
             SF_ENSURE_PTR(parameter_variable_node);
 
-            Datatype parameter_datatype = parameter_variable_node->data_type;
-            Structuretype parameter_structure_type = parameter_variable_node->structure_type;
-            i32 parameter_structure_length = parameter_variable_node->structure_length;
-            if (parameter_structure_type == Structuretype::STRUCTURE_TYPE_SCALAR ||
-                parameter_structure_type == Structuretype::STRUCTURE_TYPE_STRING)
-            {
-                switch (parameter_datatype)
-                {
-
-                    case Datatype::DATA_TYPE_STRING:
-                    {
-                        this->current_file->append_to_current_line("std::string ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_INTEGER:
-                    {
-                        this->current_file->append_to_current_line("int64_t ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_REAL:
-                    {
-                        this->current_file->append_to_current_line("double ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_COMPLEX:
-                    {
-                        this->current_file->append_to_current_line("std::complex<double> ");
-                    } break;
-
-                    case Datatype::DATA_TYPE_UNKNOWN:
-                    {
-                        this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                    } break;
-
-                    default:
-                    {
-                        this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                        //SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-                    };
-
-                }
-            }
-            else
-            {
-
-                this->current_file->append_to_current_line("dvector<double, ");
-                this->current_file->append_to_current_line(std::to_string(parameter_structure_length));
-                this->current_file->append_to_current_line("> ");
-
-            }
+            this->current_file->append_to_current_line(this->cpp_type_of(parameter_variable_node->data_type,
+                parameter_variable_node->structure_type, parameter_variable_node->structure_length) + " ");
 
             this->current_file->append_to_current_line(parameter_variable_node->identifier);
             if (i < node->parameters.size() - 1)
@@ -920,64 +637,7 @@ void TranspileCPPGenerator::
 visit(SyntaxNodePloopStatement* node)
 {
 
-    this->current_file->insert_line_with_tabs("// This is a ploop statement, but ploop is not supported.");
-    this->current_file->insert_line_with_tabs("for (");
-
-    Datatype data_type = node->variable->data_type;
-    switch (data_type)
-    {
-
-        case Datatype::DATA_TYPE_STRING:
-        {
-            this->current_file->append_to_current_line("std::string ");
-        } break;
-
-        case Datatype::DATA_TYPE_INTEGER:
-        {
-            this->current_file->append_to_current_line("int64_t ");
-        } break;
-
-        case Datatype::DATA_TYPE_REAL:
-        {
-            this->current_file->append_to_current_line("double ");
-        } break;
-
-        case Datatype::DATA_TYPE_COMPLEX:
-        {
-            this->current_file->append_to_current_line("std::complex<double> ");
-        } break;
-
-        default:
-        {
-            SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-        };
-
-    }
-    
-    this->current_file->append_to_current_line(node->variable->identifier);
-    this->current_file->append_to_current_line(" = ");
-    node->start->accept(this);
-    this->current_file->append_to_current_line("; ");
-    this->current_file->append_to_current_line(node->variable->identifier);
-    this->current_file->append_to_current_line(" < ");
-    node->end->accept(this);
-    this->current_file->append_to_current_line("; ");
-    this->current_file->append_to_current_line(node->variable->identifier);
-    this->current_file->append_to_current_line(" += ");
-    node->step->accept(this);
-    this->current_file->append_to_current_line(")");
-
-    this->current_file->insert_line_with_tabs("{");
-    this->current_file->insert_blank_line();
-    this->current_file->push_tabs();
-
-    for (auto child : node->children) child->accept(this);
-
-    this->current_file->pop_tabs();
-    this->current_file->insert_blank_line();
-    this->current_file->insert_line_with_tabs("}");
-    this->current_file->insert_blank_line();
-
+    this->generate_parallel_loop(node->variable, node->start, node->end, { node->share_name }, {}, node->children);
     return;
 }
 
@@ -985,50 +645,73 @@ void TranspileCPPGenerator::
 visit(SyntaxNodeLoopStatement* node)
 {
 
-    this->current_file->insert_line_with_tabs("for (");
-
-    Datatype data_type = node->variable->data_type;
-    switch (data_type)
+    if (node->parallel)
     {
+        this->generate_parallel_loop(node->variable, node->start, node->end, node->shared, node->reductions,
+            node->children);
+        return;
+    }
 
-        case Datatype::DATA_TYPE_STRING:
-        {
-            this->current_file->append_to_current_line("std::string ");
-        } break;
-
-        case Datatype::DATA_TYPE_INTEGER:
-        {
-            this->current_file->append_to_current_line("int64_t ");
-        } break;
-
-        case Datatype::DATA_TYPE_REAL:
-        {
-            this->current_file->append_to_current_line("double ");
-        } break;
-
-        case Datatype::DATA_TYPE_COMPLEX:
-        {
-            this->current_file->append_to_current_line("std::complex<double> ");
-        } break;
+    // The comment ties the loop back to its source line for the vectorization report,
+    // see vectorization.hpp.
+    this->current_file->insert_line_with_tabs("// " + this->source_name + ":" + std::to_string(node->row) +
+        " LOOP " + node->variable->identifier);
+
+    // With a constant step and an integer iterator the loop takes the canonical form
+    // vectorizers count trips in: the end taken once as an integer bound, and the
+    // iterator stepped by a literal. Any other step is evaluated every pass, as written.
+    auto *step = dynamic_cast<SyntaxNodePrimary*>(node->step);
+    bool canonical = step != nullptr && step->primarytype == Primarytype::PRIMARY_TYPE_INTEGER &&
+        node->variable->data_type == Datatype::DATA_TYPE_INTEGER;
+    string bound;
+    if (canonical)
+    {
+        bound = "sf_loop_end_" + std::to_string(this->loop_count++);
+        this->current_file->insert_line_with_tabs("const int64_t " + bound + " = loop_bound(");
+        node->end->accept(this);
+        this->current_file->append_to_current_line(");");
+    }
 
-        default:
+    if (node->simd)
+    {
+        this->current_file->insert_line_with_tabs("#pragma omp simd");
+        for (auto &reduction : node->reductions)
         {
-            SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-        };
-
+            switch (reduction.second)
+            {
+                case Reductiontype::REDUCTION_TYPE_SUM: this->current_file->append_to_current_line(" reduction(+:"); break;
+                case Reductiontype::REDUCTION_TYPE_MAXIMUM: this->current_file->append_to_current_line(" reduction(max:"); break;
+                case Reductiontype::REDUCTION_TYPE_MINIMUM: this->current_file->append_to_current_line(" reduction(min:"); break;
+            }
+            this->current_file->append_to_current_line(reduction.first + ")");
+        }
     }
-    
+
+    this->current_file->insert_line_with_tabs("for (");
+    this->current_file->append_to_current_line(this->cpp_type_of(node->variable->data_type,
+        node->variable->structure_type, node->variable->structure_length) + " ");
     this->current_file->append_to_current_line(node->variable->identifier);
     this->current_file->append_to_current_line(" = ");
     node->start->accept(this);
     this->current_file->append_to_current_line("; ");
     this->current_file->append_to_current_line(node->variable->identifier);
     this->current_file->append_to_current_line(" < ");
-    node->end->accept(this);
+    if (canonical)
+        this->current_file->append_to_current_line(bound);
+    else
+        node->end->accept(this);
     this->current_file->append_to_current_line("; ");
-    this->current_file->append_to_current_line(node->variable->identifier);
-    this->current_file->append_to_current_line(" += ");
-    node->step->accept(this);
+    if (canonical && step->primitive == "1")
+    {
+        this->current_file->append_to_current_line("++");
+        this->current_file->append_to_current_line(node->variable->identifier);
+    }
+    else
+    {
+        this->current_file->append_to_current_line(node->variable->identifier);
+        this->current_file->append_to_current_line(" += ");
+        node->step->accept(this);
+    }
     this->current_file->append_to_current_line(")");
 
     this->current_file->insert_line_with_tabs("{");
@@ -1051,54 +734,56 @@ visit(SyntaxNodeVariableStatement* node)
 
     this->current_file->insert_line_with_tabs("");
 
-    if (node->structure_type == Structuretype::STRUCTURE_TYPE_SCALAR ||
-        node->structure_type == Structuretype::STRUCTURE_TYPE_STRING)
+    // An array of vectors is laid out as a particle bunch, one column per coordinate,
+    // and an array of DA is a transfer map, both sized by the product of dimensions.
+    // An array of scalars is a std::vector. COSY counts its elements from one and
+    // indices are written out as they are, so it holds one more and leaves element
+    // zero unused.
+    if (node->dimensions.size() != 0)
     {
-        switch (node->data_type)
-        {
-
-            case Datatype::DATA_TYPE_STRING:
-            {
-                this->current_file->append_to_current_line("std::string ");
-            } break;
 
-            case Datatype::DATA_TYPE_INTEGER:
-            {
-                this->current_file->append_to_current_line("int64_t ");
-            } break;
+        bool scalars = node->structure_type == Structuretype::STRUCTURE_TYPE_SCALAR ||
+            node->structure_type == Structuretype::STRUCTURE_TYPE_STRING;
+        if (node->structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL)
+        {
+            this->current_file->append_to_current_line("transfer_map ");
+        }
+        else if (scalars)
+        {
+            this->current_file->append_to_current_line("std::vector<" + this->cpp_type_of(node->data_type,
+                node->structure_type, node->structure_length) + "> ");
+        }
+        else
+        {
+            this->current_file->append_to_current_line("particle_bunch<double, ");
+            this->current_file->append_to_current_line(std::to_string(node->structure_length));
+            this->current_file->append_to_current_line("> ");
+        }
 
-            case Datatype::DATA_TYPE_REAL:
-            {
-                this->current_file->append_to_current_line("double ");
-            } break;
+        this->current_file->append_to_current_line(node->identifier);
+        this->current_file->append_to_current_line("(");
 
-            case Datatype::DATA_TYPE_COMPLEX:
-            {
-                this->current_file->append_to_current_line("std::complex<double> ");
-            } break;
+        for (i32 i = 0; i < node->dimensions.size(); ++i)
+        {
 
-            case Datatype::DATA_TYPE_UNKNOWN:
-            {
-                this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-            } break;
+            this->current_file->append_to_current_line("(");
+            node->dimensions[i]->accept(this);
+            this->current_file->append_to_current_line(")");
 
-            default:
-            {
-                this->current_file->append_to_current_line("/*unknown*/ int64_t ");
-                //SF_ASSERT(!"Unimplemented or invalid datatype encountered.");
-            };
+            if (i < node->dimensions.size() - 1)
+                this->current_file->append_to_current_line(" * ");
 
         }
-    }
-    else
-    {
 
-        this->current_file->append_to_current_line("dvector<double, ");
-        this->current_file->append_to_current_line(std::to_string(node->structure_length));
-        this->current_file->append_to_current_line("> ");
+        if (scalars) this->current_file->append_to_current_line(" + 1");
+        this->current_file->append_to_current_line(");");
+        return;
 
     }
 
+    this->current_file->append_to_current_line(this->cpp_type_of(node->data_type, node->structure_type,
+        node->structure_length) + " ");
+
     this->current_file->append_to_current_line(node->identifier);
 
     if (node->expression != nullptr)
@@ -1202,6 +887,21 @@ visit(SyntaxNodeWriteStatement* node)
     return;
 }
 
+void TranspileCPPGenerator::    
+visit(SyntaxNodeTemporaryStatement* node)
+{
+
+    // Temporaries are auto, so the expression is evaluated first rather than kept
+    // as a dvector expression template that refers to the temporaries it came from.
+    this->current_file->insert_line_with_tabs("const auto ");
+    this->current_file->append_to_current_line(node->identifier);
+    this->current_file->append_to_current_line(" = cosy_evaluate(");
+    node->expression->accept(this);
+    this->current_file->append_to_current_line(");");
+
+    return;
+}
+
 void TranspileCPPGenerator::    
 visit(SyntaxNodeExpression* node)
 {
@@ -1215,7 +915,10 @@ void TranspileCPPGenerator::
 visit(SyntaxNodeProcedureCall* node)
 {
 
-    this->current_file->append_to_current_line(node->identifier);
+    if (node->intrinsic != nullptr)
+        this->current_file->append_to_current_line(node->intrinsic->runtime_name);
+    else
+        this->current_file->append_to_current_line(node->identifier);
     this->current_file->append_to_current_line("(");
 
     for (i32 i = 0; i < node->arguments.size(); ++i)
@@ -1441,6 +1144,32 @@ void TranspileCPPGenerator::
 visit(SyntaxNodeMagnitude* node)
 {
 
+    // Literal integer and half-integer exponents are unrolled at compile time by the
+    // runtime's ipow templates, see classify_power() and power.hpp.
+    Numericliteral exponent;
+    i64 order = 0;
+    Powertype power = Powertype::POWER_TYPE_GENERAL;
+    if (match_numeric_literal(node->right, exponent))
+        power = classify_power(exponent.real, order);
+
+    if (power == Powertype::POWER_TYPE_ROOT)
+    {
+        this->current_file->append_to_current_line("math_sqrt(");
+        node->left->accept(this);
+        this->current_file->append_to_current_line(")");
+        return;
+    }
+
+    else if (power == Powertype::POWER_TYPE_INTEGER || power == Powertype::POWER_TYPE_HALF)
+    {
+        this->current_file->append_to_current_line(power == Powertype::POWER_TYPE_INTEGER ? "ipow<" : "ipow_half<");
+        this->current_file->append_to_current_line(std::to_string(order));
+        this->current_file->append_to_current_line(">(");
+        node->left->accept(this);
+        this->current_file->append_to_current_line(")");
+        return;
+    }
+
     this->current_file->append_to_current_line("std::pow(");
     node->left->accept(this);
 
@@ -1455,6 +1184,14 @@ void TranspileCPPGenerator::
 visit(SyntaxNodeExtraction* node)
 {
 
+    // Extraction is a vector component or a DA coefficient, the runtime overloads
+    // cosy_extract for both.
+    this->current_file->append_to_current_line("cosy_extract(");
+    node->left->accept(this);
+    this->current_file->append_to_current_line(", ");
+    node->right->accept(this);
+    this->current_file->append_to_current_line(")");
+
     return;
 }
 
@@ -1462,6 +1199,12 @@ void TranspileCPPGenerator::
 visit(SyntaxNodeDerivation* node)
 {
 
+    this->current_file->append_to_current_line("da_derive(");
+    node->left->accept(this);
+    this->current_file->append_to_current_line(", ");
+    node->right->accept(this);
+    this->current_file->append_to_current_line(")");
+
     return;
 }
 
@@ -1479,8 +1222,16 @@ void TranspileCPPGenerator::
 visit(SyntaxNodeFunctionCall* node)
 {
 
-    this->current_file->append_to_current_line("fn_");
-    this->current_file->append_to_current_line(node->identifier);
+    if (node->intrinsic != nullptr)
+    {
+        this->current_file->append_to_current_line(node->intrinsic->runtime_name);
+    }
+    else
+    {
+        this->current_file->append_to_current_line("fn_");
+        this->current_file->append_to_current_line(node->identifier);
+    }
+
     this->current_file->append_to_current_line("(");
 
     for (i32 i = 0; i < node->arguments.size(); ++i)
@@ -1535,7 +1286,7 @@ visit(SyntaxNodePrimary* node)
 
         case Primarytype::PRIMARY_TYPE_COMPLEX:
         {
-            this->current_file->append_to_current_line("std::complex<double>(0.0, ");
+            this->current_file->append_to_current_line("complexd(0.0, ");
             string complex_primitive = node->primitive;
             complex_primitive.pop_back();
             this->current_file->append_to_current_line(complex_primitive);
@@ -1569,4 +1320,158 @@ visit(SyntaxNodeGrouping* node)
     return;
 }
 
+// --- Generator Helpers -------------------------------------------------------
+
+string TranspileCPPGenerator::
+cpp_type_of(Datatype data_type, Structuretype structure_type, i32 structure_length) const
+{
+
+    // Every declaration the generator writes, variables, parameters, function results
+    // and loop iterators, names its type through here. Vectors are only ever real or
+    // complex, and a DA is always real.
+    if (structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL)
+        return "da";
+
+    if (structure_type != Structuretype::STRUCTURE_TYPE_SCALAR &&
+        structure_type != Structuretype::STRUCTURE_TYPE_STRING)
+    {
+        if (data_type == Datatype::DATA_TYPE_COMPLEX)
+            return "complex_vector<" + std::to_string(structure_length) + ">";
+        return "dvector<double, " + std::to_string(structure_length) + ">";
+    }
+
+    switch (data_type)
+    {
+        case Datatype::DATA_TYPE_STRING: return "std::string";
+        case Datatype::DATA_TYPE_INTEGER: return "int64_t";
+        case Datatype::DATA_TYPE_REAL: return "double";
+        case Datatype::DATA_TYPE_COMPLEX: return "complexd";
+        case Datatype::DATA_TYPE_INTERVAL: return "interval";
+        default: return "/*unknown*/ int64_t";
+    }
+
+}
+
+void TranspileCPPGenerator::
+generate_parallel_loop(SyntaxNodeVariableStatement *variable, SyntaxNode *start, SyntaxNode *end,
+        const vector<string> &shared, const vector<std::pair<string, Reductiontype>> &reductions,
+        const vector<SyntaxNode*> &children)
+{
+
+    // The iterations run on the runtime's thread pool, see ploop.hpp, or in worker
+    // processes with --ploop-processes, see transport.hpp. The body is a lambda
+    // capturing by value so every thread works on its own copy of the program's
+    // variables, as every process does in COSY. Each iteration leaves its element of
+    // every shared variable in a slot, and the slots are merged back after the loop.
+    // A reduction's variable starts over every iteration and is accumulated into its
+    // chunk's partial result, and the partials are folded into it instead.
+    this->current_file->insert_line_with_tabs("{");
+    this->current_file->insert_blank_line();
+    this->current_file->push_tabs();
+
+    this->current_file->insert_line_with_tabs("const int64_t sf_ploop_first = ");
+    start->accept(this);
+    this->current_file->append_to_current_line(";");
+    this->current_file->insert_line_with_tabs("const int64_t sf_ploop_last = loop_bound(");
+    end->accept(this);
+    this->current_file->append_to_current_line(");");
 
+    string captures = "[=";
+    string gathers;
+    for (size_t index = 0; index < shared.size(); ++index)
+    {
+        string gather = "sf_ploop_share_" + std::to_string(index);
+        this->current_file->insert_line_with_tabs("ploop_gather<decltype(");
+        this->current_file->append_to_current_line(shared[index]);
+        this->current_file->append_to_current_line(")> " + gather + "(sf_ploop_first, sf_ploop_last);");
+        captures += ", &" + gather;
+        gathers += ", " + gather;
+    }
+
+    for (size_t index = 0; index < reductions.size(); ++index)
+    {
+        string reduction = "sf_ploop_reduce_" + std::to_string(index);
+        string combine;
+        switch (reductions[index].second)
+        {
+            case Reductiontype::REDUCTION_TYPE_SUM: combine = "ploop_sum"; break;
+            case Reductiontype::REDUCTION_TYPE_MAXIMUM: combine = "ploop_maximum"; break;
+            case Reductiontype::REDUCTION_TYPE_MINIMUM: combine = "ploop_minimum"; break;
+        }
+
+        const string &identifier = reductions[index].first;
+        this->current_file->insert_line_with_tabs("ploop_reduction<decltype(" + identifier + "), " + combine +
+            "> " + reduction + "(sf_ploop_first, sf_ploop_last, " + identifier + ");");
+        captures += ", &" + reduction;
+        gathers += ", " + reduction;
+    }
+    captures += "](";
+
+    if (this->options.ploop_processes)
+        this->current_file->insert_line_with_tabs("ploop_distribute(sf_ploop_first, sf_ploop_last, " + captures);
+    else
+        this->current_file->insert_line_with_tabs("ploop_run(sf_ploop_first, sf_ploop_last, " + captures);
+
+    this->current_file->append_to_current_line(this->cpp_type_of(variable->data_type, variable->structure_type,
+        variable->structure_length) + " ");
+    this->current_file->append_to_current_line(variable->identifier);
+    this->current_file->append_to_current_line(") mutable");
+
+    this->current_file->insert_line_with_tabs("{");
+    this->current_file->insert_blank_line();
+    this->current_file->push_tabs();
+
+    for (size_t index = 0; index < reductions.size(); ++index)
+    {
+        this->current_file->insert_line_with_tabs(reductions[index].first + " = sf_ploop_reduce_" +
+            std::to_string(index) + ".start();");
+    }
+
+    for (auto child : children) child->accept(this);
+
+    for (size_t index = 0; index < shared.size(); ++index)
+    {
+        this->current_file->insert_line_with_tabs("sf_ploop_share_" + std::to_string(index) + ".store(");
+        this->current_file->append_to_current_line(variable->identifier);
+        this->current_file->append_to_current_line(", ");
+        this->current_file->append_to_current_line(shared[index]);
+        this->current_file->append_to_current_line(");");
+    }
+
+    for (size_t index = 0; index < reductions.size(); ++index)
+    {
+        this->current_file->insert_line_with_tabs("sf_ploop_reduce_" + std::to_string(index) + ".store(");
+        this->current_file->append_to_current_line(variable->identifier + ", " + reductions[index].first + ");");
+    }
+
+    // Worker processes pack the gathers' elements for the caller, so they're passed on.
+    // On threads a reduction's chunks are passed on as the grain instead.
+    this->current_file->pop_tabs();
+    this->current_file->insert_blank_line();
+    if (this->options.ploop_processes)
+        this->current_file->insert_line_with_tabs("}" + gathers + ");");
+    else if (!reductions.empty())
+        this->current_file->insert_line_with_tabs("}, sf_ploop_reduce_0.grain());");
+    else
+        this->current_file->insert_line_with_tabs("});");
+
+    for (size_t index = 0; index < shared.size(); ++index)
+    {
+        this->current_file->insert_line_with_tabs("sf_ploop_share_" + std::to_string(index) + ".merge(");
+        this->current_file->append_to_current_line(shared[index]);
+        this->current_file->append_to_current_line(");");
+    }
+
+    for (size_t index = 0; index < reductions.size(); ++index)
+    {
+        this->current_file->insert_line_with_tabs("sf_ploop_reduce_" + std::to_string(index) + ".merge(");
+        this->current_file->append_to_current_line(reductions[index].first + ");");
+    }
+
+    this->current_file->pop_tabs();
+    this->current_file->insert_blank_line();
+    this->current_file->insert_line_with_tabs("}");
+    this->current_file->insert_blank_line();
+
+    return;
+}
@@ -5,16 +5,45 @@
 #include <compiler/generation/sourcefile.hpp>
 #include <compiler/generation/sourcetree.hpp>
 
+// --- Generator Options -------------------------------------------------------
+//
+// Settings from the command line that change the code the generator emits.
+//
+// strict_ieee, set by --strict-ieee, builds the output with SF_COMPLEX_STRICT_IEEE so
+// complex values are std::complex<double> with its full IEEE semantics, rather than
+// the runtime's faster complex type.
+//
+// ploop_processes, set by --ploop-processes, runs PLOOP iterations in forked worker
+// processes that hand their results back through shared memory, rather than on the
+// runtime's thread pool.
+//
+// vectorization_report, set by --vectorization-report, compiles the output once it's
+// written and reports which of its loops the compiler vectorized, see vectorization.hpp.
+//
+
+class Generatoroptions
+{
+
+    public:
+        bool    strict_ieee = false;
+        bool    ploop_processes = false;
+        bool    vectorization_report = false;
+
+};
+
 class TranspileCPPGenerator : public SyntaxNodeVisitor
 {
     public:
                         TranspileCPPGenerator();
                         TranspileCPPGenerator(string output);
+                        TranspileCPPGenerator(string output, Generatoroptions options);
         virtual        ~TranspileCPPGenerator();
 
         void            dump_output();
         void            generate_files();
 
+        string          get_entry_file() const;
+
     public:
         virtual void    visit(SyntaxNodeRoot* node)                     override;
         virtual void    visit(SyntaxNodeModule* node)                   override;
@@ -31,6 +60,7 @@ class TranspileCPPGenerator : public SyntaxNodeVisitor
         virtual void    visit(SyntaxNodeConditionalStatement* node)     override;
         virtual void    visit(SyntaxNodeReadStatement* node)            override;
         virtual void    visit(SyntaxNodeWriteStatement* node)           override;
+        virtual void    visit(SyntaxNodeTemporaryStatement* node)       override;
         virtual void    visit(SyntaxNodeExpression* node)               override;
         virtual void    visit(SyntaxNodeProcedureCall* node)            override;
         virtual void    visit(SyntaxNodeAssignment* node)               override;
@@ -48,13 +78,23 @@ class TranspileCPPGenerator : public SyntaxNodeVisitor
         virtual void    visit(SyntaxNodePrimary* node)                  override;
         virtual void    visit(SyntaxNodeGrouping* node)                 override;
 
+    protected:
+        string          cpp_type_of(Datatype data_type, Structuretype structure_type, i32 structure_length) const;
+        void            generate_parallel_loop(SyntaxNodeVariableStatement *variable, SyntaxNode *start,
+                            SyntaxNode *end, const vector<string> &shared,
+                            const vector<std::pair<string, Reductiontype>> &reductions,
+                            const vector<SyntaxNode*> &children);
+
     protected:
         string output;
+        Generatoroptions options;
         vector<shared_ptr<GeneratableSourcefile>> source_files;
         shared_ptr<GeneratableSourcefile> main_file;
         shared_ptr<GeneratableSourcefile> current_file;
         shared_ptr<GeneratableSourcefile> cmake_file;
         stack<shared_ptr<GeneratableSourcefile>> source_stack;
+        string source_name;
+        i32 loop_count = 0;
     
 };
 
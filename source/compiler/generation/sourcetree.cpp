@@ -82,36 +82,41 @@ commit() const
     }
 
     // Copy the library files.
-    std::filesystem::path sourcePath("./library/dvector.hpp");
-    std::filesystem::path targetPath(this->output_directory + "./library/dvector.hpp");
-    std::filesystem::path targetDir = targetPath.parent_path();
+    for (auto library_file : runtime_library_files)
+    {
 
-    if (!std::filesystem::exists(sourcePath)) {
-        std::cerr << "Source file does not exist: " << sourcePath << std::endl;
-        return false;
-    }
+        std::filesystem::path sourcePath("./library/" + library_file);
+        std::filesystem::path targetPath(this->output_directory + "/library/" + library_file);
+        std::filesystem::path targetDir = targetPath.parent_path();
 
-    if (!targetDir.empty() && !std::filesystem::exists(targetDir)) {
-        if (!std::filesystem::create_directories(targetDir)) {
-            std::cerr << "Failed to create target directory: " << targetDir << std::endl;
+        if (!std::filesystem::exists(sourcePath)) {
+            std::cerr << "Source file does not exist: " << sourcePath << std::endl;
             return false;
         }
-    }
 
-    std::ifstream inFile(sourcePath, std::ios::binary);
-    if (!inFile) {
-        std::cerr << "Failed to open source file: " << sourcePath << std::endl;
-        return false;
-    }
+        if (!targetDir.empty() && !std::filesystem::exists(targetDir)) {
+            if (!std::filesystem::create_directories(targetDir)) {
+                std::cerr << "Failed to create target directory: " << targetDir << std::endl;
+                return false;
+            }
+        }
 
-    std::ofstream outFile(targetPath, std::ios::binary);
-    if (!outFile) {
-        std::cerr << "Failed to open target file: " << targetPath << std::endl;
-        return false;
-    }
+        std::ifstream inFile(sourcePath, std::ios::binary);
+        if (!inFile) {
+            std::cerr << "Failed to open source file: " << sourcePath << std::endl;
+            return false;
+        }
+
+        std::ofstream outFile(targetPath, std::ios::binary);
+        if (!outFile) {
+            std::cerr << "Failed to open target file: " << targetPath << std::endl;
+            return false;
+        }
 
-    std::cout << "-- Outputting: " << this->output_directory << "/dvector.hpp" << std::endl;
-    outFile << inFile.rdbuf();
+        std::cout << "-- Outputting: " << targetPath.string() << std::endl;
+        outFile << inFile.rdbuf();
+
+    }
 
     return true;
 }
@@ -3,6 +3,29 @@
 #include <definitions.hpp>
 #include <compiler/generation/sourcefile.hpp>
 
+// --- Runtime Library ---------------------------------------------------------
+//
+// The headers from ./library that generated sources depend on. They're copied into
+// the library folder of the output directory and listed in the generated CMake.
+//
+
+inline const vector<string> runtime_library_files =
+{
+    "dvector.hpp",
+    "simd.hpp",
+    "pool.hpp",
+    "bunch.hpp",
+    "da.hpp",
+    "map.hpp",
+    "elements.hpp",
+    "interval.hpp",
+    "complex.hpp",
+    "transcendental.hpp",
+    "power.hpp",
+    "ploop.hpp",
+    "transport.hpp",
+};
+
 class Sourcetree
 {
 
@@ -0,0 +1,208 @@
+#include <compiler/generation/vectorization.hpp>
+#include <platform/system.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+Vectorizationreport::
+Vectorizationreport(string output_directory, string entry_file)
+    : output_directory(output_directory), entry_file(entry_file)
+{
+
+}
+
+Vectorizationreport::
+~Vectorizationreport()
+{
+
+}
+
+const vector<string>& Vectorizationreport::
+get_report() const
+{
+
+    return this->lines;
+
+}
+
+bool Vectorizationreport::
+collect()
+{
+
+    const char *requested = std::getenv("CXX");
+    string compiler = (requested != nullptr && *requested != '\0') ? requested : "c++";
+
+    string version;
+    system_execute((compiler + " --version 2>&1").c_str(), version);
+    bool clang = version.find("clang") != string::npos;
+
+    // Optimized as a release build would be, the object file is thrown away.
+    string entry = this->output_directory + "/" + this->entry_file;
+    string object = this->output_directory + "/vectorization.o";
+    string command = compiler + " -std=c++17 -O3 -fopenmp-simd -pthread -I\"" + this->output_directory +
+        "/library\" -c \"" + entry + "\" -o \"" + object + "\"";
+    if (clang)
+        command += " -Rpass=loop-vectorize -Rpass-missed=loop-vectorize -Rpass-analysis=loop-vectorize";
+    else
+        command += " -fopt-info-vec-all";
+    command += " 2>&1";
+
+    string output;
+    i32 status = system_execute(command.c_str(), output);
+    std::remove(object.c_str());
+    if (status != 0)
+    {
+        this->lines.push_back(this->entry_file + " didn't compile with " + compiler +
+            ", there's no vectorization report.");
+        return false;
+    }
+
+    // Loops are found in the entry file up front and in any other file a diagnostic
+    // points into, the headers generated for included modules.
+    vector<string> files = { entry };
+    unordered_map<string, vector<Loop>> loops;
+    this->find_loops(entry, loops[entry]);
+
+    std::istringstream stream(output);
+    string line;
+    while (std::getline(stream, line))
+    {
+
+        Diagnostic diagnostic;
+        if (!this->parse_diagnostic(line, diagnostic)) continue;
+        if (diagnostic.file.find("/library/") != string::npos) continue;
+
+        if (loops.find(diagnostic.file) == loops.end())
+        {
+            files.push_back(diagnostic.file);
+            this->find_loops(diagnostic.file, loops[diagnostic.file]);
+        }
+
+        // The innermost loop around the line, the one with the shortest span.
+        Loop *owner = nullptr;
+        for (auto &loop : loops[diagnostic.file])
+        {
+            if (diagnostic.line < loop.first || diagnostic.line > loop.last) continue;
+            if (owner == nullptr || loop.last - loop.first < owner->last - owner->first) owner = &loop;
+        }
+
+        if (owner == nullptr) continue;
+
+        // GCC says loop vectorized using 32 byte vectors, Clang says vectorized loop
+        // (vectorization width: 4, ...), the rest is the detail worth keeping.
+        const string &message = diagnostic.message;
+        if (message.rfind("loop vectorized", 0) == 0 || message.rfind("vectorized loop", 0) == 0)
+        {
+            if (!owner->vectorized) owner->reason = message.substr(15);
+            owner->vectorized = true;
+            continue;
+        }
+
+        size_t reason = message.find("not vectorized: ");
+        if (!owner->vectorized && owner->reason.empty() && reason != string::npos)
+            owner->reason = message.substr(reason + 16);
+
+    }
+
+    for (auto &file : files)
+    {
+
+        for (auto &loop : loops[file])
+        {
+
+            string reason = loop.reason;
+            while (!reason.empty() && (reason.back() == ';' || reason.back() == '.' || reason.back() == ' '))
+                reason.pop_back();
+
+            if (loop.vectorized)
+                this->lines.push_back(loop.source + " is vectorized" + reason + ".");
+            else if (!reason.empty())
+                this->lines.push_back(loop.source + " isn't vectorized, " + reason + ".");
+            else
+                this->lines.push_back(loop.source + " isn't vectorized, the compiler gave no reason.");
+
+        }
+
+    }
+
+    return true;
+
+}
+
+bool Vectorizationreport::
+parse_diagnostic(const string &line, Diagnostic &diagnostic) const
+{
+
+    // file:line:column: kind: message, where only the kinds the vectorizer uses count.
+    // The file can hold a colon of its own on Windows, so the kind is found first.
+    static const vector<string> kinds = { ": optimized: ", ": missed: ", ": remark: " };
+
+    size_t kind = string::npos;
+    size_t length = 0;
+    for (auto &candidate : kinds)
+    {
+        kind = line.find(candidate);
+        length = candidate.length();
+        if (kind != string::npos) break;
+    }
+
+    if (kind == string::npos) return false;
+
+    size_t column = line.rfind(':', kind - 1);
+    if (column == string::npos || column == 0) return false;
+    size_t row = line.rfind(':', column - 1);
+    if (row == string::npos) return false;
+
+    string number = line.substr(row + 1, column - row - 1);
+    if (number.empty() || number.find_first_not_of("0123456789") != string::npos) return false;
+
+    diagnostic.file = line.substr(0, row);
+    diagnostic.line = (i32)std::stol(number);
+    diagnostic.message = line.substr(kind + length);
+
+    // Clang ends its remarks with the flag that asked for them.
+    size_t flag = diagnostic.message.rfind(" [-R");
+    if (flag != string::npos) diagnostic.message.erase(flag);
+    return true;
+
+}
+
+void Vectorizationreport::
+find_loops(const string &file, vector<Loop> &loops) const
+{
+
+    std::ifstream stream(file);
+    vector<string> source;
+    string line;
+    while (std::getline(stream, line)) source.push_back(line);
+
+    for (size_t index = 0; index < source.size(); ++index)
+    {
+
+        size_t indent = source[index].find_first_not_of(' ');
+        if (indent == string::npos || source[index].compare(indent, 3, "// ") != 0) continue;
+        if (source[index].find(" LOOP ", indent) == string::npos) continue;
+
+        // The loop ends at the first closing brace back at the comment's indentation
+        // after the for statement itself.
+        size_t statement = index + 1;
+        while (statement < source.size() &&
+            (source[statement].size() < indent || source[statement].compare(indent, 5, "for (") != 0))
+        {
+            statement++;
+        }
+
+        string closing = string(indent, ' ') + "}";
+        size_t end = statement + 1;
+        while (end < source.size() && source[end] != closing) end++;
+
+        Loop loop;
+        loop.source = source[index].substr(indent + 3);
+        loop.first = (i32)index + 1;
+        loop.last = (i32)end + 1;
+        loops.push_back(loop);
+
+    }
+
+}
@@ -0,0 +1,57 @@
+#ifndef SIGMAFOX_COMPILER_GENERATION_VECTORIZATION_HPP
+#define SIGMAFOX_COMPILER_GENERATION_VECTORIZATION_HPP
+#include <definitions.hpp>
+
+// --- Vectorization Report ----------------------------------------------------
+//
+// Set by --vectorization-report. Once the output is written, the generated entry
+// file is compiled the way a release build would compile it, with the compiler's
+// vectorizer diagnostics turned on: -fopt-info-vec-all for GCC, the loop-vectorize
+// remarks for Clang. The compiler is $CXX, or c++ when that isn't set.
+//
+// The generator puts a comment naming the COSY source line above every loop it emits
+// as a for statement, // t.fox:12 LOOP I, so each diagnostic is matched to the
+// innermost generated loop around the line it points at. A loop is vectorized when
+// the compiler says so anywhere in it, otherwise the first reason it gave is the one
+// reported. Diagnostics inside the runtime library are left out, they belong to its
+// kernels rather than to the program's loops.
+//
+
+class Vectorizationreport
+{
+
+    public:
+                        Vectorizationreport(string output_directory, string entry_file);
+        virtual        ~Vectorizationreport();
+
+        bool            collect();
+        const vector<string>&   get_report() const;
+
+    protected:
+        struct Loop
+        {
+            string      source;
+            i32         first;
+            i32         last;
+            bool        vectorized = false;
+            string      reason;
+        };
+
+        struct Diagnostic
+        {
+            string      file;
+            i32         line;
+            string      message;
+        };
+
+        bool            parse_diagnostic(const string &line, Diagnostic &diagnostic) const;
+        void            find_loops(const string &file, vector<Loop> &loops) const;
+
+    protected:
+        string          output_directory;
+        string          entry_file;
+        vector<string>  lines;
+
+};
+
+#endif
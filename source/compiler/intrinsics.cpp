@@ -0,0 +1,98 @@
+#include <compiler/intrinsics.hpp>
+#include <algorithm>
+#include <cctype>
+
+// --- Intrinsic Table ---------------------------------------------------------
+//
+// Names are stored upper-case. The runtime names are the free functions in the
+// runtime library that the generator emits in place of the call.
+//
+
+static const vector<Intrinsic> intrinsic_table =
+{
+
+    // Reductions and BLAS-1 routines over vectors, see dvector.hpp.
+    { "DOT",    "dvector_dot",  { Structuretype::STRUCTURE_TYPE_VECTOR, Structuretype::STRUCTURE_TYPE_VECTOR },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+    { "NORM",   "dvector_norm", { Structuretype::STRUCTURE_TYPE_VECTOR },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+    { "VSUM",   "dvector_sum",  { Structuretype::STRUCTURE_TYPE_VECTOR },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+    { "VMIN",   "dvector_min",  { Structuretype::STRUCTURE_TYPE_VECTOR },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+    { "VMAX",   "dvector_max",  { Structuretype::STRUCTURE_TYPE_VECTOR },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+    { "AXPY",   "dvector_axpy", { Structuretype::STRUCTURE_TYPE_SCALAR, Structuretype::STRUCTURE_TYPE_VECTOR,
+        Structuretype::STRUCTURE_TYPE_VECTOR }, Intrinsicresult::INTRINSIC_RESULT_ARGUMENT, 1, true },
+
+    // Elementary functions, see transcendental.hpp. Vectors go through the batched
+    // kernels, scalars through libm.
+    { "SIN",    "math_sin",     { Structuretype::STRUCTURE_TYPE_UNKNOWN },
+        Intrinsicresult::INTRINSIC_RESULT_ARGUMENT, 0, true },
+    { "COS",    "math_cos",     { Structuretype::STRUCTURE_TYPE_UNKNOWN },
+        Intrinsicresult::INTRINSIC_RESULT_ARGUMENT, 0, true },
+    { "EXP",    "math_exp",     { Structuretype::STRUCTURE_TYPE_UNKNOWN },
+        Intrinsicresult::INTRINSIC_RESULT_ARGUMENT, 0, true },
+    { "SQRT",   "math_sqrt",    { Structuretype::STRUCTURE_TYPE_UNKNOWN },
+        Intrinsicresult::INTRINSIC_RESULT_ARGUMENT, 0, true },
+
+    // Differential algebra, see da.hpp. DA depends on the order and variable count
+    // that OV sets up, so it isn't pure.
+    { "OV",     "da_initialize", { Structuretype::STRUCTURE_TYPE_SCALAR, Structuretype::STRUCTURE_TYPE_SCALAR,
+        Structuretype::STRUCTURE_TYPE_SCALAR }, Intrinsicresult::INTRINSIC_RESULT_NONE, 0, false, true },
+    { "DA",     "da_variable",  { Structuretype::STRUCTURE_TYPE_SCALAR },
+        Intrinsicresult::INTRINSIC_RESULT_DIFFERENTIAL, 0, false },
+    { "CONS",   "da_constant",  { Structuretype::STRUCTURE_TYPE_DIFFERENTIAL },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+
+    // Intervals, see interval.hpp. INTV makes the interval between two reals, which
+    // is what makes a variable an interval.
+    { "INTV",   "interval_make", { Structuretype::STRUCTURE_TYPE_SCALAR, Structuretype::STRUCTURE_TYPE_SCALAR },
+        Intrinsicresult::INTRINSIC_RESULT_INTERVAL, 0, true },
+    { "INL",    "interval_lower", { Structuretype::STRUCTURE_TYPE_SCALAR },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+    { "INU",    "interval_upper", { Structuretype::STRUCTURE_TYPE_SCALAR },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+    { "WIDTH",  "interval_width", { Structuretype::STRUCTURE_TYPE_SCALAR },
+        Intrinsicresult::INTRINSIC_RESULT_SCALAR, 0, true },
+
+    // Transfer maps, arrays of DA, see map.hpp. Both return through their last
+    // arguments: COMPOSE M N R sets R to M(N), APPLYMAP M P T tracks the particles of
+    // the array of vectors P through T turns of M.
+    { "COMPOSE",  "cosy_compose", { Structuretype::STRUCTURE_TYPE_DIFFERENTIAL,
+        Structuretype::STRUCTURE_TYPE_DIFFERENTIAL, Structuretype::STRUCTURE_TYPE_DIFFERENTIAL },
+        Intrinsicresult::INTRINSIC_RESULT_NONE, 0, false, true },
+    { "APPLYMAP", "cosy_apply_map", { Structuretype::STRUCTURE_TYPE_DIFFERENTIAL,
+        Structuretype::STRUCTURE_TYPE_VECTOR, Structuretype::STRUCTURE_TYPE_SCALAR },
+        Intrinsicresult::INTRINSIC_RESULT_NONE, 0, false, true },
+
+    // Optical elements over an array of vectors, see elements.hpp. DRIFT P L, KICK P N K
+    // for a thin 2(N+1)-pole, QUAD P L K and BEND P L ANGLE for a sector dipole.
+    { "DRIFT",  "element_drift", { Structuretype::STRUCTURE_TYPE_VECTOR, Structuretype::STRUCTURE_TYPE_SCALAR },
+        Intrinsicresult::INTRINSIC_RESULT_NONE, 0, false, true },
+    { "KICK",   "element_thin_kick", { Structuretype::STRUCTURE_TYPE_VECTOR, Structuretype::STRUCTURE_TYPE_SCALAR,
+        Structuretype::STRUCTURE_TYPE_SCALAR }, Intrinsicresult::INTRINSIC_RESULT_NONE, 0, false, true },
+    { "QUAD",   "element_quadrupole", { Structuretype::STRUCTURE_TYPE_VECTOR, Structuretype::STRUCTURE_TYPE_SCALAR,
+        Structuretype::STRUCTURE_TYPE_SCALAR }, Intrinsicresult::INTRINSIC_RESULT_NONE, 0, false, true },
+    { "BEND",   "element_dipole", { Structuretype::STRUCTURE_TYPE_VECTOR, Structuretype::STRUCTURE_TYPE_SCALAR,
+        Structuretype::STRUCTURE_TYPE_SCALAR }, Intrinsicresult::INTRINSIC_RESULT_NONE, 0, false, true },
+
+};
+
+const Intrinsic*
+intrinsic_lookup(string identifier)
+{
+
+    std::transform(identifier.begin(), identifier.end(), identifier.begin(),
+        [](unsigned char c) { return (char)std::toupper(c); });
+
+    for (const Intrinsic& intrinsic : intrinsic_table)
+    {
+
+        if (intrinsic.name == identifier) return &intrinsic;
+
+    }
+
+    return nullptr;
+
+}
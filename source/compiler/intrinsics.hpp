@@ -0,0 +1,50 @@
+#ifndef SIGMAFOX_COMPILER_INTRINSICS_HPP
+#define SIGMAFOX_COMPILER_INTRINSICS_HPP
+#include <definitions.hpp>
+#include <compiler/parser/node.hpp>
+
+// --- Intrinsics --------------------------------------------------------------
+//
+// Intrinsics are the built-in functions that map directly onto routines in the
+// runtime library rather than onto a user defined function. They're looked up
+// case-insensitively, like the rest of COSY, but only when an identifier doesn't
+// resolve to a user symbol, so a user function of the same name always wins.
+//
+// Each intrinsic lists the structure it expects for every parameter, where an
+// unknown structure accepts anything. All vector arguments to an intrinsic must
+// share the same length. The result is a real scalar, a DA vector, nothing for an
+// intrinsic procedure, or a real with the shape of the argument at shape_argument.
+//
+// Intrinsic procedures are invoked as statements with space separated arguments,
+// like user procedures, rather than with a parenthesized argument list.
+//
+// Pure intrinsics have no side effects and always return the same result for the
+// same arguments, which later passes rely on to move or merge calls safely.
+//
+
+enum class Intrinsicresult
+{
+    INTRINSIC_RESULT_SCALAR,
+    INTRINSIC_RESULT_ARGUMENT,
+    INTRINSIC_RESULT_DIFFERENTIAL,
+    INTRINSIC_RESULT_INTERVAL,
+    INTRINSIC_RESULT_NONE,
+};
+
+class Intrinsic
+{
+
+    public:
+        string                  name;
+        string                  runtime_name;
+        vector<Structuretype>   parameters;
+        Intrinsicresult         result;
+        i32                     shape_argument;
+        bool                    pure;
+        bool                    procedure = false;
+
+};
+
+const Intrinsic*    intrinsic_lookup(string identifier);
+
+#endif
@@ -0,0 +1,310 @@
+#include <map>
+#include <compiler/optimization/eliminator.hpp>
+
+SubexpressionEliminator::
+SubexpressionEliminator(vector<shared_ptr<SyntaxNode>> *nodes)
+    : nodes(nodes), temporary_count(0)
+{
+
+}
+
+SubexpressionEliminator::
+~SubexpressionEliminator()
+{
+
+}
+
+// --- Blocks ------------------------------------------------------------------
+//
+// Every statement list is a sequence of basic blocks. Statements that own a body
+// are visited so their own bodies are handled, the rest are left to eliminate().
+//
+
+void SubexpressionEliminator::
+visit(SyntaxNodeRoot* node)
+{
+
+    this->eliminate(node->children);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeModule* node)
+{
+
+    if (node->root != nullptr) node->root->accept(this);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeMain* node)
+{
+
+    this->eliminate(node->children);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeIncludeStatement* node)
+{
+
+    if (node->module != nullptr) node->module->accept(this);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeFunctionStatement* node)
+{
+
+    this->eliminate(node->children);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeProcedureStatement* node)
+{
+
+    this->eliminate(node->children);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeWhileStatement* node)
+{
+
+    this->eliminate(node->children);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodePloopStatement* node)
+{
+
+    this->eliminate(node->children);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeLoopStatement* node)
+{
+
+    this->eliminate(node->children);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeScopeStatement* node)
+{
+
+    this->eliminate(node->children);
+
+}
+
+void SubexpressionEliminator::
+visit(SyntaxNodeConditionalStatement* node)
+{
+
+    this->eliminate(node->children);
+    if (node->next != nullptr) node->next->accept(this);
+
+}
+
+// --- Elimination -------------------------------------------------------------
+
+void SubexpressionEliminator::
+eliminate(vector<SyntaxNode*> &children)
+{
+
+    for (auto child : children) child->accept(this);
+
+    vector<Expressioncandidate> candidates;
+    size_t index = 0;
+    while (index < children.size())
+    {
+
+        if (!this->collect_statement(children[index], candidates))
+        {
+            index++;
+            continue;
+        }
+
+        size_t end = index + 1;
+        while (end < children.size() && this->collect_statement(children[end], candidates)) end++;
+        candidates.clear();
+
+        end += this->eliminate_segment(children, index, end);
+        index = end;
+
+    }
+
+}
+
+size_t SubexpressionEliminator::
+eliminate_segment(vector<SyntaxNode*> &children, size_t begin, size_t end)
+{
+
+    // Each pass groups every occurrence of each expression until a variable it reads
+    // is assigned, then hoists the largest group that repeats. Hoisting changes the
+    // statements, so the groups are rebuilt until nothing repeats.
+    size_t inserted = 0;
+    while (true)
+    {
+
+        std::map<string, Group> open;
+        vector<Group> closed;
+
+        for (size_t statement = begin; statement < end; ++statement)
+        {
+
+            vector<Expressioncandidate> candidates;
+            this->collect_statement(children[statement], candidates);
+            for (auto &candidate : candidates)
+            {
+                auto group = open.find(candidate.description.key);
+                if (group == open.end())
+                {
+                    Group created = { candidate.description, statement, {} };
+                    group = open.emplace(candidate.description.key, created).first;
+                }
+                group->second.slots.push_back(candidate.slot);
+            }
+
+            // The statement reads its operands before it assigns.
+            string assigned = this->assigned_identifier(children[statement]);
+            if (assigned.empty()) continue;
+            for (auto group = open.begin(); group != open.end();)
+            {
+                if (group->second.description.reads.count(assigned) == 0)
+                {
+                    ++group;
+                    continue;
+                }
+                closed.push_back(std::move(group->second));
+                group = open.erase(group);
+            }
+
+        }
+
+        for (auto &group : open) closed.push_back(std::move(group.second));
+
+        Group *best = nullptr;
+        for (auto &group : closed)
+        {
+            if (group.slots.size() < 2) continue;
+            if (best == nullptr || group.description.size > best->description.size ||
+                (group.description.size == best->description.size &&
+                 group.first_statement < best->first_statement))
+            {
+                best = &group;
+            }
+        }
+
+        if (best == nullptr) return inserted;
+
+        auto *temporary = new SyntaxNodeTemporaryStatement();
+        this->nodes->push_back(shared_ptr<SyntaxNode>(temporary));
+        temporary->identifier = "sf_cse_" + std::to_string(this->temporary_count++);
+        temporary->expression = *best->slots[0];
+
+        for (auto slot : best->slots)
+        {
+            auto *reference = new SyntaxNodePrimary();
+            this->nodes->push_back(shared_ptr<SyntaxNode>(reference));
+            reference->primarytype = Primarytype::PRIMARY_TYPE_IDENTIFIER;
+            reference->primitive = temporary->identifier;
+            *slot = reference;
+        }
+
+        children.insert(children.begin() + best->first_statement, temporary);
+        inserted++;
+        end++;
+
+    }
+
+}
+
+bool SubexpressionEliminator::
+collect_statement(SyntaxNode *statement, vector<Expressioncandidate> &candidates) const
+{
+
+    // Returns false for statements that end a basic block.
+    Expressiondescription description;
+    switch (statement->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_EXPRESSION_STATEMENT:
+        {
+            auto *expression_statement = (SyntaxNodeExpressionStatement*)statement;
+            auto *assignment = dynamic_cast<SyntaxNodeAssignment*>(expression_statement->expression);
+            if (assignment == nullptr)
+                return describe_expression(&expression_statement->expression, description, candidates);
+
+            Expressiondescription left;
+            return describe_expression(&assignment->left, left, candidates) &&
+                describe_expression(&assignment->right, description, candidates);
+        }
+
+        case Nodetype::NODE_TYPE_VARIABLE_STATEMENT:
+        {
+            auto *variable = (SyntaxNodeVariableStatement*)statement;
+            if (variable->expression == nullptr) return true;
+            return describe_expression(&variable->expression, description, candidates);
+        }
+
+        case Nodetype::NODE_TYPE_TEMPORARY_STATEMENT:
+        {
+            auto *temporary = (SyntaxNodeTemporaryStatement*)statement;
+            return describe_expression(&temporary->expression, description, candidates);
+        }
+
+        case Nodetype::NODE_TYPE_READ_STATEMENT:
+        {
+            return true;
+        }
+
+        case Nodetype::NODE_TYPE_WRITE_STATEMENT:
+        {
+            auto *write = (SyntaxNodeWriteStatement*)statement;
+            for (auto &expression : write->expressions)
+            {
+                Expressiondescription written;
+                if (!describe_expression(&expression, written, candidates)) return false;
+            }
+            return true;
+        }
+
+        default:
+        {
+            return false;
+        }
+
+    }
+
+}
+
+string SubexpressionEliminator::
+assigned_identifier(SyntaxNode *statement) const
+{
+
+    switch (statement->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_EXPRESSION_STATEMENT:
+        {
+            auto *expression_statement = (SyntaxNodeExpressionStatement*)statement;
+            auto *assignment = dynamic_cast<SyntaxNodeAssignment*>(expression_statement->expression);
+            return assignment != nullptr ? assignment->identifier : "";
+        }
+
+        case Nodetype::NODE_TYPE_VARIABLE_STATEMENT:
+            return ((SyntaxNodeVariableStatement*)statement)->identifier;
+
+        case Nodetype::NODE_TYPE_READ_STATEMENT:
+            return ((SyntaxNodeReadStatement*)statement)->identifier;
+
+        default:
+            return "";
+
+    }
+
+}
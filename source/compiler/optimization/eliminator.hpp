@@ -0,0 +1,60 @@
+#ifndef SIGMAFOX_COMPILER_OPTIMIZATION_ELIMINATOR_HPP
+#define SIGMAFOX_COMPILER_OPTIMIZATION_ELIMINATOR_HPP
+#include <definitions.hpp>
+#include <compiler/parser/visitor.hpp>
+#include <compiler/optimization/expressions.hpp>
+
+// --- Subexpression Eliminator ------------------------------------------------
+//
+// Finds pure subexpressions that repeat within a basic block, such as SQRT(K)*L in
+// several consecutive assignments, and computes each one once into a temporary
+// statement placed before its first use. The generator writes temporaries as const
+// auto, so the temporary costs nothing beyond the value it holds.
+//
+// A basic block is a run of assignments, declarations, reads and writes. Anything
+// with control flow, a procedure call or a call to a user function ends the block,
+// since those can change variables the expressions read. Two subexpressions match
+// when they have the same structure and no variable they read is assigned between
+// them. Only intrinsics marked pure take part, and the largest repeated expression
+// is hoisted first so its pieces aren't split out on their own.
+//
+
+class SubexpressionEliminator : public SyntaxNodeVisitor
+{
+    public:
+                        SubexpressionEliminator(vector<shared_ptr<SyntaxNode>> *nodes);
+        virtual        ~SubexpressionEliminator();
+
+        virtual void    visit(SyntaxNodeRoot* node) override;
+        virtual void    visit(SyntaxNodeModule* node) override;
+        virtual void    visit(SyntaxNodeMain* node) override;
+        virtual void    visit(SyntaxNodeIncludeStatement* node) override;
+        virtual void    visit(SyntaxNodeFunctionStatement* node) override;
+        virtual void    visit(SyntaxNodeProcedureStatement* node) override;
+        virtual void    visit(SyntaxNodeWhileStatement* node) override;
+        virtual void    visit(SyntaxNodePloopStatement* node) override;
+        virtual void    visit(SyntaxNodeLoopStatement* node) override;
+        virtual void    visit(SyntaxNodeScopeStatement* node) override;
+        virtual void    visit(SyntaxNodeConditionalStatement* node) override;
+
+    protected:
+        struct Group
+        {
+            Expressiondescription description;
+            size_t              first_statement;
+            vector<SyntaxNode**> slots;
+        };
+
+        void            eliminate(vector<SyntaxNode*> &children);
+        size_t          eliminate_segment(vector<SyntaxNode*> &children, size_t begin, size_t end);
+
+        bool            collect_statement(SyntaxNode *statement, vector<Expressioncandidate> &candidates) const;
+        string          assigned_identifier(SyntaxNode *statement) const;
+
+    protected:
+        vector<shared_ptr<SyntaxNode>>     *nodes;
+        i32                                 temporary_count;
+
+};
+
+#endif
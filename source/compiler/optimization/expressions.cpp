@@ -0,0 +1,243 @@
+#include <cmath>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <compiler/optimization/expressions.hpp>
+
+bool
+describe_expression(SyntaxNode **slot, Expressiondescription &description,
+        vector<Expressioncandidate> &candidates)
+{
+
+    SyntaxNode *node = *slot;
+    description.size++;
+
+    bool candidate = false;
+    bool pure = true;
+    switch (node->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_PRIMARY:
+        {
+            auto *primary = (SyntaxNodePrimary*)node;
+            description.key += primarytype_to_string(primary->primarytype) + ":" + primary->primitive;
+            if (primary->primarytype == Primarytype::PRIMARY_TYPE_IDENTIFIER)
+                description.reads.insert(primary->primitive);
+            return true;
+        }
+
+        case Nodetype::NODE_TYPE_GROUPING:
+        {
+            // Parentheses are only there for the generator, the candidate is inside.
+            description.size--;
+            return describe_expression(&((SyntaxNodeGrouping*)node)->expression, description, candidates);
+        }
+
+        case Nodetype::NODE_TYPE_UNARY:
+        {
+            auto *unary = (SyntaxNodeUnary*)node;
+            Nodetype operand = unary->expression->get_nodetype();
+            candidate = operand != Nodetype::NODE_TYPE_PRIMARY && operand != Nodetype::NODE_TYPE_ARRAY_INDEX;
+
+            Expressiondescription inner;
+            pure = describe_expression(&unary->expression, inner, candidates);
+            description.key += "-(" + inner.key + ")";
+            description.reads.insert(inner.reads.begin(), inner.reads.end());
+            description.size += inner.size;
+        } break;
+
+        case Nodetype::NODE_TYPE_TERM:
+        case Nodetype::NODE_TYPE_FACTOR:
+        case Nodetype::NODE_TYPE_MAGNITUDE:
+        case Nodetype::NODE_TYPE_EXTRACTION:
+        case Nodetype::NODE_TYPE_DERIVATION:
+        case Nodetype::NODE_TYPE_EQUALITY:
+        case Nodetype::NODE_TYPE_COMPARISON:
+        case Nodetype::NODE_TYPE_CONCATENATION:
+        {
+
+            // All of these share the same left, operation, right layout.
+            Operationtype operation = Operationtype::OPERATION_TYPE_UNKNOWN;
+            switch (node->get_nodetype())
+            {
+                case Nodetype::NODE_TYPE_TERM:          operation = ((SyntaxNodeTerm*)node)->operation; break;
+                case Nodetype::NODE_TYPE_FACTOR:        operation = ((SyntaxNodeFactor*)node)->operation; break;
+                case Nodetype::NODE_TYPE_MAGNITUDE:     operation = ((SyntaxNodeMagnitude*)node)->operation; break;
+                case Nodetype::NODE_TYPE_EXTRACTION:    operation = ((SyntaxNodeExtraction*)node)->operation; break;
+                case Nodetype::NODE_TYPE_DERIVATION:    operation = ((SyntaxNodeDerivation*)node)->operation; break;
+                case Nodetype::NODE_TYPE_EQUALITY:      operation = ((SyntaxNodeEquality*)node)->operation; break;
+                case Nodetype::NODE_TYPE_COMPARISON:    operation = ((SyntaxNodeComparison*)node)->operation; break;
+                default:                                operation = ((SyntaxNodeConcatenation*)node)->operation; break;
+            }
+
+            // Comparisons and concatenations are left in place, the arithmetic is what
+            // repeats in practice.
+            Nodetype type = node->get_nodetype();
+            candidate = type != Nodetype::NODE_TYPE_EQUALITY && type != Nodetype::NODE_TYPE_COMPARISON &&
+                type != Nodetype::NODE_TYPE_CONCATENATION;
+
+            vector<SyntaxNode**> operands;
+            expression_operands(node, operands);
+
+            Expressiondescription left, right;
+            pure = describe_expression(operands[0], left, candidates);
+            pure = describe_expression(operands[1], right, candidates) && pure;
+            description.key += "(" + left.key + " " + operationtype_to_string(operation) + " " + right.key + ")";
+            description.reads.insert(left.reads.begin(), left.reads.end());
+            description.reads.insert(right.reads.begin(), right.reads.end());
+            description.size += left.size + right.size;
+
+        } break;
+
+        case Nodetype::NODE_TYPE_FUNCTION_CALL:
+        {
+            auto *call = (SyntaxNodeFunctionCall*)node;
+            pure = call->intrinsic != nullptr && call->intrinsic->pure;
+            candidate = !call->arguments.empty();
+
+            description.key += call->identifier + "(";
+            for (auto &argument : call->arguments)
+            {
+                Expressiondescription inner;
+                pure = describe_expression(&argument, inner, candidates) && pure;
+                description.key += inner.key + ",";
+                description.reads.insert(inner.reads.begin(), inner.reads.end());
+                description.size += inner.size;
+            }
+            description.key += ")";
+        } break;
+
+        case Nodetype::NODE_TYPE_ARRAY_INDEX:
+        {
+            auto *index = (SyntaxNodeArrayIndex*)node;
+            description.key += index->identifier + "[";
+            description.reads.insert(index->identifier);
+            for (auto &subscript : index->indices)
+            {
+                Expressiondescription inner;
+                pure = describe_expression(&subscript, inner, candidates) && pure;
+                description.key += inner.key + ",";
+                description.reads.insert(inner.reads.begin(), inner.reads.end());
+                description.size += inner.size;
+            }
+            description.key += "]";
+        } break;
+
+        default:
+        {
+            // Assignments and procedure calls inside an expression.
+            return false;
+        }
+
+    }
+
+    if (pure && candidate) candidates.push_back({ slot, description });
+    return pure;
+
+}
+
+void
+expression_operands(SyntaxNode *node, vector<SyntaxNode**> &operands)
+{
+
+    switch (node->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_ASSIGNMENT:    { auto *n = (SyntaxNodeAssignment*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_EQUALITY:      { auto *n = (SyntaxNodeEquality*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_COMPARISON:    { auto *n = (SyntaxNodeComparison*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_CONCATENATION: { auto *n = (SyntaxNodeConcatenation*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_TERM:          { auto *n = (SyntaxNodeTerm*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_FACTOR:        { auto *n = (SyntaxNodeFactor*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_MAGNITUDE:     { auto *n = (SyntaxNodeMagnitude*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_EXTRACTION:    { auto *n = (SyntaxNodeExtraction*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_DERIVATION:    { auto *n = (SyntaxNodeDerivation*)node; operands.push_back(&n->left); operands.push_back(&n->right); } break;
+        case Nodetype::NODE_TYPE_UNARY:         operands.push_back(&((SyntaxNodeUnary*)node)->expression); break;
+        case Nodetype::NODE_TYPE_GROUPING:      operands.push_back(&((SyntaxNodeGrouping*)node)->expression); break;
+        case Nodetype::NODE_TYPE_EXPRESSION:    operands.push_back(&((SyntaxNodeExpression*)node)->expression); break;
+
+        case Nodetype::NODE_TYPE_FUNCTION_CALL:
+            for (auto &argument : ((SyntaxNodeFunctionCall*)node)->arguments) operands.push_back(&argument);
+            break;
+
+        case Nodetype::NODE_TYPE_PROCEDURE_CALL:
+            for (auto &argument : ((SyntaxNodeProcedureCall*)node)->arguments) operands.push_back(&argument);
+            break;
+
+        case Nodetype::NODE_TYPE_ARRAY_INDEX:
+            for (auto &subscript : ((SyntaxNodeArrayIndex*)node)->indices) operands.push_back(&subscript);
+            break;
+
+        default: break;
+
+    }
+
+}
+
+bool
+match_numeric_literal(SyntaxNode *node, Numericliteral &literal)
+{
+
+    if (auto grouping = dynamic_cast<SyntaxNodeGrouping*>(node))
+        return match_numeric_literal(grouping->expression, literal);
+
+    if (auto unary = dynamic_cast<SyntaxNodeUnary*>(node))
+    {
+        if (!match_numeric_literal(unary->expression, literal)) return false;
+        literal.integer = -literal.integer;
+        literal.real = -literal.real;
+        return true;
+    }
+
+    auto primary = dynamic_cast<SyntaxNodePrimary*>(node);
+    if (primary == nullptr) return false;
+
+    errno = 0;
+    if (primary->primarytype == Primarytype::PRIMARY_TYPE_INTEGER)
+    {
+        literal.data_type = Datatype::DATA_TYPE_INTEGER;
+        literal.integer = std::strtoll(primary->primitive.c_str(), nullptr, 10);
+        literal.real = (r64)literal.integer;
+        return errno == 0 && literal.integer <= INT32_MAX;
+    }
+
+    if (primary->primarytype == Primarytype::PRIMARY_TYPE_REAL)
+    {
+        literal.data_type = Datatype::DATA_TYPE_REAL;
+        literal.integer = 0;
+        literal.real = std::strtod(primary->primitive.c_str(), nullptr);
+        return errno == 0 && std::isfinite(literal.real);
+    }
+
+    return false;
+
+}
+
+Powertype
+classify_power(r64 exponent, i64 &order)
+{
+
+    // The order is the exponent for ipow and the number of halves for ipow_half.
+    r64 halves = exponent * 2.0;
+    if (exponent == 0.5)
+    {
+        order = 1;
+        return Powertype::POWER_TYPE_ROOT;
+    }
+
+    if (std::fabs(exponent) <= 32.0 && exponent == std::trunc(exponent))
+    {
+        order = (i64)exponent;
+        return Powertype::POWER_TYPE_INTEGER;
+    }
+
+    if (std::fabs(halves) <= 32.0 && halves == std::trunc(halves))
+    {
+        order = (i64)halves;
+        return Powertype::POWER_TYPE_HALF;
+    }
+
+    order = 0;
+    return Powertype::POWER_TYPE_GENERAL;
+
+}
@@ -0,0 +1,70 @@
+#ifndef SIGMAFOX_COMPILER_OPTIMIZATION_EXPRESSIONS_HPP
+#define SIGMAFOX_COMPILER_OPTIMIZATION_EXPRESSIONS_HPP
+#include <set>
+#include <definitions.hpp>
+#include <compiler/parser/node.hpp>
+#include <compiler/parser/subnodes.hpp>
+
+// --- Expression Descriptions -------------------------------------------------
+//
+// Shared by the passes that move expressions around. A description is a structural
+// key, equal for two expressions exactly when they are written the same way, the
+// variables the expression reads, and its size in nodes. Slots are the parent's
+// pointer to a node, so a pass can swap the node out in place.
+//
+// describe_expression() also lists every pure subexpression worth a temporary as a
+// candidate, children before their parents, and returns false if the expression
+// calls a user function, an impure intrinsic, or assigns something on the way.
+//
+
+struct Expressiondescription
+{
+    string              key;
+    std::set<string>    reads;
+    i32                 size = 0;
+};
+
+struct Expressioncandidate
+{
+    SyntaxNode        **slot;
+    Expressiondescription description;
+};
+
+bool    describe_expression(SyntaxNode **slot, Expressiondescription &description,
+                vector<Expressioncandidate> &candidates);
+void    expression_operands(SyntaxNode *node, vector<SyntaxNode**> &operands);
+
+// --- Numeric Literals --------------------------------------------------------
+//
+// A literal is an integer or real primary, possibly negated or in parentheses, the
+// way -2 and (0.5) come out of the parser. Integers past an int are long literals in
+// C++ and aren't matched. The folder, the evaluator and the generator all recognize
+// literals and literal exponents here, so they agree on which powers the runtime's
+// ipow templates take, see power.hpp:
+//
+//      x^0.5                           math_sqrt(x)
+//      x^n, n an integer up to 32      ipow<n>(x)
+//      x^(n/2), n odd up to 32         ipow_half<n>(x)
+//
+// Past 32 the chain of roundings starts to cost more accuracy than std::pow.
+//
+
+enum class Powertype
+{
+    POWER_TYPE_GENERAL,
+    POWER_TYPE_ROOT,
+    POWER_TYPE_INTEGER,
+    POWER_TYPE_HALF,
+};
+
+struct Numericliteral
+{
+    Datatype            data_type;
+    i64                 integer;
+    r64                 real;
+};
+
+bool        match_numeric_literal(SyntaxNode *node, Numericliteral &literal);
+Powertype   classify_power(r64 exponent, i64 &order);
+
+#endif
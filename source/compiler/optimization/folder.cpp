@@ -0,0 +1,555 @@
+#include <cmath>
+#include <cerrno>
+#include <cstdio>
+#include <compiler/optimization/folder.hpp>
+#include <compiler/parser/validators/evaluator.hpp>
+
+ConstantFolder::
+ConstantFolder(Environment *environment, vector<shared_ptr<SyntaxNode>> *nodes)
+    : environment(environment), nodes(nodes), replacement(nullptr)
+{
+
+}
+
+ConstantFolder::
+~ConstantFolder()
+{
+
+}
+
+// --- Statements --------------------------------------------------------------
+//
+// Statements are never replaced, they only hand their expressions to fold() so the
+// rewritten expression is stored back into the statement.
+//
+
+void ConstantFolder::
+visit(SyntaxNodeRoot* node)
+{
+
+    this->fold_children(node->children);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeModule* node)
+{
+
+    if (node->root != nullptr) node->root->accept(this);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeMain* node)
+{
+
+    this->fold_children(node->children);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeIncludeStatement* node)
+{
+
+    if (node->module != nullptr) node->module->accept(this);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeFunctionStatement* node)
+{
+
+    this->fold_children(node->children);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeProcedureStatement* node)
+{
+
+    this->fold_children(node->children);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeExpressionStatement* node)
+{
+
+    this->fold(node->expression);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeWhileStatement* node)
+{
+
+    this->fold(node->expression);
+    this->fold_children(node->children);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodePloopStatement* node)
+{
+
+    this->fold(node->start);
+    this->fold(node->end);
+    this->fold(node->step);
+    this->fold_children(node->children);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeLoopStatement* node)
+{
+
+    this->fold(node->start);
+    this->fold(node->end);
+    this->fold(node->step);
+    this->fold_children(node->children);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeVariableStatement* node)
+{
+
+    this->fold(node->expression);
+    this->fold_children(node->dimensions);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeScopeStatement* node)
+{
+
+    this->fold_children(node->children);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeConditionalStatement* node)
+{
+
+    this->fold(node->expression);
+    this->fold_children(node->children);
+    if (node->next != nullptr) node->next->accept(this);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeReadStatement* node)
+{
+
+    this->fold(node->location);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeWriteStatement* node)
+{
+
+    this->fold(node->location);
+    this->fold_children(node->expressions);
+
+}
+
+// --- Expressions -------------------------------------------------------------
+
+void ConstantFolder::
+visit(SyntaxNodeExpression* node)
+{
+
+    this->fold(node->expression);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeProcedureCall* node)
+{
+
+    this->fold_children(node->arguments);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeAssignment* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeEquality* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeComparison* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeConcatenation* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeTerm* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+    bool addition = node->operation == Operationtype::OPERATION_TYPE_ADDITION;
+    Numericliteral left, right;
+    if (match_numeric_literal(node->left, left) && match_numeric_literal(node->right, right))
+    {
+
+        Datatype data_type = this->evaluate_type(node);
+        if (data_type == Datatype::DATA_TYPE_INTEGER)
+        {
+            i64 result = addition ? left.integer + right.integer : left.integer - right.integer;
+            if (result >= INT32_MIN && result <= INT32_MAX)
+                this->replacement = this->generate_constant(data_type, result, (r64)result);
+        }
+
+        else if (data_type == Datatype::DATA_TYPE_REAL)
+        {
+            r64 result = addition ? left.real + right.real : left.real - right.real;
+            if (std::isfinite(result))
+                this->replacement = this->generate_constant(data_type, 0, result);
+        }
+
+        return;
+
+    }
+
+    if (!addition && this->match_integer(node->right, 0))
+    {
+        this->replacement = node->left;
+        return;
+    }
+
+    // Adding a negation is subtracting, and the other way round.
+    auto negation = dynamic_cast<SyntaxNodeUnary*>(node->right);
+    if (negation != nullptr && negation->operation == Operationtype::OPERATION_TYPE_NEGATION)
+    {
+        node->operation = addition ? Operationtype::OPERATION_TYPE_SUBTRACTION :
+            Operationtype::OPERATION_TYPE_ADDITION;
+        node->right = negation->expression;
+    }
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeFactor* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+    bool multiplication = node->operation == Operationtype::OPERATION_TYPE_MULTIPLICATION;
+    Numericliteral left, right;
+    if (match_numeric_literal(node->left, left) && match_numeric_literal(node->right, right))
+    {
+
+        // Integer division truncates in the generated code, so only exact quotients
+        // are folded and the rest is left for the runtime to decide.
+        Datatype data_type = this->evaluate_type(node);
+        if (data_type == Datatype::DATA_TYPE_INTEGER)
+        {
+            if (!multiplication && (right.integer == 0 || left.integer % right.integer != 0))
+                return;
+
+            i64 result = multiplication ? left.integer * right.integer : left.integer / right.integer;
+            if (result >= INT32_MIN && result <= INT32_MAX)
+                this->replacement = this->generate_constant(data_type, result, (r64)result);
+        }
+
+        else if (data_type == Datatype::DATA_TYPE_REAL)
+        {
+            r64 result = multiplication ? left.real * right.real : left.real / right.real;
+            if (std::isfinite(result))
+                this->replacement = this->generate_constant(data_type, 0, result);
+        }
+
+        return;
+
+    }
+
+    if (this->match_integer(node->right, 1) || (multiplication && this->match_integer(node->left, 1)))
+    {
+        this->replacement = this->match_integer(node->right, 1) ? node->left : node->right;
+        return;
+    }
+
+    if (multiplication && this->match_integer(node->right, -1) && this->is_atomic(node->left))
+        this->replacement = this->generate_negation(node->left);
+    else if (multiplication && this->match_integer(node->left, -1) && this->is_atomic(node->right))
+        this->replacement = this->generate_negation(node->right);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeMagnitude* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+    // Powers come back from the runtime as doubles whatever the operands were.
+    Numericliteral base, exponent;
+    if (match_numeric_literal(node->left, base) && match_numeric_literal(node->right, exponent))
+    {
+        r64 result = ConstantFolder::power(base.real, exponent.real);
+        if (std::isfinite(result))
+            this->replacement = this->generate_constant(Datatype::DATA_TYPE_REAL, 0, result);
+    }
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeExtraction* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeDerivation* node)
+{
+
+    this->fold(node->left);
+    this->fold(node->right);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeUnary* node)
+{
+
+    this->fold(node->expression);
+
+    auto inner = dynamic_cast<SyntaxNodeUnary*>(node->expression);
+    if (inner != nullptr && inner->operation == Operationtype::OPERATION_TYPE_NEGATION)
+        this->replacement = inner->expression;
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeFunctionCall* node)
+{
+
+    this->fold_children(node->arguments);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeArrayIndex* node)
+{
+
+    this->fold_children(node->indices);
+
+}
+
+void ConstantFolder::
+visit(SyntaxNodeGrouping* node)
+{
+
+    // The generator writes expressions infix, so parentheses only go once what they
+    // hold can't be split apart by its neighbours.
+    this->fold(node->expression);
+    if (this->is_atomic(node->expression))
+        this->replacement = node->expression;
+
+}
+
+// --- Folder Helpers ----------------------------------------------------------
+
+template <class T> T* ConstantFolder::
+generate_node()
+{
+
+    T* raw_node = new T();
+    this->nodes->push_back(shared_ptr<SyntaxNode>(raw_node));
+    return raw_node;
+
+}
+
+SyntaxNode* ConstantFolder::
+generate_constant(Datatype data_type, i64 integer, r64 real)
+{
+
+    // Negative results are a negation of a positive literal, the same way the parser
+    // reads them.
+    auto *primary = this->generate_node<SyntaxNodePrimary>();
+    bool negative = false;
+    if (data_type == Datatype::DATA_TYPE_INTEGER)
+    {
+        negative = integer < 0;
+        primary->primarytype = Primarytype::PRIMARY_TYPE_INTEGER;
+        primary->primitive = std::to_string(negative ? -integer : integer);
+    }
+
+    else
+    {
+
+        // The shortest form that reads back as the same double.
+        negative = std::signbit(real);
+        r64 magnitude = std::fabs(real);
+        char buffer[32];
+        for (i32 precision = 15; precision <= 17; ++precision)
+        {
+            std::snprintf(buffer, sizeof(buffer), "%.*g", precision, magnitude);
+            if (std::strtod(buffer, nullptr) == magnitude) break;
+        }
+
+        primary->primarytype = Primarytype::PRIMARY_TYPE_REAL;
+        primary->primitive = buffer;
+        if (primary->primitive.find_first_of(".e") == string::npos)
+            primary->primitive += ".0";
+
+    }
+
+    if (!negative) return primary;
+    return this->generate_negation(primary);
+
+}
+
+SyntaxNode* ConstantFolder::
+generate_negation(SyntaxNode *node)
+{
+
+    auto *negation = this->generate_node<SyntaxNodeUnary>();
+    negation->operation = Operationtype::OPERATION_TYPE_NEGATION;
+    negation->expression = node;
+    return negation;
+
+}
+
+void ConstantFolder::
+fold(SyntaxNode *&node)
+{
+
+    if (node == nullptr) return;
+
+    this->replacement = nullptr;
+    node->accept(this);
+    if (this->replacement != nullptr) node = this->replacement;
+    this->replacement = nullptr;
+
+}
+
+void ConstantFolder::
+fold_children(vector<SyntaxNode*> &children)
+{
+
+    for (auto &child : children) this->fold(child);
+
+}
+
+bool ConstantFolder::
+match_integer(SyntaxNode *node, i64 value) const
+{
+
+    Numericliteral constant;
+    if (!match_numeric_literal(node, constant)) return false;
+    return constant.data_type == Datatype::DATA_TYPE_INTEGER && constant.integer == value;
+
+}
+
+bool ConstantFolder::
+is_atomic(SyntaxNode *node) const
+{
+
+    // Nodes the generator writes as a single name, literal or call.
+    switch (node->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_PRIMARY:
+        case Nodetype::NODE_TYPE_GROUPING:
+        case Nodetype::NODE_TYPE_FUNCTION_CALL:
+        case Nodetype::NODE_TYPE_ARRAY_INDEX:
+        case Nodetype::NODE_TYPE_EXTRACTION:
+        case Nodetype::NODE_TYPE_DERIVATION:
+        case Nodetype::NODE_TYPE_MAGNITUDE:
+            return true;
+
+        case Nodetype::NODE_TYPE_UNARY:
+            return this->is_atomic(((SyntaxNodeUnary*)node)->expression);
+
+        default:
+            return false;
+
+    }
+
+}
+
+Datatype ConstantFolder::
+evaluate_type(SyntaxNode *node) const
+{
+
+    ExpressionEvaluator evaluator(this->environment);
+    node->accept(&evaluator);
+    return evaluator.get_data_type();
+
+}
+
+r64 ConstantFolder::
+power(r64 base, r64 exponent)
+{
+
+    // Lowered the way the generator lowers it, see classify_power(), so a folded
+    // power rounds the way the runtime would.
+    auto chain = [](auto &self, r64 x, u64 n) -> r64
+    {
+        if (n == 1) return x;
+        r64 half = self(self, x, n / 2);
+        return (n % 2 == 0) ? half * half : half * half * x;
+    };
+
+    i64 order = 0;
+    switch (classify_power(exponent, order))
+    {
+
+        case Powertype::POWER_TYPE_ROOT:
+            return std::sqrt(base);
+
+        case Powertype::POWER_TYPE_INTEGER:
+        {
+            if (order == 0) return 1.0;
+            r64 positive = chain(chain, base, (u64)(order < 0 ? -order : order));
+            return order < 0 ? 1.0 / positive : positive;
+        }
+
+        case Powertype::POWER_TYPE_HALF:
+        {
+            u64 whole = (u64)(order < 0 ? -order : order) / 2;
+            r64 root = std::sqrt(base);
+            if (whole != 0) root = chain(chain, base, whole) * root;
+            return order < 0 ? 1.0 / root : root;
+        }
+
+        default:
+            return std::pow(base, exponent);
+
+    }
+
+}
@@ -0,0 +1,87 @@
+#ifndef SIGMAFOX_COMPILER_OPTIMIZATION_FOLDER_HPP
+#define SIGMAFOX_COMPILER_OPTIMIZATION_FOLDER_HPP
+#include <definitions.hpp>
+#include <compiler/environment.hpp>
+#include <compiler/optimization/expressions.hpp>
+#include <compiler/parser/visitor.hpp>
+
+// --- Constant Folder ---------------------------------------------------------
+//
+// Runs between parsing and generation and rewrites arithmetic over numeric literals
+// into the single literal it evaluates to, so `8 + 16 - 26 + 10^2` reaches the
+// generator as `98.0`. Folding follows what the generated C++ would have computed:
+// the evaluated datatype decides between integer and real arithmetic, powers are
+// always real since the runtime's ipow returns double, and anything C++ would not
+// compute exactly as written (inexact integer division, overflow past an int, a
+// result that isn't finite) is left alone.
+//
+// A few identities that hold bit for bit in IEEE arithmetic are applied on top:
+// x - 0, x * 1 and x / 1 become x, x * -1 becomes -x, x + -y and x - -y drop the
+// negation, and -(-x) becomes x. The identity constants must be integer literals,
+// a real 1.0 would promote an integer x. Sums with zero are kept because x + 0 turns
+// a negative zero positive.
+//
+// Nodes are rewritten in place through their parent's pointer, and any new nodes are
+// owned by the compiler's node list alongside the parsed ones.
+//
+
+class ConstantFolder : public SyntaxNodeVisitor
+{
+    public:
+                        ConstantFolder(Environment *environment, vector<shared_ptr<SyntaxNode>> *nodes);
+        virtual        ~ConstantFolder();
+
+        virtual void    visit(SyntaxNodeRoot* node) override;
+        virtual void    visit(SyntaxNodeModule* node) override;
+        virtual void    visit(SyntaxNodeMain* node) override;
+        virtual void    visit(SyntaxNodeIncludeStatement* node) override;
+        virtual void    visit(SyntaxNodeFunctionStatement* node) override;
+        virtual void    visit(SyntaxNodeProcedureStatement* node) override;
+        virtual void    visit(SyntaxNodeExpressionStatement* node) override;
+        virtual void    visit(SyntaxNodeWhileStatement* node) override;
+        virtual void    visit(SyntaxNodePloopStatement* node) override;
+        virtual void    visit(SyntaxNodeLoopStatement* node) override;
+        virtual void    visit(SyntaxNodeVariableStatement* node) override;
+        virtual void    visit(SyntaxNodeScopeStatement* node) override;
+        virtual void    visit(SyntaxNodeConditionalStatement* node) override;
+        virtual void    visit(SyntaxNodeReadStatement* node) override;
+        virtual void    visit(SyntaxNodeWriteStatement* node) override;
+
+        virtual void    visit(SyntaxNodeExpression* node) override;
+        virtual void    visit(SyntaxNodeProcedureCall* node) override;
+        virtual void    visit(SyntaxNodeAssignment* node) override;
+        virtual void    visit(SyntaxNodeEquality* node) override;
+        virtual void    visit(SyntaxNodeComparison* node) override;
+        virtual void    visit(SyntaxNodeConcatenation* node) override;
+        virtual void    visit(SyntaxNodeTerm* node) override;
+        virtual void    visit(SyntaxNodeFactor* node) override;
+        virtual void    visit(SyntaxNodeMagnitude* node) override;
+        virtual void    visit(SyntaxNodeExtraction* node) override;
+        virtual void    visit(SyntaxNodeDerivation* node) override;
+        virtual void    visit(SyntaxNodeUnary* node) override;
+        virtual void    visit(SyntaxNodeFunctionCall* node) override;
+        virtual void    visit(SyntaxNodeArrayIndex* node) override;
+        virtual void    visit(SyntaxNodeGrouping* node) override;
+
+    protected:
+        template <class T> T* generate_node();
+        SyntaxNode*     generate_constant(Datatype data_type, i64 integer, r64 real);
+        SyntaxNode*     generate_negation(SyntaxNode *node);
+
+        void            fold(SyntaxNode *&node);
+        void            fold_children(vector<SyntaxNode*> &children);
+
+        bool            match_integer(SyntaxNode *node, i64 value) const;
+        bool            is_atomic(SyntaxNode *node) const;
+        Datatype        evaluate_type(SyntaxNode *node) const;
+
+        static r64      power(r64 base, r64 exponent);
+
+    protected:
+        Environment                        *environment;
+        vector<shared_ptr<SyntaxNode>>     *nodes;
+        SyntaxNode                         *replacement;
+
+};
+
+#endif
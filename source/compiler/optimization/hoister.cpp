@@ -0,0 +1,595 @@
+#include <compiler/optimization/hoister.hpp>
+#include <compiler/parser/validators/evaluator.hpp>
+
+InvariantHoister::
+InvariantHoister(Environment *environment, vector<shared_ptr<SyntaxNode>> *nodes)
+    : environment(environment), nodes(nodes), temporary_count(0)
+{
+
+}
+
+InvariantHoister::
+~InvariantHoister()
+{
+
+}
+
+// --- Scopes ------------------------------------------------------------------
+//
+// The parser's scopes are gone by now, so they are pushed again on the way down and
+// filled with the declarations as they're passed. Loops are hoisted from on the way
+// back up, in the scope that encloses them.
+//
+
+void InvariantHoister::
+visit(SyntaxNodeRoot* node)
+{
+
+    this->hoist(node->children);
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeModule* node)
+{
+
+    if (node->root != nullptr) node->root->accept(this);
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeMain* node)
+{
+
+    this->environment->push_table();
+    this->hoist(node->children);
+    this->environment->pop_table();
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeIncludeStatement* node)
+{
+
+    if (node->module != nullptr) node->module->accept(this);
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeFunctionStatement* node)
+{
+
+    this->environment->push_table();
+    this->declare(node->variable_node);
+    for (auto parameter : node->parameters) this->declare(parameter);
+    this->hoist(node->children);
+    this->environment->pop_table();
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeProcedureStatement* node)
+{
+
+    this->environment->push_table();
+    for (auto parameter : node->parameters) this->declare(parameter);
+    this->hoist(node->children);
+    this->environment->pop_table();
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeWhileStatement* node)
+{
+
+    this->environment->push_table();
+    this->hoist(node->children);
+    this->environment->pop_table();
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodePloopStatement* node)
+{
+
+    this->environment->push_table();
+    this->declare(node->variable);
+    this->hoist(node->children);
+    this->environment->pop_table();
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeLoopStatement* node)
+{
+
+    this->environment->push_table();
+    this->declare(node->variable);
+    this->hoist(node->children);
+    this->environment->pop_table();
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeScopeStatement* node)
+{
+
+    this->environment->push_table();
+    this->hoist(node->children);
+    this->environment->pop_table();
+
+}
+
+void InvariantHoister::
+visit(SyntaxNodeConditionalStatement* node)
+{
+
+    this->environment->push_table();
+    this->hoist(node->children);
+    this->environment->pop_table();
+
+    if (node->next != nullptr) node->next->accept(this);
+
+}
+
+// --- Hoisting ----------------------------------------------------------------
+
+void InvariantHoister::
+hoist(vector<SyntaxNode*> &children)
+{
+
+    for (size_t index = 0; index < children.size(); ++index)
+    {
+
+        SyntaxNode *child = children[index];
+        Nodetype type = child->get_nodetype();
+        if (type == Nodetype::NODE_TYPE_VARIABLE_STATEMENT)
+        {
+            this->declare((SyntaxNodeVariableStatement*)child);
+            continue;
+        }
+
+        if (type == Nodetype::NODE_TYPE_TEMPORARY_STATEMENT)
+        {
+            this->declare((SyntaxNodeTemporaryStatement*)child);
+            continue;
+        }
+
+        child->accept(this);
+        if (type != Nodetype::NODE_TYPE_LOOP_STATEMENT && type != Nodetype::NODE_TYPE_WHILE_STATEMENT)
+            continue;
+
+        vector<SyntaxNode*> hoisted = this->hoist_loop(child);
+        children.insert(children.begin() + index, hoisted.begin(), hoisted.end());
+        index += hoisted.size();
+
+    }
+
+}
+
+vector<SyntaxNode*> InvariantHoister::
+hoist_loop(SyntaxNode *node)
+{
+
+    Loop loop;
+    vector<SyntaxNode*> *body = nullptr;
+    if (node->get_nodetype() == Nodetype::NODE_TYPE_LOOP_STATEMENT)
+    {
+        auto *statement = (SyntaxNodeLoopStatement*)node;
+        loop.assigned.insert(statement->variable->identifier);
+        body = &statement->children;
+    }
+    else
+    {
+        body = &((SyntaxNodeWhileStatement*)node)->children;
+    }
+
+    for (auto child : *body)
+    {
+        if (!this->collect_assigned(child, loop.assigned)) return {};
+    }
+
+    // Temporaries an inner loop hoisted into this body go first, later expressions may
+    // read them.
+    for (auto child = body->begin(); child != body->end();)
+    {
+
+        auto *temporary = dynamic_cast<SyntaxNodeTemporaryStatement*>(*child);
+        if (temporary == nullptr || this->temporary_types.count(temporary->identifier) == 0)
+        {
+            ++child;
+            continue;
+        }
+
+        Expressiondescription description;
+        vector<Expressioncandidate> candidates;
+        if (!describe_expression(&temporary->expression, description, candidates) ||
+            !this->is_invariant(description, loop) || !this->is_speculable(temporary->expression))
+        {
+            ++child;
+            continue;
+        }
+
+        loop.assigned.erase(temporary->identifier);
+        loop.temporaries.emplace(description.key, temporary);
+        loop.hoisted.push_back(temporary);
+        this->declare(temporary);
+        child = body->erase(child);
+
+    }
+
+    // The end bound and step of a loop, and a while condition, are evaluated on every
+    // pass through the generated C++ even though they rarely change.
+    if (node->get_nodetype() == Nodetype::NODE_TYPE_LOOP_STATEMENT)
+    {
+        auto *statement = (SyntaxNodeLoopStatement*)node;
+        this->hoist_expression(&statement->end, loop);
+        this->hoist_expression(&statement->step, loop);
+    }
+    else
+    {
+        this->hoist_expression(&((SyntaxNodeWhileStatement*)node)->expression, loop);
+    }
+
+    this->hoist_statements(*body, loop);
+    return loop.hoisted;
+
+}
+
+void InvariantHoister::
+hoist_statements(vector<SyntaxNode*> &children, Loop &loop)
+{
+
+    // Inner loop bodies have already been hoisted from, what's left in them varies
+    // with the inner loop, so only their bounds are looked at.
+    for (auto child : children)
+    {
+
+        switch (child->get_nodetype())
+        {
+
+            case Nodetype::NODE_TYPE_EXPRESSION_STATEMENT:
+            {
+                this->hoist_expression(&((SyntaxNodeExpressionStatement*)child)->expression, loop);
+            } break;
+
+            case Nodetype::NODE_TYPE_VARIABLE_STATEMENT:
+            {
+                auto *variable = (SyntaxNodeVariableStatement*)child;
+                if (variable->expression != nullptr) this->hoist_expression(&variable->expression, loop);
+            } break;
+
+            case Nodetype::NODE_TYPE_TEMPORARY_STATEMENT:
+            {
+                this->hoist_expression(&((SyntaxNodeTemporaryStatement*)child)->expression, loop);
+            } break;
+
+            case Nodetype::NODE_TYPE_WRITE_STATEMENT:
+            {
+                for (auto &expression : ((SyntaxNodeWriteStatement*)child)->expressions)
+                    this->hoist_expression(&expression, loop);
+            } break;
+
+            case Nodetype::NODE_TYPE_SCOPE_STATEMENT:
+            {
+                this->hoist_statements(((SyntaxNodeScopeStatement*)child)->children, loop);
+            } break;
+
+            case Nodetype::NODE_TYPE_CONDITIONAL_STATEMENT:
+            {
+                auto *conditional = (SyntaxNodeConditionalStatement*)child;
+                while (conditional != nullptr)
+                {
+                    if (conditional->expression != nullptr) this->hoist_expression(&conditional->expression, loop);
+                    this->hoist_statements(conditional->children, loop);
+                    conditional = conditional->next;
+                }
+            } break;
+
+            case Nodetype::NODE_TYPE_LOOP_STATEMENT:
+            {
+                auto *inner = (SyntaxNodeLoopStatement*)child;
+                this->hoist_expression(&inner->start, loop);
+                this->hoist_expression(&inner->end, loop);
+                this->hoist_expression(&inner->step, loop);
+            } break;
+
+            case Nodetype::NODE_TYPE_WHILE_STATEMENT:
+            {
+                this->hoist_expression(&((SyntaxNodeWhileStatement*)child)->expression, loop);
+            } break;
+
+            default: break;
+
+        }
+
+    }
+
+}
+
+void InvariantHoister::
+hoist_expression(SyntaxNode **slot, Loop &loop)
+{
+
+    // Top down, so the largest invariant expression is the one that moves.
+    SyntaxNode *node = *slot;
+    Expressiondescription description;
+    vector<Expressioncandidate> candidates;
+    bool pure = describe_expression(slot, description, candidates);
+    bool candidate = pure && !candidates.empty() && candidates.back().slot == slot;
+
+    if (candidate && this->is_invariant(description, loop) && this->is_speculable(node))
+    {
+
+        SyntaxNodeTemporaryStatement *temporary = nullptr;
+        auto existing = loop.temporaries.find(description.key);
+        if (existing != loop.temporaries.end())
+        {
+            temporary = existing->second;
+        }
+
+        else
+        {
+
+            ExpressionEvaluator evaluator(this->environment);
+            try
+            {
+                node->accept(&evaluator);
+            }
+            catch (CompilerException &)
+            {
+                return;
+            }
+
+            auto *type = new SyntaxNodeVariableStatement();
+            this->nodes->push_back(shared_ptr<SyntaxNode>(type));
+            type->data_type = evaluator.get_data_type();
+            type->structure_type = evaluator.get_structure_type();
+            type->structure_length = evaluator.get_structure_length();
+
+            temporary = new SyntaxNodeTemporaryStatement();
+            this->nodes->push_back(shared_ptr<SyntaxNode>(temporary));
+            temporary->identifier = "sf_licm_" + std::to_string(this->temporary_count++);
+            temporary->expression = node;
+            type->identifier = temporary->identifier;
+
+            this->temporary_types[temporary->identifier] = type;
+            this->declare(temporary);
+            loop.temporaries[description.key] = temporary;
+            loop.hoisted.push_back(temporary);
+
+        }
+
+        auto *reference = new SyntaxNodePrimary();
+        this->nodes->push_back(shared_ptr<SyntaxNode>(reference));
+        reference->primarytype = Primarytype::PRIMARY_TYPE_IDENTIFIER;
+        reference->primitive = temporary->identifier;
+        *slot = reference;
+        return;
+
+    }
+
+    vector<SyntaxNode**> operands;
+    expression_operands(node, operands);
+    for (auto operand : operands) this->hoist_expression(operand, loop);
+
+}
+
+// --- Hoister Helpers ---------------------------------------------------------
+
+bool InvariantHoister::
+collect_assigned(SyntaxNode *node, std::set<string> &assigned) const
+{
+
+    // Gathers every name the loop body may write, false if that can't be known.
+    if (node == nullptr) return true;
+
+    bool known = true;
+    auto all_of = [&](vector<SyntaxNode*> &children)
+    {
+        for (auto child : children) known = this->collect_assigned(child, assigned) && known;
+    };
+
+    switch (node->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_EXPRESSION_STATEMENT:
+            return this->collect_assigned(((SyntaxNodeExpressionStatement*)node)->expression, assigned);
+
+        case Nodetype::NODE_TYPE_VARIABLE_STATEMENT:
+        {
+            auto *variable = (SyntaxNodeVariableStatement*)node;
+            assigned.insert(variable->identifier);
+            return this->collect_assigned(variable->expression, assigned);
+        }
+
+        case Nodetype::NODE_TYPE_TEMPORARY_STATEMENT:
+        {
+            auto *temporary = (SyntaxNodeTemporaryStatement*)node;
+            assigned.insert(temporary->identifier);
+            return this->collect_assigned(temporary->expression, assigned);
+        }
+
+        case Nodetype::NODE_TYPE_READ_STATEMENT:
+        {
+            assigned.insert(((SyntaxNodeReadStatement*)node)->identifier);
+            return true;
+        }
+
+        case Nodetype::NODE_TYPE_WRITE_STATEMENT:
+        {
+            all_of(((SyntaxNodeWriteStatement*)node)->expressions);
+            return known;
+        }
+
+        case Nodetype::NODE_TYPE_LOOP_STATEMENT:
+        {
+            auto *loop = (SyntaxNodeLoopStatement*)node;
+            assigned.insert(loop->variable->identifier);
+            known = this->collect_assigned(loop->start, assigned) && known;
+            known = this->collect_assigned(loop->end, assigned) && known;
+            known = this->collect_assigned(loop->step, assigned) && known;
+            all_of(loop->children);
+            return known;
+        }
+
+        case Nodetype::NODE_TYPE_PLOOP_STATEMENT:
+        {
+            auto *loop = (SyntaxNodePloopStatement*)node;
+            assigned.insert(loop->variable->identifier);
+            known = this->collect_assigned(loop->start, assigned) && known;
+            known = this->collect_assigned(loop->end, assigned) && known;
+            known = this->collect_assigned(loop->step, assigned) && known;
+            all_of(loop->children);
+            return known;
+        }
+
+        case Nodetype::NODE_TYPE_WHILE_STATEMENT:
+        {
+            auto *loop = (SyntaxNodeWhileStatement*)node;
+            known = this->collect_assigned(loop->expression, assigned);
+            all_of(loop->children);
+            return known;
+        }
+
+        case Nodetype::NODE_TYPE_SCOPE_STATEMENT:
+        {
+            all_of(((SyntaxNodeScopeStatement*)node)->children);
+            return known;
+        }
+
+        case Nodetype::NODE_TYPE_CONDITIONAL_STATEMENT:
+        {
+            auto *conditional = (SyntaxNodeConditionalStatement*)node;
+            known = this->collect_assigned(conditional->expression, assigned);
+            all_of(conditional->children);
+            return this->collect_assigned(conditional->next, assigned) && known;
+        }
+
+        case Nodetype::NODE_TYPE_ASSIGNMENT:
+        {
+            assigned.insert(((SyntaxNodeAssignment*)node)->identifier);
+            break;
+        }
+
+        case Nodetype::NODE_TYPE_PROCEDURE_CALL:
+        {
+
+            // Intrinsic procedures write through their arguments, and OV resets the DA
+            // context every DA value depends on.
+            auto *call = (SyntaxNodeProcedureCall*)node;
+            if (call->intrinsic == nullptr || call->intrinsic->name == "OV") return false;
+            for (auto argument : call->arguments)
+            {
+                if (auto primary = dynamic_cast<SyntaxNodePrimary*>(argument))
+                    if (primary->primarytype == Primarytype::PRIMARY_TYPE_IDENTIFIER) assigned.insert(primary->primitive);
+                if (auto index = dynamic_cast<SyntaxNodeArrayIndex*>(argument))
+                    assigned.insert(index->identifier);
+            }
+            break;
+
+        }
+
+        case Nodetype::NODE_TYPE_FUNCTION_CALL:
+        {
+            if (((SyntaxNodeFunctionCall*)node)->intrinsic == nullptr) return false;
+            break;
+        }
+
+        case Nodetype::NODE_TYPE_PRIMARY:
+            return true;
+
+        case Nodetype::NODE_TYPE_FUNCTION_STATEMENT:
+        case Nodetype::NODE_TYPE_PROCEDURE_STATEMENT:
+            return false;
+
+        default: break;
+
+    }
+
+    // Expressions, and the operands of the assignments and calls above.
+    vector<SyntaxNode**> operands;
+    expression_operands(node, operands);
+    for (auto operand : operands) known = this->collect_assigned(*operand, assigned) && known;
+    return known;
+
+}
+
+bool InvariantHoister::
+is_invariant(const Expressiondescription &description, const Loop &loop) const
+{
+
+    // Reads that don't resolve, which shouldn't happen, can't be typed either.
+    for (auto &read : description.reads)
+    {
+        if (loop.assigned.count(read) != 0) return false;
+        if (!this->environment->symbol_exists(read)) return false;
+    }
+
+    return true;
+
+}
+
+bool InvariantHoister::
+is_speculable(SyntaxNode *node) const
+{
+
+    switch (node->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_ARRAY_INDEX:
+        case Nodetype::NODE_TYPE_EXTRACTION:
+            return false;
+
+        case Nodetype::NODE_TYPE_FACTOR:
+        {
+
+            if (((SyntaxNodeFactor*)node)->operation != Operationtype::OPERATION_TYPE_DIVISION) break;
+
+            ExpressionEvaluator evaluator(this->environment);
+            try
+            {
+                node->accept(&evaluator);
+            }
+            catch (CompilerException &)
+            {
+                return false;
+            }
+
+            if (evaluator.get_data_type() == Datatype::DATA_TYPE_INTEGER) return false;
+
+        } break;
+
+        default: break;
+
+    }
+
+    vector<SyntaxNode**> operands;
+    expression_operands(node, operands);
+    for (auto operand : operands)
+    {
+        if (!this->is_speculable(*operand)) return false;
+    }
+
+    return true;
+
+}
+
+void InvariantHoister::
+declare(SyntaxNodeVariableStatement *variable)
+{
+
+    if (variable == nullptr) return;
+    this->environment->set_symbol_locally(variable->identifier,
+        Symbol(variable->identifier, Symboltype::SYMBOL_TYPE_VARIABLE, variable));
+
+}
+
+void InvariantHoister::
+declare(SyntaxNodeTemporaryStatement *temporary)
+{
+
+    auto type = this->temporary_types.find(temporary->identifier);
+    if (type != this->temporary_types.end()) this->declare(type->second);
+
+}
@@ -0,0 +1,74 @@
+#ifndef SIGMAFOX_COMPILER_OPTIMIZATION_HOISTER_HPP
+#define SIGMAFOX_COMPILER_OPTIMIZATION_HOISTER_HPP
+#include <definitions.hpp>
+#include <compiler/environment.hpp>
+#include <compiler/parser/visitor.hpp>
+#include <compiler/optimization/expressions.hpp>
+
+// --- Invariant Hoister -------------------------------------------------------
+//
+// Loop-invariant code motion for LOOP and WHILE. An expression in the body, in the
+// loop's end bound or step, or in a while condition is invariant when it is pure and
+// reads nothing the loop assigns. Each invariant expression, taking the largest one
+// that contains it, is computed once into a temporary statement placed just before
+// the loop. Inner loops are handled first, and any temporary they hoisted is moved
+// further out when it is invariant in the enclosing loop too.
+//
+// A hoisted expression is evaluated even when the loop runs no iterations, or when
+// it sat in a branch that wouldn't be taken, so anything that can fault is left in
+// place: integer division, array reads and extractions. Telling integer division
+// apart needs the operand types, so the hoister rebuilds the scopes as it walks and
+// evaluates expressions against them. A loop that calls a user function or
+// procedure is left alone, since either could assign anything.
+//
+
+class InvariantHoister : public SyntaxNodeVisitor
+{
+    public:
+                        InvariantHoister(Environment *environment, vector<shared_ptr<SyntaxNode>> *nodes);
+        virtual        ~InvariantHoister();
+
+        virtual void    visit(SyntaxNodeRoot* node) override;
+        virtual void    visit(SyntaxNodeModule* node) override;
+        virtual void    visit(SyntaxNodeMain* node) override;
+        virtual void    visit(SyntaxNodeIncludeStatement* node) override;
+        virtual void    visit(SyntaxNodeFunctionStatement* node) override;
+        virtual void    visit(SyntaxNodeProcedureStatement* node) override;
+        virtual void    visit(SyntaxNodeWhileStatement* node) override;
+        virtual void    visit(SyntaxNodePloopStatement* node) override;
+        virtual void    visit(SyntaxNodeLoopStatement* node) override;
+        virtual void    visit(SyntaxNodeScopeStatement* node) override;
+        virtual void    visit(SyntaxNodeConditionalStatement* node) override;
+
+    protected:
+        struct Loop
+        {
+            std::set<string>                assigned;
+            std::unordered_map<string, SyntaxNodeTemporaryStatement*> temporaries;
+            vector<SyntaxNode*>             hoisted;
+        };
+
+        void            hoist(vector<SyntaxNode*> &children);
+        vector<SyntaxNode*> hoist_loop(SyntaxNode *loop);
+        void            hoist_expression(SyntaxNode **slot, Loop &loop);
+        void            hoist_statements(vector<SyntaxNode*> &children, Loop &loop);
+
+        bool            collect_assigned(SyntaxNode *node, std::set<string> &assigned) const;
+        bool            is_invariant(const Expressiondescription &description, const Loop &loop) const;
+        bool            is_speculable(SyntaxNode *node) const;
+
+        void            declare(SyntaxNodeVariableStatement *variable);
+        void            declare(SyntaxNodeTemporaryStatement *temporary);
+
+    protected:
+        Environment                        *environment;
+        vector<shared_ptr<SyntaxNode>>     *nodes;
+        i32                                 temporary_count;
+
+        // The type of each temporary this pass made, so later expressions that read
+        // one can still be evaluated.
+        std::unordered_map<string, SyntaxNodeVariableStatement*> temporary_types;
+
+};
+
+#endif
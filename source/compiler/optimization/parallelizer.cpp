@@ -0,0 +1,853 @@
+#include <compiler/optimization/parallelizer.hpp>
+#include <compiler/optimization/expressions.hpp>
+#include <compiler/intrinsics.hpp>
+
+LoopParallelizer::
+LoopParallelizer(Environment *environment)
+    : environment(environment)
+{
+
+}
+
+LoopParallelizer::
+~LoopParallelizer()
+{
+
+}
+
+const vector<string>& LoopParallelizer::
+get_report() const
+{
+
+    return this->lines;
+
+}
+
+// --- Scopes ------------------------------------------------------------------
+//
+// The scopes are pushed again on the way down, as the hoister does, so the arrays a
+// loop fills can be looked up and checked against what the runtime can gather.
+//
+
+void LoopParallelizer::
+visit(SyntaxNodeRoot* node)
+{
+
+    string enclosing = this->file;
+    this->file = node->relative_base;
+    this->parallelize(node->children);
+    this->file = enclosing;
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeModule* node)
+{
+
+    if (node->root != nullptr) node->root->accept(this);
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeMain* node)
+{
+
+    this->environment->push_table();
+    this->parallelize(node->children);
+    this->environment->pop_table();
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeIncludeStatement* node)
+{
+
+    if (node->module != nullptr) node->module->accept(this);
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeFunctionStatement* node)
+{
+
+    this->environment->push_table();
+    this->declare(node->variable_node);
+    for (auto parameter : node->parameters) this->declare(parameter);
+    this->parallelize(node->children);
+    this->environment->pop_table();
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeProcedureStatement* node)
+{
+
+    this->environment->push_table();
+    for (auto parameter : node->parameters) this->declare(parameter);
+    this->parallelize(node->children);
+    this->environment->pop_table();
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeWhileStatement* node)
+{
+
+    this->environment->push_table();
+    this->parallelize(node->children);
+    this->environment->pop_table();
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodePloopStatement* node)
+{
+
+    this->report_nested(node->variable, node->children, "a PLOOP");
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeLoopStatement* node)
+{
+
+    this->environment->push_table();
+    this->declare(node->variable);
+    this->parallelize(node->children);
+    this->environment->pop_table();
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeScopeStatement* node)
+{
+
+    this->environment->push_table();
+    this->parallelize(node->children);
+    this->environment->pop_table();
+
+}
+
+void LoopParallelizer::
+visit(SyntaxNodeConditionalStatement* node)
+{
+
+    this->environment->push_table();
+    this->parallelize(node->children);
+    this->environment->pop_table();
+
+    if (node->next != nullptr) node->next->accept(this);
+
+}
+
+// --- Parallelization ---------------------------------------------------------
+
+void LoopParallelizer::
+parallelize(vector<SyntaxNode*> &children)
+{
+
+    for (auto child : children)
+    {
+
+        if (child->get_nodetype() == Nodetype::NODE_TYPE_VARIABLE_STATEMENT)
+        {
+            this->declare((SyntaxNodeVariableStatement*)child);
+            continue;
+        }
+
+        if (child->get_nodetype() != Nodetype::NODE_TYPE_LOOP_STATEMENT)
+        {
+            child->accept(this);
+            continue;
+        }
+
+        // Outermost first, a loop that runs in parallel keeps its inner loops in order.
+        auto *loop = (SyntaxNodeLoopStatement*)child;
+        string reason = this->analyze(loop);
+        if (!reason.empty())
+        {
+            this->vectorize(loop);
+            this->report(loop, "stays sequential, " + reason);
+            loop->accept(this);
+            continue;
+        }
+
+        string shared;
+        for (auto &array : loop->shared) shared += (shared.empty() ? "" : ", ") + array;
+        string reduced;
+        for (auto &reduction : loop->reductions)
+        {
+            reduced += (reduced.empty() ? "" : ", ") + reduction.first;
+            switch (reduction.second)
+            {
+                case Reductiontype::REDUCTION_TYPE_SUM: reduced += " (sum)"; break;
+                case Reductiontype::REDUCTION_TYPE_MAXIMUM: reduced += " (max)"; break;
+                case Reductiontype::REDUCTION_TYPE_MINIMUM: reduced += " (min)"; break;
+            }
+        }
+
+        string outcome = "runs in parallel";
+        if (!shared.empty()) outcome += ", sharing " + shared;
+        if (!reduced.empty()) outcome += ", reducing " + reduced;
+        this->report(loop, outcome);
+        this->report_nested(loop->variable, loop->children, "a parallel loop");
+
+    }
+
+}
+
+string LoopParallelizer::
+analyze(SyntaxNodeLoopStatement *loop)
+{
+
+    auto *step = dynamic_cast<SyntaxNodePrimary*>(loop->step);
+    if (step == nullptr || step->primarytype != Primarytype::PRIMARY_TYPE_INTEGER || step->primitive != "1")
+        return "it doesn't step by one";
+    if (loop->variable->data_type != Datatype::DATA_TYPE_INTEGER)
+        return "its iterator isn't an integer";
+
+    Access access;
+    access.iterator = loop->variable->identifier;
+    access.locals.emplace_back();
+    this->analyze_statements(loop->children, access);
+    if (!access.reason.empty()) return access.reason;
+
+    if (access.written.empty() && access.reduced.empty())
+        return "it assigns nothing that outlives it";
+
+    for (auto &array : access.written)
+    {
+
+        if (access.scattered.count(array) != 0)
+            return "it reads " + array + " other than at " + array + "(" + access.iterator + ")";
+
+        // Arrays of numbers, vectors and DA hold their elements apart. Strings can't
+        // be handed back from a worker process, so arrays of them aren't shared.
+        SyntaxNodeVariableStatement *variable = nullptr;
+        if (this->environment->symbol_exists(array))
+            variable = dynamic_cast<SyntaxNodeVariableStatement*>(this->environment->get_symbol(array)->get_node());
+        if (variable == nullptr || variable->dimensions.size() != 1 ||
+            variable->structure_type == Structuretype::STRUCTURE_TYPE_STRING ||
+            variable->data_type == Datatype::DATA_TYPE_STRING)
+        {
+            return array + " isn't an array of numbers, vectors or DA the runtime can gather";
+        }
+
+    }
+
+    for (auto &reduction : access.reduced)
+    {
+
+        const string &identifier = reduction.first;
+        if (access.scattered.count(identifier) != 0)
+            return "it reads " + identifier + " other than to reduce it";
+
+        // Only what the runtime can start over and combine, scalars and vectors of
+        // numbers, and extremes only where they can be compared.
+        SyntaxNodeVariableStatement *variable = nullptr;
+        if (this->environment->symbol_exists(identifier))
+            variable = dynamic_cast<SyntaxNodeVariableStatement*>(this->environment->get_symbol(identifier)->get_node());
+        if (variable == nullptr || !variable->dimensions.empty() ||
+            (variable->data_type != Datatype::DATA_TYPE_REAL && variable->data_type != Datatype::DATA_TYPE_INTEGER))
+        {
+            return identifier + " isn't a scalar or vector of numbers the runtime can reduce";
+        }
+
+        if (variable->structure_type == Structuretype::STRUCTURE_TYPE_VECTOR)
+        {
+            if (reduction.second != Reductiontype::REDUCTION_TYPE_SUM)
+                return "it keeps an extreme of the vector " + identifier + ", which can't be compared";
+        }
+        else if (variable->structure_type != Structuretype::STRUCTURE_TYPE_SCALAR)
+        {
+            return identifier + " isn't a scalar or vector of numbers the runtime can reduce";
+        }
+
+    }
+
+    loop->parallel = true;
+    loop->shared.assign(access.written.begin(), access.written.end());
+    loop->reductions.assign(access.reduced.begin(), access.reduced.end());
+    return "";
+
+}
+
+void LoopParallelizer::
+vectorize(SyntaxNodeLoopStatement *loop)
+{
+
+    // The step has to be known to be positive for the pragma's canonical loop form.
+    auto *step = dynamic_cast<SyntaxNodePrimary*>(loop->step);
+    if (step == nullptr || step->primarytype != Primarytype::PRIMARY_TYPE_INTEGER ||
+        std::stoll(step->primitive) < 1)
+    {
+        return;
+    }
+
+    if (loop->variable->data_type != Datatype::DATA_TYPE_INTEGER || !this->is_innermost(loop->children))
+        return;
+
+    Access access;
+    access.iterator = loop->variable->identifier;
+    access.locals.emplace_back();
+    this->analyze_statements(loop->children, access);
+    if (!access.reason.empty() || !access.lanes.empty()) return;
+    if (access.written.empty() && access.reduced.empty()) return;
+
+    std::set<string> touched = access.read;
+    touched.insert(access.written.begin(), access.written.end());
+    for (auto &reduction : access.reduced) touched.insert(reduction.first);
+
+    for (auto &identifier : touched)
+    {
+
+        SyntaxNodeVariableStatement *variable = nullptr;
+        if (this->environment->symbol_exists(identifier))
+            variable = dynamic_cast<SyntaxNodeVariableStatement*>(this->environment->get_symbol(identifier)->get_node());
+        if (variable == nullptr) return;
+
+        if (variable->structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL ||
+            variable->data_type == Datatype::DATA_TYPE_INTERVAL)
+        {
+            return;
+        }
+
+        // Arrays of vectors are bunches, which lanes can index, and the pragma's
+        // reduction clause only takes arithmetic types.
+        if (access.written.count(identifier) != 0 && (access.scattered.count(identifier) != 0 ||
+            variable->dimensions.size() != 1 || variable->structure_type != Structuretype::STRUCTURE_TYPE_VECTOR))
+        {
+            return;
+        }
+
+        if (access.reduced.count(identifier) != 0 && (access.scattered.count(identifier) != 0 ||
+            !variable->dimensions.empty() || variable->structure_type != Structuretype::STRUCTURE_TYPE_SCALAR ||
+            (variable->data_type != Datatype::DATA_TYPE_REAL && variable->data_type != Datatype::DATA_TYPE_INTEGER)))
+        {
+            return;
+        }
+
+    }
+
+    loop->simd = true;
+    loop->reductions.assign(access.reduced.begin(), access.reduced.end());
+
+}
+
+void LoopParallelizer::
+analyze_statements(vector<SyntaxNode*> &children, Access &access)
+{
+
+    for (auto child : children)
+    {
+        this->analyze_statement(child, access);
+        if (!access.reason.empty()) return;
+    }
+
+}
+
+void LoopParallelizer::
+analyze_statement(SyntaxNode *node, Access &access)
+{
+
+    switch (node->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_VARIABLE_STATEMENT:
+        {
+            auto *variable = (SyntaxNodeVariableStatement*)node;
+            for (auto dimension : variable->dimensions) this->analyze_expression(dimension, access);
+            this->analyze_expression(variable->expression, access);
+            access.locals.back().insert(variable->identifier);
+            if (variable->structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL ||
+                variable->data_type == Datatype::DATA_TYPE_INTERVAL)
+            {
+                if (access.lanes.empty()) access.lanes = "it declares " + variable->identifier + ", a DA or interval";
+            }
+        } break;
+
+        case Nodetype::NODE_TYPE_TEMPORARY_STATEMENT:
+        {
+            auto *temporary = (SyntaxNodeTemporaryStatement*)node;
+            this->analyze_expression(temporary->expression, access);
+            access.locals.back().insert(temporary->identifier);
+        } break;
+
+        case Nodetype::NODE_TYPE_EXPRESSION_STATEMENT:
+        {
+            this->analyze_expression(((SyntaxNodeExpressionStatement*)node)->expression, access);
+        } break;
+
+        case Nodetype::NODE_TYPE_READ_STATEMENT:
+        {
+            access.reason = "it reads input";
+        } break;
+
+        case Nodetype::NODE_TYPE_WRITE_STATEMENT:
+        {
+            access.reason = "it writes output, which would come out of order";
+        } break;
+
+        case Nodetype::NODE_TYPE_PLOOP_STATEMENT:
+        {
+            access.reason = "it contains a PLOOP";
+        } break;
+
+        case Nodetype::NODE_TYPE_FUNCTION_STATEMENT:
+        case Nodetype::NODE_TYPE_PROCEDURE_STATEMENT:
+        {
+            access.reason = "it defines a function or procedure";
+        } break;
+
+        case Nodetype::NODE_TYPE_LOOP_STATEMENT:
+        {
+            auto *loop = (SyntaxNodeLoopStatement*)node;
+            this->analyze_expression(loop->start, access);
+            this->analyze_expression(loop->end, access);
+            this->analyze_expression(loop->step, access);
+            access.locals.push_back({ loop->variable->identifier });
+            this->analyze_statements(loop->children, access);
+            access.locals.pop_back();
+        } break;
+
+        case Nodetype::NODE_TYPE_WHILE_STATEMENT:
+        {
+            auto *loop = (SyntaxNodeWhileStatement*)node;
+            this->analyze_expression(loop->expression, access);
+            access.locals.emplace_back();
+            this->analyze_statements(loop->children, access);
+            access.locals.pop_back();
+        } break;
+
+        case Nodetype::NODE_TYPE_SCOPE_STATEMENT:
+        {
+            access.locals.emplace_back();
+            this->analyze_statements(((SyntaxNodeScopeStatement*)node)->children, access);
+            access.locals.pop_back();
+        } break;
+
+        case Nodetype::NODE_TYPE_CONDITIONAL_STATEMENT:
+        {
+            if (this->analyze_extremum((SyntaxNodeConditionalStatement*)node, access)) return;
+            for (auto *conditional = (SyntaxNodeConditionalStatement*)node; conditional != nullptr;
+                conditional = conditional->next)
+            {
+                this->analyze_expression(conditional->expression, access);
+                access.locals.emplace_back();
+                this->analyze_statements(conditional->children, access);
+                access.locals.pop_back();
+                if (!access.reason.empty()) return;
+            }
+        } break;
+
+        default:
+        {
+            this->analyze_expression(node, access);
+        } break;
+
+    }
+
+}
+
+void LoopParallelizer::
+analyze_expression(SyntaxNode *node, Access &access)
+{
+
+    if (node == nullptr || !access.reason.empty()) return;
+
+    switch (node->get_nodetype())
+    {
+
+        case Nodetype::NODE_TYPE_ASSIGNMENT:
+        {
+            auto *assignment = (SyntaxNodeAssignment*)node;
+            auto *primary = dynamic_cast<SyntaxNodePrimary*>(assignment->left);
+            if (primary != nullptr && !this->is_local(primary->primitive, access) &&
+                primary->primitive != access.iterator && this->is_accumulation(assignment->right, primary->primitive))
+            {
+                this->reduce(primary->primitive, Reductiontype::REDUCTION_TYPE_SUM, access);
+                this->analyze_accumulation(assignment->right, primary->primitive, access);
+                return;
+            }
+
+            this->analyze_target(assignment->left, access);
+            this->analyze_expression(assignment->right, access);
+        } return;
+
+        case Nodetype::NODE_TYPE_PRIMARY:
+        {
+            // A whole outer variable used anywhere, which matters for arrays it fills.
+            auto *primary = (SyntaxNodePrimary*)node;
+            if (primary->primarytype == Primarytype::PRIMARY_TYPE_IDENTIFIER &&
+                !this->is_local(primary->primitive, access) && primary->primitive != access.iterator)
+            {
+                access.scattered.insert(primary->primitive);
+                access.read.insert(primary->primitive);
+            }
+        } return;
+
+        case Nodetype::NODE_TYPE_ARRAY_INDEX:
+        {
+            auto *index = (SyntaxNodeArrayIndex*)node;
+            for (auto subscript : index->indices) this->analyze_expression(subscript, access);
+            if (this->is_local(index->identifier, access)) return;
+            access.read.insert(index->identifier);
+            if (!(index->indices.size() == 1 && this->is_iterator(index->indices[0], access)))
+                access.scattered.insert(index->identifier);
+        } return;
+
+        case Nodetype::NODE_TYPE_FUNCTION_CALL:
+        {
+            auto *call = (SyntaxNodeFunctionCall*)node;
+            if (call->intrinsic == nullptr)
+            {
+                access.reason = "it calls the function " + call->identifier;
+                return;
+            }
+
+            if (!call->intrinsic->pure && access.lanes.empty())
+                access.lanes = "it calls " + call->identifier + ", which isn't pure";
+        } break;
+
+        case Nodetype::NODE_TYPE_PROCEDURE_CALL:
+        {
+
+            // Intrinsic procedures write through their arguments, OV resets the DA
+            // context every thread shares.
+            auto *call = (SyntaxNodeProcedureCall*)node;
+            if (call->intrinsic == nullptr)
+            {
+                access.reason = "it calls the procedure " + call->identifier;
+                return;
+            }
+
+            if (call->intrinsic->name == "OV")
+            {
+                access.reason = "it calls OV";
+                return;
+            }
+
+            if (access.lanes.empty()) access.lanes = "it calls the procedure " + call->identifier;
+
+            for (auto argument : call->arguments)
+            {
+                string identifier;
+                if (auto primary = dynamic_cast<SyntaxNodePrimary*>(argument))
+                    if (primary->primarytype == Primarytype::PRIMARY_TYPE_IDENTIFIER) identifier = primary->primitive;
+                if (auto index = dynamic_cast<SyntaxNodeArrayIndex*>(argument))
+                    identifier = index->identifier;
+
+                if (!identifier.empty() && !this->is_local(identifier, access))
+                {
+                    access.reason = "it passes " + identifier + " to " + call->identifier + ", which can assign it";
+                    return;
+                }
+            }
+
+        } break;
+
+        default: break;
+
+    }
+
+    vector<SyntaxNode**> operands;
+    expression_operands(node, operands);
+    for (auto operand : operands) this->analyze_expression(*operand, access);
+
+}
+
+void LoopParallelizer::
+analyze_target(SyntaxNode *target, Access &access)
+{
+
+    if (auto primary = dynamic_cast<SyntaxNodePrimary*>(target))
+    {
+        if (this->is_local(primary->primitive, access)) return;
+        if (primary->primitive == access.iterator)
+            access.reason = "it assigns its iterator";
+        else
+            access.reason = "it assigns " + primary->primitive + ", which outlives the loop";
+        return;
+    }
+
+    if (auto index = dynamic_cast<SyntaxNodeArrayIndex*>(target))
+    {
+
+        for (auto subscript : index->indices) this->analyze_expression(subscript, access);
+        if (this->is_local(index->identifier, access)) return;
+
+        // Only the iteration's own element, so no two iterations write the same one.
+        if (index->indices.size() == 1 && this->is_iterator(index->indices[0], access))
+            access.written.insert(index->identifier);
+        else
+            access.reason = "it assigns " + index->identifier + " other than at " +
+                index->identifier + "(" + access.iterator + ")";
+        return;
+
+    }
+
+    this->analyze_expression(target, access);
+
+}
+
+// --- Reductions --------------------------------------------------------------
+//
+// The variable being reduced is left out of the analysis where the pattern reads
+// it, so any other read of it lands in scattered and keeps the loop in order.
+//
+
+void LoopParallelizer::
+analyze_accumulation(SyntaxNode *node, const string &identifier, Access &access)
+{
+
+    auto *term = (SyntaxNodeTerm*)node;
+    if (this->is_identifier(term->left, identifier))
+        this->analyze_expression(term->right, access);
+    else if (this->is_identifier(term->right, identifier))
+        this->analyze_expression(term->left, access);
+    else
+    {
+        this->analyze_accumulation(term->left, identifier, access);
+        this->analyze_expression(term->right, access);
+    }
+
+}
+
+bool LoopParallelizer::
+analyze_extremum(SyntaxNodeConditionalStatement *conditional, Access &access)
+{
+
+    // IF X>M ; M := X ; ENDIF, with nothing else in the branch and no ELSEIF. The
+    // condition is often parenthesized, IF (X>M).
+    if (conditional->next != nullptr || conditional->children.size() != 1) return false;
+    SyntaxNode *condition = conditional->expression;
+    while (auto *grouping = dynamic_cast<SyntaxNodeGrouping*>(condition)) condition = grouping->expression;
+    auto *comparison = dynamic_cast<SyntaxNodeComparison*>(condition);
+    auto *statement = dynamic_cast<SyntaxNodeExpressionStatement*>(conditional->children[0]);
+    if (comparison == nullptr || statement == nullptr) return false;
+    auto *assignment = dynamic_cast<SyntaxNodeAssignment*>(statement->expression);
+    auto *target = assignment != nullptr ? dynamic_cast<SyntaxNodePrimary*>(assignment->left) : nullptr;
+    if (target == nullptr || target->primarytype != Primarytype::PRIMARY_TYPE_IDENTIFIER) return false;
+
+    const string &identifier = target->primitive;
+    if (this->is_local(identifier, access) || identifier == access.iterator) return false;
+
+    // Which side the variable is on says whether a larger or smaller value replaces it.
+    SyntaxNode *candidate = nullptr;
+    bool larger = false;
+    if (this->is_identifier(comparison->right, identifier))
+    {
+        candidate = comparison->left;
+        larger = true;
+    }
+    else if (this->is_identifier(comparison->left, identifier))
+    {
+        candidate = comparison->right;
+        larger = false;
+    }
+    else return false;
+
+    switch (comparison->operation)
+    {
+        case Operationtype::OPERATION_TYPE_GREATER_THAN:
+        case Operationtype::OPERATION_TYPE_GREATER_THAN_OR_EQUAL: break;
+        case Operationtype::OPERATION_TYPE_LESS_THAN:
+        case Operationtype::OPERATION_TYPE_LESS_THAN_OR_EQUAL: larger = !larger; break;
+        default: return false;
+    }
+
+    Expressiondescription compared, assigned;
+    vector<Expressioncandidate> candidates;
+    if (!describe_expression(&candidate, compared, candidates) ||
+        !describe_expression(&assignment->right, assigned, candidates) ||
+        compared.key != assigned.key)
+    {
+        return false;
+    }
+
+    this->reduce(identifier, larger ? Reductiontype::REDUCTION_TYPE_MAXIMUM :
+        Reductiontype::REDUCTION_TYPE_MINIMUM, access);
+    this->analyze_expression(candidate, access);
+    this->analyze_expression(assignment->right, access);
+    return true;
+
+}
+
+void LoopParallelizer::
+reduce(const string &identifier, Reductiontype type, Access &access)
+{
+
+    auto existing = access.reduced.find(identifier);
+    if (existing != access.reduced.end() && existing->second != type)
+    {
+        access.reason = "it reduces " + identifier + " more than one way";
+        return;
+    }
+
+    access.reduced[identifier] = type;
+
+}
+
+bool LoopParallelizer::
+is_accumulation(SyntaxNode *node, const string &identifier) const
+{
+
+    // Terms associate to the left, S + A - B is (S + A) - B, so the variable sits at
+    // the bottom of the left spine, or right of the only addition in F(I) + S.
+    auto *term = dynamic_cast<SyntaxNodeTerm*>(node);
+    if (term == nullptr) return false;
+    if (this->is_identifier(term->left, identifier)) return true;
+    if (term->operation == Operationtype::OPERATION_TYPE_ADDITION && this->is_identifier(term->right, identifier))
+        return true;
+    return this->is_accumulation(term->left, identifier);
+
+}
+
+// --- Parallelizer Helpers ----------------------------------------------------
+
+bool LoopParallelizer::
+is_local(const string &identifier, const Access &access) const
+{
+
+    for (auto &scope : access.locals)
+    {
+        if (scope.count(identifier) != 0) return true;
+    }
+
+    return false;
+
+}
+
+bool LoopParallelizer::
+is_identifier(SyntaxNode *node, const string &identifier) const
+{
+
+    while (auto *grouping = dynamic_cast<SyntaxNodeGrouping*>(node)) node = grouping->expression;
+    auto *primary = dynamic_cast<SyntaxNodePrimary*>(node);
+    return primary != nullptr && primary->primarytype == Primarytype::PRIMARY_TYPE_IDENTIFIER &&
+        primary->primitive == identifier;
+
+}
+
+bool LoopParallelizer::
+is_iterator(SyntaxNode *index, const Access &access) const
+{
+
+    auto *primary = dynamic_cast<SyntaxNodePrimary*>(index);
+    return primary != nullptr && primary->primarytype == Primarytype::PRIMARY_TYPE_IDENTIFIER &&
+        primary->primitive == access.iterator && !this->is_local(access.iterator, access);
+
+}
+
+bool LoopParallelizer::
+is_innermost(vector<SyntaxNode*> &children) const
+{
+
+    for (auto child : children)
+    {
+
+        switch (child->get_nodetype())
+        {
+
+            case Nodetype::NODE_TYPE_LOOP_STATEMENT:
+            case Nodetype::NODE_TYPE_PLOOP_STATEMENT:
+            case Nodetype::NODE_TYPE_WHILE_STATEMENT:
+                return false;
+
+            case Nodetype::NODE_TYPE_SCOPE_STATEMENT:
+            {
+                if (!this->is_innermost(((SyntaxNodeScopeStatement*)child)->children)) return false;
+            } break;
+
+            case Nodetype::NODE_TYPE_CONDITIONAL_STATEMENT:
+            {
+                for (auto *conditional = (SyntaxNodeConditionalStatement*)child; conditional != nullptr;
+                    conditional = conditional->next)
+                {
+                    if (!this->is_innermost(conditional->children)) return false;
+                }
+            } break;
+
+            default: break;
+
+        }
+
+    }
+
+    return true;
+
+}
+
+void LoopParallelizer::
+report_nested(SyntaxNodeVariableStatement *iterator, vector<SyntaxNode*> &children, const string &reason)
+{
+
+    // Scoped like the rest of the walk, the loops in here can still use SIMD lanes.
+    this->environment->push_table();
+    this->declare(iterator);
+
+    for (auto child : children)
+    {
+
+        switch (child->get_nodetype())
+        {
+
+            case Nodetype::NODE_TYPE_VARIABLE_STATEMENT:
+                this->declare((SyntaxNodeVariableStatement*)child); break;
+
+            case Nodetype::NODE_TYPE_LOOP_STATEMENT:
+            {
+                auto *loop = (SyntaxNodeLoopStatement*)child;
+                this->vectorize(loop);
+                this->report(loop, "stays sequential, it is inside " + reason);
+                this->report_nested(loop->variable, loop->children, reason);
+            } break;
+
+            case Nodetype::NODE_TYPE_PLOOP_STATEMENT:
+            {
+                auto *ploop = (SyntaxNodePloopStatement*)child;
+                this->report_nested(ploop->variable, ploop->children, reason);
+            } break;
+
+            case Nodetype::NODE_TYPE_WHILE_STATEMENT:
+                this->report_nested(nullptr, ((SyntaxNodeWhileStatement*)child)->children, reason); break;
+            case Nodetype::NODE_TYPE_SCOPE_STATEMENT:
+                this->report_nested(nullptr, ((SyntaxNodeScopeStatement*)child)->children, reason); break;
+
+            case Nodetype::NODE_TYPE_CONDITIONAL_STATEMENT:
+            {
+                for (auto *conditional = (SyntaxNodeConditionalStatement*)child; conditional != nullptr;
+                    conditional = conditional->next)
+                {
+                    this->report_nested(nullptr, conditional->children, reason);
+                }
+            } break;
+
+            default: break;
+
+        }
+
+    }
+
+    this->environment->pop_table();
+
+}
+
+void LoopParallelizer::
+report(SyntaxNodeLoopStatement *loop, const string &outcome)
+{
+
+    this->lines.push_back(this->file + ":" + std::to_string(loop->row) + " LOOP " +
+        loop->variable->identifier + " " + outcome + (loop->simd ? ", marked omp simd." : "."));
+
+}
+
+void LoopParallelizer::
+declare(SyntaxNodeVariableStatement *variable)
+{
+
+    if (variable == nullptr) return;
+    this->environment->set_symbol_locally(variable->identifier,
+        Symbol(variable->identifier, Symboltype::SYMBOL_TYPE_VARIABLE, variable));
+
+}
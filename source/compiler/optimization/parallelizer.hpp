@@ -0,0 +1,111 @@
+#ifndef SIGMAFOX_COMPILER_OPTIMIZATION_PARALLELIZER_HPP
+#define SIGMAFOX_COMPILER_OPTIMIZATION_PARALLELIZER_HPP
+#include <map>
+#include <set>
+#include <definitions.hpp>
+#include <compiler/environment.hpp>
+#include <compiler/parser/visitor.hpp>
+
+// --- Loop Parallelizer -------------------------------------------------------
+//
+// Finds LOOP statements whose iterations are independent and marks them parallel,
+// so the generator runs them on the same runtime path as PLOOP. A ploop gives every
+// iteration its own copy of the variables and gathers one element of each shared
+// array per iteration, so a loop can take that path when it leaves nothing behind
+// but array elements indexed by its iterator: A(I) := ... fills A, and nothing else
+// the loop writes outlives it.
+//
+// A loop qualifies when it steps by one over integers and its body:
+//
+//      - assigns only variables declared inside it, or elements A(I) of arrays
+//        declared outside, indexed by the iterator itself,
+//      - reads those arrays only at A(I), so no iteration sees another's element,
+//      - doesn't read or write files, call user functions or procedures, pass an
+//        outer variable to an intrinsic procedure, run OV or contain a PLOOP.
+//
+// Arrays are gathered by element, so they have to be ones the runtime stores as
+// separate elements, arrays of vectors or of DA.
+//
+// An outer scalar or vector the body only accumulates into is a reduction instead,
+// written either of the ways COSY programs keep a sum or an extreme value:
+//
+//      S := S + F(I) ;                     sums, S - F(I) and F(I) + S too
+//      IF F(I)>M ; M := F(I) ; ENDIF ;     largest, < for the smallest
+//
+// and read nowhere else in the loop. Every iteration starts its copy over, from zero
+// for a sum or from the value before the loop for an extreme, and the runtime folds
+// the iterations' values into the variable afterwards, see ploop_reduction. Extremes
+// need a comparison, so they are kept for scalars only.
+//
+// The outermost loop that qualifies is the one run in parallel, the loops inside it
+// run in order on each thread. Every loop gets a line in the report saying which way
+// it went, and why.
+//
+// A loop that stays sequential can still spread its iterations over SIMD lanes. An
+// innermost loop with a constant step is marked simd when its iterations pass the
+// same checks, its reductions are scalars, its arrays are arrays of vectors, and it
+// calls nothing impure and touches no DA or intervals. Those allocate from, or
+// change, state every iteration shares, which lanes running side by side can't.
+//
+
+class LoopParallelizer : public SyntaxNodeVisitor
+{
+    public:
+                        LoopParallelizer(Environment *environment);
+        virtual        ~LoopParallelizer();
+
+        const vector<string>&   get_report() const;
+
+        virtual void    visit(SyntaxNodeRoot* node) override;
+        virtual void    visit(SyntaxNodeModule* node) override;
+        virtual void    visit(SyntaxNodeMain* node) override;
+        virtual void    visit(SyntaxNodeIncludeStatement* node) override;
+        virtual void    visit(SyntaxNodeFunctionStatement* node) override;
+        virtual void    visit(SyntaxNodeProcedureStatement* node) override;
+        virtual void    visit(SyntaxNodeWhileStatement* node) override;
+        virtual void    visit(SyntaxNodePloopStatement* node) override;
+        virtual void    visit(SyntaxNodeLoopStatement* node) override;
+        virtual void    visit(SyntaxNodeScopeStatement* node) override;
+        virtual void    visit(SyntaxNodeConditionalStatement* node) override;
+
+    protected:
+        struct Access
+        {
+            string                          iterator;
+            vector<std::set<string>>        locals;
+            std::set<string>                written;
+            std::set<string>                scattered;
+            std::map<string, Reductiontype> reduced;
+            std::set<string>                read;
+            string                          reason;
+            string                          lanes;
+        };
+
+        void            parallelize(vector<SyntaxNode*> &children);
+        string          analyze(SyntaxNodeLoopStatement *loop);
+        void            vectorize(SyntaxNodeLoopStatement *loop);
+        void            analyze_statements(vector<SyntaxNode*> &children, Access &access);
+        void            analyze_statement(SyntaxNode *node, Access &access);
+        void            analyze_expression(SyntaxNode *node, Access &access);
+        void            analyze_target(SyntaxNode *target, Access &access);
+        void            analyze_accumulation(SyntaxNode *node, const string &identifier, Access &access);
+        bool            analyze_extremum(SyntaxNodeConditionalStatement *conditional, Access &access);
+        void            reduce(const string &identifier, Reductiontype type, Access &access);
+        bool            is_accumulation(SyntaxNode *node, const string &identifier) const;
+        bool            is_local(const string &identifier, const Access &access) const;
+        bool            is_identifier(SyntaxNode *node, const string &identifier) const;
+        bool            is_iterator(SyntaxNode *index, const Access &access) const;
+        bool            is_innermost(vector<SyntaxNode*> &children) const;
+        void            report_nested(SyntaxNodeVariableStatement *iterator, vector<SyntaxNode*> &children,
+                            const string &reason);
+        void            report(SyntaxNodeLoopStatement *loop, const string &outcome);
+        void            declare(SyntaxNodeVariableStatement *variable);
+
+    protected:
+        Environment    *environment;
+        string          file;
+        vector<string>  lines;
+
+};
+
+#endif
@@ -35,6 +35,7 @@ nodetype_to_string(Nodetype type)
         case Nodetype::NODE_TYPE_CONDITIONAL_STATEMENT:     result = "CONDITIONAL_STATEMENT"; break;
         case Nodetype::NODE_TYPE_READ_STATEMENT:            result = "READ_STATEMENT"; break;
         case Nodetype::NODE_TYPE_WRITE_STATEMENT:           result = "WRITE_STATEMENT"; break;
+        case Nodetype::NODE_TYPE_TEMPORARY_STATEMENT:       result = "TEMPORARY_STATEMENT"; break;
         case Nodetype::NODE_TYPE_EXPRESSION:                result = "EXPRESSION"; break;
         case Nodetype::NODE_TYPE_PROCEDURE_CALL:            result = "PROCEDURE_CALL"; break;
         case Nodetype::NODE_TYPE_ASSIGNMENT:                result = "ASSIGNMENT"; break;
@@ -83,6 +84,8 @@ operationtype_to_string(Operationtype type)
         case Operationtype::OPERATION_TYPE_LESS_THAN_OR_EQUAL:      result = "LESS_THAN_OR_EQUAL"; break;
         case Operationtype::OPERATION_TYPE_GREATER_THAN:            result = "GREATER_THAN"; break;
         case Operationtype::OPERATION_TYPE_GREATER_THAN_OR_EQUAL:   result = "GREATER_THAN_OR_EQUAL"; break;
+        case Operationtype::OPERATION_TYPE_CONCATENATE:             result = "CONCATENATE"; break;
+        case Operationtype::OPERATION_TYPE_NEGATION:                result = "NEGATION"; break;
         default:
         {
             SF_ASSERT(!"Unreachable condition.");
@@ -132,6 +135,7 @@ datatype_to_string(Datatype type)
         case Datatype::DATA_TYPE_INTEGER:   result = "INTEGER"; break;
         case Datatype::DATA_TYPE_REAL:      result = "REAL"; break;
         case Datatype::DATA_TYPE_COMPLEX:   result = "COMPLEX"; break;
+        case Datatype::DATA_TYPE_INTERVAL:  result = "INTERVAL"; break;
         default:
         {
             SF_ASSERT(!"Unreachable condition.");
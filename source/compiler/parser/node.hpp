@@ -26,6 +26,7 @@ enum class Nodetype
     NODE_TYPE_CONDITIONAL_STATEMENT,
     NODE_TYPE_READ_STATEMENT,
     NODE_TYPE_WRITE_STATEMENT,
+    NODE_TYPE_TEMPORARY_STATEMENT,
 
     NODE_TYPE_EXPRESSION,
     NODE_TYPE_PROCEDURE_CALL,
@@ -91,6 +92,7 @@ enum class Datatype
     DATA_TYPE_INTEGER,
     DATA_TYPE_REAL,
     DATA_TYPE_COMPLEX,
+    DATA_TYPE_INTERVAL,
 };
 
 enum class Structuretype
@@ -102,6 +104,13 @@ enum class Structuretype
     STRUCTURE_TYPE_DIFFERENTIAL,
 };
 
+enum class Reductiontype
+{
+    REDUCTION_TYPE_SUM,
+    REDUCTION_TYPE_MAXIMUM,
+    REDUCTION_TYPE_MINIMUM,
+};
+
 class SyntaxNodeVisitor;
 class SyntaxNode 
 {
@@ -1340,6 +1340,7 @@ match_loop_statement()
 
     auto loop_node = this->generate_node<SyntaxNodeLoopStatement>();
     loop_node->iterator    = identifier;   
+    loop_node->row         = identifier_token.row;
     loop_node->variable    = iterator_variable;
     loop_node->start       = initial_value;
     loop_node->end         = ending_value;
@@ -1569,6 +1570,19 @@ SyntaxNode* ParseTree::
 match_procedure_call()
 {
 
+    // Intrinsic procedures, like intrinsic functions, give way to user symbols.
+    if (this->expect_current_token_as(Tokentype::TOKEN_IDENTIFIER))
+    {
+
+        string identifier = this->tokenizer->get_current_token().reference;
+        const Intrinsic *intrinsic = intrinsic_lookup(identifier);
+        if (!this->environment->symbol_exists(identifier) && intrinsic != nullptr && intrinsic->procedure)
+        {
+            return this->match_intrinsic_procedure_call();
+        }
+
+    }
+
     auto left_hand_side = this->match_assignment();
 
     // If we aren't a primary node, it can't be a function call.
@@ -2212,6 +2226,20 @@ SyntaxNode* ParseTree::
 match_function_call()
 {
 
+    // Intrinsics are only considered when the name doesn't resolve to a user symbol.
+    if (this->expect_current_token_as(Tokentype::TOKEN_IDENTIFIER) &&
+        this->expect_next_token_as(Tokentype::TOKEN_LEFT_PARENTHESIS))
+    {
+
+        string identifier = this->tokenizer->get_current_token().reference;
+        const Intrinsic *intrinsic = intrinsic_lookup(identifier);
+        if (!this->environment->symbol_exists(identifier) && intrinsic != nullptr && !intrinsic->procedure)
+        {
+            return this->match_intrinsic_call();
+        }
+
+    }
+
     auto left_hand_side = this->match_array_index();
 
     // If we aren't a primary node, it can't be a function call.
@@ -2343,6 +2371,184 @@ match_function_call()
 
 }
 
+SyntaxNode* ParseTree::
+match_intrinsic_call()
+{
+
+    Token identifier_token = this->tokenizer->get_current_token();
+    this->tokenizer->shift();
+
+    string identifier = identifier_token.reference;
+    const Intrinsic *intrinsic = intrinsic_lookup(identifier);
+    SF_ENSURE_PTR(intrinsic);
+
+    this->consume_current_token_as(Tokentype::TOKEN_LEFT_PARENTHESIS, __LINE__);
+
+    // Collecting parameters.
+    vector<SyntaxNode*> parameters;
+    while (!this->expect_current_token_as(Tokentype::TOKEN_EOF))
+    {
+
+        if (this->expect_current_token_as(Tokentype::TOKEN_RIGHT_PARENTHESIS)) break;
+
+        auto parameter = this->match_expression();
+        parameters.push_back(parameter);
+
+        if (this->expect_current_token_as(Tokentype::TOKEN_COMMA))
+        {
+
+            this->consume_current_token_as(Tokentype::TOKEN_COMMA, __LINE__);
+            if (this->expect_current_token_as(Tokentype::TOKEN_RIGHT_PARENTHESIS))
+            {
+
+                throw CompilerSyntaxError(__LINE__,
+                    this->tokenizer->get_current_token().row,
+                    this->tokenizer->get_current_token().column,
+                    this->path.c_str(),
+                    "Expected expression in parameter list, encountered '%s'.", 
+                    identifier.c_str());
+
+            }
+
+        }
+
+    }
+
+    this->consume_current_token_as(Tokentype::TOKEN_RIGHT_PARENTHESIS, __LINE__);
+
+    this->validate_intrinsic_arguments(intrinsic, identifier_token, parameters);
+
+    auto function_call_node = this->generate_node<SyntaxNodeFunctionCall>();   
+    function_call_node->identifier      = identifier;
+    function_call_node->arguments       = parameters;
+    function_call_node->intrinsic       = intrinsic;
+    return function_call_node;
+
+}
+
+SyntaxNode* ParseTree::
+match_intrinsic_procedure_call()
+{
+
+    Token identifier_token = this->tokenizer->get_current_token();
+    this->tokenizer->shift();
+
+    string identifier = identifier_token.reference;
+    const Intrinsic *intrinsic = intrinsic_lookup(identifier);
+    SF_ENSURE_PTR(intrinsic);
+
+    // Collecting parameters.
+    vector<SyntaxNode*> parameters;
+    while (!this->expect_current_token_as(Tokentype::TOKEN_EOF))
+    {
+
+        if (this->expect_current_token_as(Tokentype::TOKEN_SEMICOLON)) break;
+
+        auto parameter = this->match_expression();
+        parameters.push_back(parameter);
+
+    }
+
+    this->validate_intrinsic_arguments(intrinsic, identifier_token, parameters);
+
+    // Intrinsic procedures return through their arguments, so a variable that hasn't
+    // been assigned yet takes the DA structure the intrinsic gives it, as it would
+    // from an assignment.
+    for (i32 idx = 0; idx < parameters.size(); ++idx)
+    {
+
+        auto primary = dynamic_cast<SyntaxNodePrimary*>(parameters[idx]);
+        if (primary == nullptr || primary->primarytype != Primarytype::PRIMARY_TYPE_IDENTIFIER) continue;
+        if (intrinsic->parameters[idx] != Structuretype::STRUCTURE_TYPE_DIFFERENTIAL) continue;
+
+        Symbol *argument_symbol = this->environment->get_symbol(primary->primitive);
+        auto variable = dynamic_cast<SyntaxNodeVariableStatement*>(argument_symbol->get_node());
+        if (variable == nullptr || variable->structure_type != Structuretype::STRUCTURE_TYPE_UNKNOWN) continue;
+
+        variable->data_type         = Datatype::DATA_TYPE_REAL;
+        variable->structure_type    = Structuretype::STRUCTURE_TYPE_DIFFERENTIAL;
+        variable->structure_length  = 1;
+
+    }
+
+    auto procedure_call_node = this->generate_node<SyntaxNodeProcedureCall>();   
+    procedure_call_node->identifier     = identifier;
+    procedure_call_node->arguments      = parameters;
+    procedure_call_node->intrinsic      = intrinsic;
+    return procedure_call_node;
+
+}
+
+void ParseTree::
+validate_intrinsic_arguments(const Intrinsic *intrinsic, Token identifier_token,
+        vector<SyntaxNode*> &arguments)
+{
+
+    if (arguments.size() != intrinsic->parameters.size())
+    {
+
+        throw CompilerSyntaxError(__LINE__,
+            identifier_token.row,
+            identifier_token.column,
+            this->path.c_str(),
+            "Arity mismatch for intrinsic %s, expected %i arguments.", 
+            intrinsic->name.c_str(), (i32)intrinsic->parameters.size());
+
+    }
+
+    // Check each argument against the structure the intrinsic expects. Arguments
+    // whose structure can't be determined yet are let through.
+    i32 vector_length = -1;
+    for (i32 idx = 0; idx < arguments.size(); ++idx)
+    {
+
+        ExpressionEvaluator argument_evaluation(this->environment);
+        arguments[idx]->accept(&argument_evaluation);
+        Structuretype expected = intrinsic->parameters[idx];
+        Structuretype actual = argument_evaluation.get_structure_type();
+
+        if (expected == Structuretype::STRUCTURE_TYPE_UNKNOWN ||
+            actual == Structuretype::STRUCTURE_TYPE_UNKNOWN)
+        {
+            continue;
+        }
+
+        if (expected != actual)
+        {
+
+            throw CompilerSyntaxError(__LINE__,
+                identifier_token.row,
+                identifier_token.column,
+                this->path.c_str(),
+                "Argument %i of intrinsic %s has the wrong structure, expected %s.", 
+                idx + 1, intrinsic->name.c_str(), structuretype_to_string(expected).c_str());
+
+        }
+
+        if (actual == Structuretype::STRUCTURE_TYPE_VECTOR)
+        {
+
+            i32 length = argument_evaluation.get_structure_length();
+            if (vector_length >= 0 && length != vector_length)
+            {
+
+                throw CompilerSyntaxError(__LINE__,
+                    identifier_token.row,
+                    identifier_token.column,
+                    this->path.c_str(),
+                    "Vector length mismatch in intrinsic %s, %i and %i.", 
+                    intrinsic->name.c_str(), vector_length, length);
+
+            }
+
+            vector_length = length;
+
+        }
+
+    }
+
+}
+
 SyntaxNode* ParseTree::
 match_array_index()
 {
@@ -4,6 +4,7 @@
 #include <compiler/graph.hpp>
 #include <compiler/environment.hpp>
 #include <compiler/parser/node.hpp>
+#include <compiler/intrinsics.hpp>
 #include <compiler/tokenizer/tokenizer.hpp>
 
 class ParseTree 
@@ -66,6 +67,10 @@ class ParseTree
         SyntaxNode* match_derivation();
         SyntaxNode* match_unary();
         SyntaxNode* match_function_call();
+        SyntaxNode* match_intrinsic_call();
+        SyntaxNode* match_intrinsic_procedure_call();
+        void        validate_intrinsic_arguments(const Intrinsic *intrinsic, Token identifier_token,
+                        vector<SyntaxNode*> &arguments);
         SyntaxNode* match_array_index();
         SyntaxNode* match_primary();
 
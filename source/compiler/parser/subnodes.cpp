@@ -305,6 +305,27 @@ accept(SyntaxNodeVisitor *visitor)
     visitor->visit(this);
 }
 
+// --- Temporary Statement Syntax Node ----------------------------------------
+
+SyntaxNodeTemporaryStatement::
+SyntaxNodeTemporaryStatement()
+{
+    this->node_type = Nodetype::NODE_TYPE_TEMPORARY_STATEMENT;
+    this->expression = nullptr;
+}
+
+SyntaxNodeTemporaryStatement::
+~SyntaxNodeTemporaryStatement()
+{
+
+}
+
+void SyntaxNodeTemporaryStatement::
+accept(SyntaxNodeVisitor *visitor)
+{
+    visitor->visit(this);
+}
+
 // --- Expression Syntax Node ---------------------------------------------------
 
 SyntaxNodeExpression::
@@ -331,6 +352,7 @@ SyntaxNodeProcedureCall::
 SyntaxNodeProcedureCall()
 {
     this->node_type = Nodetype::NODE_TYPE_PROCEDURE_CALL;
+    this->intrinsic = nullptr;
 }
 
 SyntaxNodeProcedureCall::
@@ -559,6 +581,7 @@ SyntaxNodeFunctionCall::
 SyntaxNodeFunctionCall()
 {
     this->node_type = Nodetype::NODE_TYPE_FUNCTION_CALL;
+    this->intrinsic = nullptr;
 }
 
 SyntaxNodeFunctionCall::
@@ -2,6 +2,7 @@
 #define SIGMAFOX_COMPILER_PARSER_SUBNODES_HPP
 #include <definitions.hpp>
 #include <compiler/parser/node.hpp>
+#include <compiler/intrinsics.hpp>
 
 // --- Root Syntax Node --------------------------------------------------------
 //
@@ -205,6 +206,13 @@ class SyntaxNodeWhileStatement : public SyntaxNode
 // Loop statements are used to create basic for-loops pretty typical of most
 // languages. The original COSY specification ensured that the iterator remains
 // constant through the loop, however we will not enforce this requirement.
+//
+// A loop the parallelizer proves has independent iterations is marked parallel and
+// generated the way a ploop is, with the arrays it fills by iteration as its shared
+// variables, see optimization/parallelizer.hpp. The scalars and vectors it only
+// sums, or only keeps the largest or smallest value in, are its reductions. An
+// innermost loop that stays sequential but whose iterations could run side by side
+// in SIMD lanes is marked simd instead, and its reductions go on the pragma.
 // 
 
 class SyntaxNodeLoopStatement : public SyntaxNode
@@ -217,6 +225,7 @@ class SyntaxNodeLoopStatement : public SyntaxNode
 
     public:
         string iterator;
+        i32 row = 0;
 
         SyntaxNodeVariableStatement* variable;
         SyntaxNode* start;
@@ -224,6 +233,11 @@ class SyntaxNodeLoopStatement : public SyntaxNode
         SyntaxNode* step;
         vector<SyntaxNode*> children;
 
+        bool parallel = false;
+        vector<string> shared;
+        bool simd = false;
+        vector<std::pair<string, Reductiontype>> reductions;
+
 };
 
 // --- Ploop Statement Syntax Node ---------------------------------------------
@@ -339,6 +353,27 @@ class SyntaxNodeWriteStatement : public SyntaxNode
 
 };
 
+// --- Temporary Statement Syntax Node ----------------------------------------
+//
+// Temporaries aren't part of COSY, the optimization passes introduce them to hold
+// a value that the statements after them reuse. A temporary is never assigned again
+// and takes whatever type its expression evaluates to.
+//
+
+class SyntaxNodeTemporaryStatement : public SyntaxNode
+{
+
+    public:
+                         SyntaxNodeTemporaryStatement();
+        virtual         ~SyntaxNodeTemporaryStatement();
+        virtual void     accept(SyntaxNodeVisitor *visitor) override;
+
+    public:
+        string identifier;
+        SyntaxNode* expression;
+
+};
+
 
 // --- Expression Syntax Node ---------------------------------------------------
 //
@@ -360,7 +395,8 @@ class SyntaxNodeExpression : public SyntaxNode
 
 // --- Procedure Call Syntax Node ----------------------------------------------
 //
-// For procedure call invocations.
+// For procedure call invocations. Calls to intrinsic procedures carry their table
+// entry, user procedure calls leave it null.
 //
 
 class SyntaxNodeProcedureCall : public SyntaxNode
@@ -374,6 +410,7 @@ class SyntaxNodeProcedureCall : public SyntaxNode
     public:
         string identifier;
         vector<SyntaxNode*> arguments;
+        const Intrinsic* intrinsic;
 
 };
 
@@ -589,7 +626,8 @@ class SyntaxNodeUnary : public SyntaxNode
 // --- Function Call Syntax Node ------------------------------------------------
 //
 // Function call nodes are used to represent function calls in the syntax tree.
-// They are used to call functions and pass arguments to them.
+// They are used to call functions and pass arguments to them. Calls to intrinsics
+// carry their table entry, user function calls leave it null.
 //
 
 class SyntaxNodeFunctionCall : public SyntaxNode
@@ -603,6 +641,7 @@ class SyntaxNodeFunctionCall : public SyntaxNode
     public:
         string identifier;
         vector<SyntaxNode*> arguments;
+        const Intrinsic* intrinsic;
 
 };
 
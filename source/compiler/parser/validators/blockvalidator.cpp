@@ -181,6 +181,13 @@ void BlockValidator::
 visit(SyntaxNodeProcedureCall* node)
 {
 
+    // Intrinsic procedures have no body to validate, only their arguments.
+    if (node->intrinsic != nullptr)
+    {
+        for (auto argument : node->arguments) argument->accept(this);
+        return;
+    }
+
     auto procedure_node = (SyntaxNodeProcedureStatement*)
         this->environment->get_symbol(node->identifier)->get_node();
 
@@ -352,6 +359,13 @@ void BlockValidator::
 visit(SyntaxNodeFunctionCall* node)
 {
 
+    // Intrinsics have no body to validate, only their arguments.
+    if (node->intrinsic != nullptr)
+    {
+        for (auto argument : node->arguments) argument->accept(this);
+        return;
+    }
+
     // NOTE(Chris): WE SHOULD ALWAYS BE USING DYNAMIC_CAST.
     //              PERIOD.
     auto function_node = dynamic_cast<SyntaxNodeFunctionStatement*>(this->environment->
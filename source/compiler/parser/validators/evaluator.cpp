@@ -1,5 +1,6 @@
 #include <compiler/parser/validators/evaluator.hpp>
 #include <compiler/exceptions.hpp>
+#include <compiler/optimization/expressions.hpp>
 
 ExpressionEvaluator::
 ExpressionEvaluator(Environment *environment): 
@@ -80,6 +81,11 @@ evaluate(Datatype type)
         return;
     }
 
+    // Intervals promote reals, but complex numbers don't have an interval form.
+    else if ((type == Datatype::DATA_TYPE_INTERVAL && this->evaluated_type == Datatype::DATA_TYPE_COMPLEX) ||
+             (type == Datatype::DATA_TYPE_COMPLEX && this->evaluated_type == Datatype::DATA_TYPE_INTERVAL))
+        this->evaluated_type = Datatype::DATA_TYPE_ERROR;
+
     // The type has been set, but it's different from the current type, so we
     // need to promote the type if it is promotable.
     else if (type > this->evaluated_type)
@@ -91,6 +97,28 @@ evaluate(Datatype type)
 
 }
 
+void ExpressionEvaluator::
+evaluate_differential(Structuretype left, Structuretype right)
+{
+
+    auto promotes = [](Structuretype type)
+    {
+        return type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL ||
+            type == Structuretype::STRUCTURE_TYPE_SCALAR ||
+            type == Structuretype::STRUCTURE_TYPE_UNKNOWN;
+    };
+
+    if (!promotes(left) || !promotes(right))
+    {
+        throw CompilerEvaluatorError(__LINE__, "Structure type mismatch, only scalars mix with DA.");
+    }
+
+    this->evaluate(Datatype::DATA_TYPE_REAL);
+    this->structure_type = Structuretype::STRUCTURE_TYPE_DIFFERENTIAL;
+    this->structure_length = 1;
+
+}
+
 // --- Visitor Routines --------------------------------------------------------
 
 void ExpressionEvaluator::
@@ -183,10 +211,21 @@ visit(SyntaxNodeConcatenation* node)
 
     }
 
+    else if (left_data_type == Datatype::DATA_TYPE_INTERVAL || right_data_type == Datatype::DATA_TYPE_INTERVAL)
+    {
+
+        throw CompilerEvaluatorError(__LINE__, "Interval vectors are not within specification...");
+
+    }
+
+    // Complex vectors are split into real and imaginary columns, so any real component
+    // simply gets a zero imaginary part.
     else if (left_data_type == Datatype::DATA_TYPE_COMPLEX || right_data_type == Datatype::DATA_TYPE_COMPLEX)
     {
 
-        throw CompilerEvaluatorError(__LINE__, "Complex vectors are not within specification...");
+        this->evaluated_type = Datatype::DATA_TYPE_COMPLEX;
+        this->structure_length = left_structure_length + right_structure_length;
+        this->structure_type = Structuretype::STRUCTURE_TYPE_VECTOR;
 
     }
 
@@ -213,6 +252,14 @@ visit(SyntaxNodeTerm* node)
     Structuretype right_structure_type = this->structure_type;
     i32 right_structure_length = this->structure_length;
 
+    // Scalars promote to DA, anything else mixed with a DA is an error.
+    if (left_structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL ||
+        right_structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL)
+    {
+        this->evaluate_differential(left_structure_type, right_structure_type);
+        return;
+    }
+
     if (left_structure_length != right_structure_length)
     {
         throw CompilerEvaluatorError(__LINE__,
@@ -242,6 +289,22 @@ visit(SyntaxNodeFactor* node)
     Structuretype right_structure_type = this->structure_type;
     i32 right_structure_length = this->structure_length;
 
+    // Products with a DA follow the same rules as sums.
+    if (left_structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL ||
+        right_structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL)
+    {
+        this->evaluate_differential(left_structure_type, right_structure_type);
+        return;
+    }
+
+    // Scaling a vector keeps it a vector, whichever side the scalar is on.
+    if (left_structure_type == Structuretype::STRUCTURE_TYPE_VECTOR &&
+        right_structure_type != Structuretype::STRUCTURE_TYPE_VECTOR)
+    {
+        this->structure_type = left_structure_type;
+        this->structure_length = left_structure_length;
+    }
+
 }
 
 void ExpressionEvaluator::
@@ -256,6 +319,36 @@ visit(SyntaxNodeMagnitude* node)
     Structuretype right_structure_type = this->structure_type;
     i32 right_structure_length = this->structure_length;
 
+    // A literal exponent the runtime's ipow templates unroll raises every component,
+    // or the whole DA vector, and the result keeps the shape of the base. Anything
+    // else is std::pow, which only takes scalars, and a DA can't be divided or rooted,
+    // so it only takes non-negative integer powers.
+    if (right_structure_type == Structuretype::STRUCTURE_TYPE_SCALAR &&
+        left_structure_type != Structuretype::STRUCTURE_TYPE_SCALAR)
+    {
+
+        Numericliteral exponent;
+        i64 order = 0;
+        Powertype power = Powertype::POWER_TYPE_GENERAL;
+        if (match_numeric_literal(node->right, exponent))
+            power = classify_power(exponent.real, order);
+
+        bool unrolled = (left_structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL) ?
+            power == Powertype::POWER_TYPE_INTEGER && order >= 0 :
+            power != Powertype::POWER_TYPE_GENERAL;
+
+        if (!unrolled)
+        {
+            throw CompilerEvaluatorError(__LINE__, "Structure type mismatch, a vector or DA is "
+                    "only raised to a literal power up to 32.");
+        }
+
+        this->structure_type = left_structure_type;
+        this->structure_length = left_structure_length;
+        return;
+
+    }
+
     if (left_structure_length != right_structure_length)
     {
         throw CompilerEvaluatorError(__LINE__,
@@ -279,11 +372,25 @@ visit(SyntaxNodeExtraction* node)
 
     node->left->accept(this);
     Structuretype left_structure_type = this->structure_type;
-    i32 left_structure_length = this->structure_length;
 
     node->right->accept(this);
     Structuretype right_structure_type = this->structure_type;
-    i32 right_structure_length = this->structure_length;
+
+    // Extraction takes a component out of a vector by index, or a coefficient out
+    // of a DA by its exponent vector. Either way the result is a scalar.
+    bool vector_component = left_structure_type == Structuretype::STRUCTURE_TYPE_VECTOR &&
+        right_structure_type == Structuretype::STRUCTURE_TYPE_SCALAR;
+    bool differential_coefficient = left_structure_type == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL &&
+        right_structure_type == Structuretype::STRUCTURE_TYPE_VECTOR;
+
+    if (!vector_component && !differential_coefficient)
+    {
+        throw CompilerEvaluatorError(__LINE__, "Structure type mismatch, unable to extract.");
+    }
+
+    this->evaluate(Datatype::DATA_TYPE_REAL);
+    this->structure_type = Structuretype::STRUCTURE_TYPE_SCALAR;
+    this->structure_length = 1;
 
 }
 
@@ -293,26 +400,19 @@ visit(SyntaxNodeDerivation* node)
 
     node->left->accept(this);
     Structuretype left_structure_type = this->structure_type;
-    i32 left_structure_length = this->structure_length;
 
     node->right->accept(this);
     Structuretype right_structure_type = this->structure_type;
-    i32 right_structure_length = this->structure_length;
 
-    if (left_structure_length != right_structure_length)
+    // Derivation is only defined for a DA with respect to a variable number.
+    if (left_structure_type != Structuretype::STRUCTURE_TYPE_DIFFERENTIAL ||
+        right_structure_type != Structuretype::STRUCTURE_TYPE_SCALAR)
     {
-        throw CompilerEvaluatorError(__LINE__,
-                "Vector length mismatch, left is %i, right is %i.",
-                left_structure_length,
-                right_structure_length);
+        throw CompilerEvaluatorError(__LINE__, "Structure type mismatch, unable to derive.");
     }
 
-    if (left_structure_type != right_structure_type)
-    {
-
-        throw CompilerEvaluatorError(__LINE__, "Structure type mismatch.");
-
-    }
+    this->structure_type = Structuretype::STRUCTURE_TYPE_DIFFERENTIAL;
+    this->structure_length = 1;
 
 }
 
@@ -328,6 +428,52 @@ void ExpressionEvaluator::
 visit(SyntaxNodeFunctionCall* node)
 {
 
+    if (node->intrinsic != nullptr)
+    {
+
+        const Intrinsic *intrinsic = node->intrinsic;
+        if (intrinsic->result == Intrinsicresult::INTRINSIC_RESULT_SCALAR)
+        {
+            this->evaluate(Datatype::DATA_TYPE_REAL);
+            this->structure_type = Structuretype::STRUCTURE_TYPE_SCALAR;
+            this->structure_length = 1;
+            return;
+        }
+
+        else if (intrinsic->result == Intrinsicresult::INTRINSIC_RESULT_INTERVAL)
+        {
+            this->evaluate(Datatype::DATA_TYPE_INTERVAL);
+            this->structure_type = Structuretype::STRUCTURE_TYPE_SCALAR;
+            this->structure_length = 1;
+            return;
+        }
+
+        else if (intrinsic->result == Intrinsicresult::INTRINSIC_RESULT_DIFFERENTIAL)
+        {
+            this->evaluate(Datatype::DATA_TYPE_REAL);
+            this->structure_type = Structuretype::STRUCTURE_TYPE_DIFFERENTIAL;
+            this->structure_length = 1;
+            return;
+        }
+
+        // The result takes the shape of a real argument, the runtime has no DA,
+        // complex or interval forms of these.
+        ExpressionEvaluator shape_evaluation(this->environment);
+        node->arguments[intrinsic->shape_argument]->accept(&shape_evaluation);
+        Datatype shape_data_type = shape_evaluation.get_data_type();
+        if (shape_evaluation.get_structure_type() == Structuretype::STRUCTURE_TYPE_DIFFERENTIAL ||
+            shape_data_type == Datatype::DATA_TYPE_COMPLEX || shape_data_type == Datatype::DATA_TYPE_INTERVAL)
+        {
+            throw CompilerEvaluatorError(__LINE__, "Intrinsic %s expects real arguments.", intrinsic->name.c_str());
+        }
+
+        this->evaluate(Datatype::DATA_TYPE_REAL);
+        this->structure_type = shape_evaluation.get_structure_type();
+        this->structure_length = shape_evaluation.get_structure_length();
+        return;
+
+    }
+
     Symbol *function_symbol = this->environment->get_symbol(node->identifier);
     SF_ENSURE_PTR(function_symbol);
 
@@ -35,6 +35,7 @@ class ExpressionEvaluator : public SyntaxNodeVisitor
     
     protected:
         void            evaluate(Datatype type);
+        void            evaluate_differential(Structuretype left, Structuretype right);
         
     protected:
         Environment    *environment;
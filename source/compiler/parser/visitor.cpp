@@ -102,6 +102,12 @@ visit(SyntaxNodeWriteStatement* node)
     return; 
 }
 
+void SyntaxNodeVisitor::
+visit(SyntaxNodeTemporaryStatement* node)       
+{ 
+    return; 
+}
+
 void SyntaxNodeVisitor::
 visit(SyntaxNodeExpression* node)               
 { 
@@ -25,6 +25,7 @@ class SyntaxNodeVisitor
         virtual void    visit(SyntaxNodeConditionalStatement* node);
         virtual void    visit(SyntaxNodeReadStatement* node);
         virtual void    visit(SyntaxNodeWriteStatement* node);
+        virtual void    visit(SyntaxNodeTemporaryStatement* node);
         virtual void    visit(SyntaxNodeExpression* node);
         virtual void    visit(SyntaxNodeProcedureCall* node);
         virtual void    visit(SyntaxNodeAssignment* node);
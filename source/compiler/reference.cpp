@@ -383,6 +383,17 @@ visit(SyntaxNodeWriteStatement* node)
     
 }
 
+void ReferenceVisitor::
+visit(SyntaxNodeTemporaryStatement* node)
+{
+
+    this->print_tabs();
+    std::cout << "TEMPORARY " << node->identifier << " := ";
+    node->expression->accept(this);
+    std::cout << ";" << std::endl;
+
+}
+
 void ReferenceVisitor::
 visit(SyntaxNodeExpression* node)
 {
@@ -25,6 +25,7 @@ class ReferenceVisitor : public SyntaxNodeVisitor
         virtual void    visit(SyntaxNodeConditionalStatement* node)     override;
         virtual void    visit(SyntaxNodeReadStatement* node)            override;
         virtual void    visit(SyntaxNodeWriteStatement* node)           override;
+        virtual void    visit(SyntaxNodeTemporaryStatement* node)       override;
         virtual void    visit(SyntaxNodeExpression* node)               override;
         virtual void    visit(SyntaxNodeProcedureCall* node)            override;
         virtual void    visit(SyntaxNodeAssignment* node)               override;
@@ -65,7 +65,13 @@ main(int argc, char ** argv)
 #endif
 // CPU BURNER 9000
 
+        Generatoroptions generator_options;
+        generator_options.strict_ieee = CLI::has_parameter("strict-ieee");
+        generator_options.ploop_processes = CLI::has_parameter("ploop-processes");
+        generator_options.vectorization_report = CLI::has_parameter("vectorization-report");
+
         Compiler compiler(user_source_file.c_str());
+        compiler.set_generator_options(generator_options);
         if (!compiler.parse(true))
         {
             std::cout << "The compiler wasn't able to parse the source file." << std::endl;
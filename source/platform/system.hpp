@@ -8,4 +8,8 @@ u64     system_virtual_buffer_size(vptr buffer);
 u64     system_memory_page_size();
 u64     system_resize_to_nearest_page_boundary(u64 size);
 
+// Runs a shell command and collects what it writes to its standard output. Returns
+// the command's exit status, or -1 if it couldn't be started.
+i32     system_execute(ccptr command, string &output);
+
 #endif
@@ -2,6 +2,8 @@
 #include <unordered_map>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/wait.h>
+#include <stdio.h>
 
 // NOTE(Chris): This is more or less a consequence of how I designed the API, since
 //              I didn't anticipate that UNIX would require the size of the buffer
@@ -74,3 +76,30 @@ system_resize_to_nearest_page_boundary(u64 size)
     return pages_required * page_size;
 
 }
+
+i32
+system_execute(ccptr command, string &output)
+{
+
+    FILE *pipe = popen(command, "r");
+    if (pipe == NULL)
+    {
+        return -1;
+    }
+
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+    {
+        output.append(buffer, count);
+    }
+
+    int status = pclose(pipe);
+    if (status == -1 || !WIFEXITED(status))
+    {
+        return -1;
+    }
+
+    return WEXITSTATUS(status);
+
+}
@@ -1,4 +1,5 @@
 #include <windows.h>
+#include <stdio.h>
 #include <platform/system.hpp>
 
 vptr 
@@ -69,3 +70,24 @@ system_memory_page_size()
     return page_granularity;
 
 }
+
+i32
+system_execute(ccptr command, string &output)
+{
+
+    FILE *pipe = _popen(command, "r");
+    if (pipe == NULL)
+    {
+        return -1;
+    }
+
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+    {
+        output.append(buffer, count);
+    }
+
+    return _pclose(pipe);
+
+}
@@ -453,6 +453,17 @@ short_help()
     std::cout << "      The provided file name is the entry-point script for a" << std::endl;
     std::cout << "      given project. This will automatically convert any dependencies" << std::endl;
     std::cout << "      or include files for you." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --strict-ieee" << std::endl;
+    std::cout << "      Keep std::complex<double> and its IEEE corner cases for complex" << std::endl;
+    std::cout << "      arithmetic instead of the runtime's fast complex type." << std::endl;
+    std::cout << "  --ploop-processes" << std::endl;
+    std::cout << "      Run PLOOP iterations in forked worker processes that share their" << std::endl;
+    std::cout << "      results through shared memory, instead of on a thread pool." << std::endl;
+    std::cout << "  --vectorization-report" << std::endl;
+    std::cout << "      Compile the output with the C++ compiler in CXX, or c++, and report" << std::endl;
+    std::cout << "      which of its loops the compiler vectorized, and why not." << std::endl;
 }
 
 void CLI::
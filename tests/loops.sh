@@ -0,0 +1,46 @@
+#!/bin/bash
+# Transpiles tests/loops.fox, builds the generated project and checks that what it
+# writes on one and several threads, and in one and several worker processes, is
+# what it writes running in order, tests/loops.out. Run it from the repository root
+# once bin/Sigmafox is built, with the number of threads and processes as its
+# argument, 8 by default.
+set -e
+count=${1:-8}
+root=$(pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+cp -r "$root/library" "$work/library"
+cp "$root/tests/loops.fox" "$work/loops.fox"
+cd "$work"
+
+build()
+{
+    rm -rf output
+    "$root/bin/Sigmafox" loops.fox "$@" > transpile.log || { cat transpile.log; exit 1; }
+    cmake -S output -B output/build > /dev/null
+    cmake --build output/build > /dev/null
+}
+
+compare()
+{
+    if [ "$2" != "$expected" ]; then
+        echo "loops.fox $1 wrote:"
+        echo "$2"
+        echo "but in order it writes:"
+        echo "$expected"
+        exit 1
+    fi
+    echo "loops.fox $1 matches."
+}
+
+# loops.out is what the program writes with every loop run in order.
+expected=$(cat "$root/tests/loops.out")
+
+build
+compare "on 1 thread" "$(SF_PLOOP_THREADS=1 ./output/build/bin/cosyproject)"
+compare "on $count threads" "$(SF_PLOOP_THREADS=$count ./output/build/bin/cosyproject)"
+
+build --ploop-processes
+compare "in 1 process" "$(SF_PLOOP_PROCESSES=1 ./output/build/bin/cosyproject)"
+compare "in $count processes" "$(SF_PLOOP_PROCESSES=$count ./output/build/bin/cosyproject)"